@@ -0,0 +1,170 @@
+// Anti-aliasing benchmark - edge-only supersampling vs. full supersampling on
+// the CPU backend. A reference image is rendered with a regular 8x8 grid of
+// samples in every pixel; each method's image is compared against it (mean
+// absolute channel error and PSNR) and timed including the base pass.
+//
+// Full SSAA uses the same jittered pattern as edge AA (base sample plus N
+// subsamples) in every pixel, so the two differ only in which pixels are
+// supersampled.
+//
+// Usage: antialias_bench [width height iterations]
+// Exits non-zero if edge AA does not improve on the unsampled image.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "config.h"
+#include "constants.h"
+#include "cpu_renderer.h"
+#include "edge_antialias.h"
+#include "output_writer.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+constexpr int kReferenceGrid = 8;
+
+struct View {
+    const char* name;
+    double centerX;
+    double centerY;
+    double zoom;
+};
+
+struct Error {
+    double meanAbs;
+    double psnr;
+};
+
+Error compare(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    double absSum = 0.0;
+    double sqSum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const double d = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+        absSum += std::abs(d);
+        sqSum += d * d;
+    }
+    const double mse = sqSum / static_cast<double>(a.size());
+    return {absSum / static_cast<double>(a.size()), mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0};
+}
+
+// Average the colors of samplesPerPixel positions per pixel (positions laid
+// out pixel by pixel) into rgb.
+void resolveAll(const CpuRenderer& cpu, const RenderConfig& cfg, const PaletteLut& lut,
+                const std::vector<float>& positions, int samplesPerPixel, std::vector<unsigned char>& rgb) {
+    const size_t pixels = rgb.size() / 3;
+    std::vector<int> counts(positions.size() / 2);
+    cpu.computeSamples(cfg, positions.data(), counts.size(), counts.data());
+    for (size_t p = 0; p < pixels; ++p) {
+        unsigned sum[3] = {0, 0, 0};
+        for (int k = 0; k < samplesPerPixel; ++k) {
+            const unsigned char* c = lut.entry(counts[p * samplesPerPixel + k]);
+            sum[0] += c[0];
+            sum[1] += c[1];
+            sum[2] += c[2];
+        }
+        for (int ch = 0; ch < 3; ++ch) {
+            rgb[p * 3 + ch] = static_cast<unsigned char>((sum[ch] + samplesPerPixel / 2) / samplesPerPixel);
+        }
+    }
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int width = argc > 1 ? std::atoi(argv[1]) : 640;
+    const int height = argc > 2 ? std::atoi(argv[2]) : 360;
+    const int iterations = argc > 3 ? std::atoi(argv[3]) : 1000;
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+
+    const View views[] = {
+        {"overview", Defaults::CENTER_X, Defaults::CENTER_Y, Defaults::ZOOM},
+        {"seahorse", -0.745, 0.105, 40.0},
+    };
+
+    CpuRenderer cpu;
+    OutputWriter writer;
+    bool improved = true;
+    std::cout << "[AA bench] " << width << "x" << height << ", " << iterations << " iterations, "
+              << cpu.threadCount() << " threads; reference " << kReferenceGrid << "x" << kReferenceGrid
+              << " samples per pixel\n";
+
+    for (const View& view : views) {
+        RenderConfig cfg = RenderConfig::builder().width(width).height(height).maxIterations(iterations)
+                               .center(view.centerX, view.centerY).zoom(view.zoom).build();
+        const PaletteLut lut = writer.paletteLut(cfg);
+
+        // Reference: regular grid centered on each pixel coordinate.
+        constexpr int gridSamples = kReferenceGrid * kReferenceGrid;
+        std::vector<float> grid(pixels * gridSamples * 2);
+        for (size_t p = 0; p < pixels; ++p) {
+            const float x = static_cast<float>(p % width);
+            const float y = static_cast<float>(p / width);
+            for (int k = 0; k < gridSamples; ++k) {
+                grid[(p * gridSamples + k) * 2] = x + ((k % kReferenceGrid) + 0.5f) / kReferenceGrid - 0.5f;
+                grid[(p * gridSamples + k) * 2 + 1] = y + ((k / kReferenceGrid) + 0.5f) / kReferenceGrid - 0.5f;
+            }
+        }
+        std::vector<unsigned char> reference(pixels * 3);
+        resolveAll(cpu, cfg, lut, grid, gridSamples, reference);
+        grid = std::vector<float>();
+
+        std::vector<int> counts(pixels);
+        std::vector<unsigned char> rgb(pixels * 3);
+        auto start = std::chrono::steady_clock::now();
+        cpu.computeIterations(cfg, counts.data());
+        writer.colorize(lut, counts.data(), pixels, rgb.data());
+        const double baseMs = msSince(start);
+        const Error baseError = compare(rgb, reference);
+        std::cout << "[AA bench] " << view.name << ": none " << baseMs << " ms, error "
+                  << baseError.meanAbs << " (" << baseError.psnr << " dB)\n";
+
+        std::vector<uint32_t> allPixels(pixels);
+        std::iota(allPixels.begin(), allPixels.end(), 0u);
+        for (int samples : {4, 8, 16}) {
+            cfg.antialiasSamples = samples;
+
+            start = std::chrono::steady_clock::now();
+            cpu.computeIterations(cfg, counts.data());
+            writer.colorize(lut, counts.data(), pixels, rgb.data());
+            const EdgeAntialias::Stats stats = EdgeAntialias::apply(cfg, counts.data(), lut, rgb.data(),
+                [&](const float* positions, size_t count, int* results) {
+                    cpu.computeSamples(cfg, positions, count, results);
+                },
+                Antialias::MAX_BATCH_SAMPLES);
+            const double edgeMs = msSince(start);
+            const Error edgeError = compare(rgb, reference);
+            improved = improved && edgeError.meanAbs < baseError.meanAbs;
+
+            // Full SSAA: base sample plus the same subsample pattern everywhere.
+            start = std::chrono::steady_clock::now();
+            std::vector<float> positions(pixels * (samples + 1) * 2);
+            for (size_t p = 0; p < pixels; ++p) {
+                float* out = positions.data() + p * (samples + 1) * 2;
+                out[0] = static_cast<float>(p % width);
+                out[1] = static_cast<float>(p / width);
+                EdgeAntialias::samplePositions(&allPixels[p], 1, width, samples, out + 2);
+            }
+            resolveAll(cpu, cfg, lut, positions, samples + 1, rgb);
+            const double fullMs = msSince(start);
+            const Error fullError = compare(rgb, reference);
+
+            std::cout << "[AA bench] " << view.name << ": " << samples << " samples - edge AA "
+                      << edgeMs << " ms (" << 100.0 * static_cast<double>(stats.edgePixels) / pixels
+                      << "% edge pixels), error " << edgeError.meanAbs << " (" << edgeError.psnr
+                      << " dB); full SSAA " << fullMs << " ms, error " << fullError.meanAbs << " ("
+                      << fullError.psnr << " dB); " << fullMs / edgeMs << "x cost\n";
+        }
+    }
+    return improved ? 0 : 1;
+}
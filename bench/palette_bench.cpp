@@ -0,0 +1,240 @@
+// Palette benchmark - host colorization throughput of the original per-pixel
+// palette-name dispatch vs. the precompiled palette LUT gather, on one thread
+// and on all cores. Then the same counts are colored from every iteration
+// buffer format (u8/u16/u32/packed); each must match the int path exactly.
+// Finally histogram-equalized coloring (histogram + prefix sum + LUT) is timed
+// on CPU-rendered frames and reported as a share of the whole render (iterate
+// plus linear color); every histogram must account for every pixel, and the
+// sorted-count form must give the histogram's positions.
+//
+// Usage: palette_bench [width height reps]
+// Except for the histogram frames, iteration data is synthetic (deterministic): ~30% in-set pixels, escape
+// counts skewed toward low values like a typical overview frame.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "color_histogram.h"
+#include "config.h"
+#include "constants.h"
+#include "cpu_renderer.h"
+#include "iteration_format.h"
+#include "output_writer.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+// --- Original implementation (per-pixel string compare + float divide) ---
+
+void defaultPalette(float t, unsigned char& r, unsigned char& g, unsigned char& b) {
+    constexpr float minVal = 20.0f;
+    constexpr float maxVal = 255.0f;
+    r = static_cast<unsigned char>(minVal + (maxVal - minVal) * t);
+    g = static_cast<unsigned char>(minVal + (maxVal - minVal) * t);
+    b = static_cast<unsigned char>(80.0f + 175.0f * t);
+}
+
+void sunsetPalette(float t, unsigned char& r, unsigned char& g, unsigned char& b) {
+    r = static_cast<unsigned char>(Color::MAX_RGB_F * t);
+    g = static_cast<unsigned char>(80.0f + 150.0f * t);
+    b = static_cast<unsigned char>(40.0f + 60.0f * (1.0f - t));
+}
+
+void neonPalette(float t, unsigned char& r, unsigned char& g, unsigned char& b) {
+    r = static_cast<unsigned char>(Color::MAX_RGB_F * t);
+    g = static_cast<unsigned char>(Color::MAX_RGB_F * (0.5f + 0.5f * t));
+    b = static_cast<unsigned char>(Color::MAX_RGB_F * (0.2f + 0.8f * (1.0f - t)));
+}
+
+void legacyIterationToRGB(int iter, int maxIter, const std::string& palette,
+                          unsigned char& r, unsigned char& g, unsigned char& b) {
+    if (iter >= maxIter) {
+        r = g = b = 0;
+        return;
+    }
+    const float t = static_cast<float>(iter) / static_cast<float>(maxIter);
+    if (palette == "sunset") {
+        sunsetPalette(t, r, g, b);
+    } else if (palette == "neon") {
+        neonPalette(t, r, g, b);
+    } else {
+        defaultPalette(t, r, g, b);
+    }
+}
+
+void legacyColorize(const RenderConfig& cfg, const std::vector<int>& iters, std::vector<unsigned char>& rgb) {
+    const int maxIter = std::max(1, cfg.maxIterations);
+    for (size_t i = 0; i < iters.size(); ++i) {
+        legacyIterationToRGB(iters[i], maxIter, cfg.palette, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+    }
+}
+
+// --- Harness ---
+
+std::vector<int> syntheticIterations(size_t count, int maxIter) {
+    std::vector<int> iters(count);
+    uint32_t state = 12345u;
+    for (auto& it : iters) {
+        state = state * 1664525u + 1013904223u;
+        const uint32_t r = state >> 8;
+        if (r % 10 < 3) {
+            it = maxIter;
+        } else {
+            // Roughly geometric: most pixels escape early.
+            const double u = static_cast<double>(r % 1000000) / 1000000.0;
+            it = std::min(maxIter - 1, static_cast<int>(u * u * u * maxIter));
+        }
+    }
+    return iters;
+}
+
+// Counts stored the way the kernel writes them in format (packed words carry
+// a zero fraction, so they color exactly like plain counts).
+std::vector<unsigned char> storeCounts(const std::vector<int>& iters, IterationFormat format) {
+    std::vector<unsigned char> bytes(iters.size() * iterationFormatBytes(format));
+    for (size_t i = 0; i < iters.size(); ++i) {
+        const uint32_t v = static_cast<uint32_t>(iters[i]);
+        if (format == IterationFormat::U8) {
+            bytes[i] = static_cast<uint8_t>(v);
+        } else if (format == IterationFormat::U16) {
+            const uint16_t s = static_cast<uint16_t>(v);
+            std::memcpy(&bytes[i * 2], &s, sizeof(s));
+        } else {
+            const uint32_t w = format == IterationFormat::Packed
+                ? v << IterationStorage::PACKED_FRACTION_BITS : v;
+            std::memcpy(&bytes[i * 4], &w, sizeof(w));
+        }
+    }
+    return bytes;
+}
+
+template <typename Fn>
+double bestMs(int reps, Fn&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < reps; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int width = argc > 1 ? std::stoi(argv[1]) : Defaults::WIDTH;
+    const int height = argc > 2 ? std::stoi(argv[2]) : Defaults::HEIGHT;
+    const int reps = argc > 3 ? std::stoi(argv[3]) : 5;
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    const double mpix = static_cast<double>(pixels) / 1e6;
+
+    std::cout << "[Palette bench] " << width << "x" << height << ", best of " << reps << "\n";
+    OutputWriter writer;
+    std::vector<unsigned char> rgb(pixels * 3);
+
+    for (int maxIter : {1000, 100000}) {
+        const std::vector<int> iters = syntheticIterations(pixels, maxIter);
+        for (const char* palette : {"default", "sunset", "neon"}) {
+            const RenderConfig cfg = RenderConfig::builder().width(width).height(height)
+                                         .maxIterations(maxIter).palette(palette).build();
+
+            const double legacyMs = bestMs(reps, [&] { legacyColorize(cfg, iters, rgb); });
+            // LUT time includes compiling the table, as a render would.
+            const double lutMs = bestMs(reps, [&] {
+                writer.colorize(writer.paletteLut(cfg), iters.data(), pixels, rgb.data(), 1);
+            });
+            const double lutAllMs = bestMs(reps, [&] {
+                writer.colorize(writer.paletteLut(cfg), iters.data(), pixels, rgb.data());
+            });
+
+            std::cout << "[Palette bench] iterations=" << maxIter << " palette=" << palette
+                      << ": string-dispatch " << mpix / (legacyMs * 1e-3) << " Mpixel/s, "
+                      << "LUT " << mpix / (lutMs * 1e-3) << " Mpixel/s ("
+                      << legacyMs / lutMs << "x), LUT all cores "
+                      << mpix / (lutAllMs * 1e-3) << " Mpixel/s ("
+                      << legacyMs / lutAllMs << "x)\n";
+        }
+    }
+
+    bool identical = true;
+    for (int maxIter : {IterationStorage::U8_MAX_ITERATIONS, 1000}) {
+        const std::vector<int> iters = syntheticIterations(pixels, maxIter);
+        const RenderConfig cfg = RenderConfig::builder().width(width).height(height)
+                                     .maxIterations(maxIter).build();
+        const PaletteLut lut = writer.paletteLut(cfg);
+        std::vector<unsigned char> expected(pixels * 3);
+        writer.colorize(lut, iters.data(), pixels, expected.data(), 1);
+
+        for (IterationFormat format : {IterationFormat::U8, IterationFormat::U16,
+                                       IterationFormat::U32, IterationFormat::Packed}) {
+            if (maxIter > iterationFormatMaxIterations(format)) {
+                continue;
+            }
+            const std::vector<unsigned char> stored = storeCounts(iters, format);
+            const IterationFrame frame{format, stored.data(), pixels};
+            const double ms = bestMs(reps, [&] { writer.colorize(lut, frame, rgb.data(), 1); });
+            const bool same = rgb == expected;
+            identical = identical && same;
+            std::cout << "[Palette bench] format=" << iterationFormatName(format) << " iterations=" << maxIter
+                      << ": " << iterationFormatBytes(format) << " bytes/pixel ("
+                      << static_cast<double>(stored.size()) / (1 << 20) << " MiB), "
+                      << mpix / (ms * 1e-3) << " Mpixel/s, "
+                      << (same ? "identical to int" : "DIFFERS from int") << "\n";
+        }
+    }
+
+    // Histogram coloring on a real frame (the default view on the CPU
+    // backend), against the render it belongs to: iterate, then color.
+    bool counted = true;
+    bool sortedMatches = true;
+    const CpuRenderer cpu;
+    std::vector<int> frameIters(pixels);
+    for (int maxIter : {1000, 10000}) {
+        const RenderConfig cfg = RenderConfig::builder().width(width).height(height)
+                                     .maxIterations(maxIter).build();
+        const RenderConfig equalizedCfg = RenderConfig::builder().width(width).height(height)
+                                              .maxIterations(maxIter).coloring("histogram").build();
+        const IterationFrame frame{IterationFormat::U32, frameIters.data(), pixels};
+
+        const double iterateMs = bestMs(1, [&] { cpu.computeIterations(cfg, frameIters.data()); });
+        const double linearMs = bestMs(reps, [&] { writer.colorize(writer.paletteLut(cfg), frame, rgb.data()); });
+        std::vector<uint32_t> histogram;
+        const double histogramMs = bestMs(reps, [&] { histogram = ColorHistogram::build(frame, maxIter); });
+        const double equalizedMs = bestMs(reps, [&] {
+            writer.colorize(writer.paletteLut(equalizedCfg, frame), frame, rgb.data());
+        });
+
+        uint64_t total = 0;
+        for (uint32_t n : histogram) {
+            total += n;
+        }
+        counted = counted && total == pixels;
+
+        // The sorted form (used when maxIterations exceeds the pixel count)
+        // must place every count where the histogram does.
+        const std::vector<float> positions = ColorHistogram::equalizedPositions(histogram);
+        const std::vector<int> sorted = ColorHistogram::sortedEscapes(frame, maxIter);
+        bool same = true;
+        for (int iter = 0; iter < maxIter; ++iter) {
+            const float expected = static_cast<size_t>(iter) < positions.size() ? positions[static_cast<size_t>(iter)]
+                                                                               : 1.0f;
+            same = same && ColorHistogram::sortedPosition(sorted, iter) == expected;
+        }
+        sortedMatches = sortedMatches && same;
+
+        const double renderMs = iterateMs + linearMs;
+        std::cout << "[Palette bench] histogram iterations=" << maxIter << ": " << histogram.size() << " bins, build "
+                  << histogramMs << " ms, equalized color " << equalizedMs << " ms vs linear " << linearMs
+                  << " ms, +" << (equalizedMs - linearMs) / renderMs * 100.0 << "% of a " << renderMs
+                  << " ms render, " << (total == pixels ? "all pixels counted" : "PIXELS MISSING") << ", "
+                  << (same ? "sorted positions match" : "SORTED POSITIONS DIFFER") << "\n";
+    }
+    return identical && counted && sortedMatches ? 0 : 1;
+}
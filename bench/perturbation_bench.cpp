@@ -0,0 +1,115 @@
+// Perturbation benchmark - deep views whose center orbit escapes long before
+// maxIterations, iterated against the center orbit and against the reference
+// Perturbation::chooseReference picks. Reports orbit lengths, rebases and
+// time (orbit plus deltas), and checks a grid of sample pixels of both frames
+// against their exact FixedPoint escape counts.
+//
+// Perturbed deltas are doubles, so chaotic pixels may land an iteration or
+// two off the exact count; more than Bench::MAX_SAMPLE_MISMATCH of the
+// samples off is a perturbation bug.
+//
+// Usage: perturbation_bench [width height iterations]
+// Exits non-zero if the chosen orbit is shorter than the center orbit or a
+// frame fails the sample check.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "constants.h"
+#include "perturbation.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+namespace Bench {
+    constexpr int SAMPLE_GRID = 16;  // Samples per side checked against exact orbits.
+    constexpr double MAX_SAMPLE_MISMATCH = 0.05;
+}
+
+struct View {
+    const char* name;
+    double centerX;
+    double centerY;
+    double zoom;
+};
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Sample pixels whose count differs from the exact escape count: the length
+// of a FixedPoint orbit started at the pixel itself.
+int sampleMismatches(const RenderConfig& cfg, const std::vector<int>& counts) {
+    const double scaleX = Kernel::VIEWPORT_SCALE_X / cfg.zoom;
+    const double scaleY = Kernel::VIEWPORT_SCALE_Y / cfg.zoom;
+    int mismatches = 0;
+    for (int sy = 0; sy < Bench::SAMPLE_GRID; ++sy) {
+        for (int sx = 0; sx < Bench::SAMPLE_GRID; ++sx) {
+            const int x = (2 * sx + 1) * cfg.width / (2 * Bench::SAMPLE_GRID);
+            const int y = (2 * sy + 1) * cfg.height / (2 * Bench::SAMPLE_GRID);
+            const double offsetX = (static_cast<double>(x) / cfg.width - Kernel::PIXEL_OFFSET) * scaleX;
+            const double offsetY = (static_cast<double>(y) / cfg.height - Kernel::PIXEL_OFFSET) * scaleY;
+            const int exact = Perturbation::referenceOrbit(cfg, offsetX, offsetY).length - 1;
+            mismatches += counts[static_cast<size_t>(y) * cfg.width + x] != exact ? 1 : 0;
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int width = argc > 1 ? std::stoi(argv[1]) : 500;
+    const int height = argc > 2 ? std::stoi(argv[2]) : 400;
+    const int maxIter = argc > 3 ? std::stoi(argv[3]) : 5000;
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    const int samples = Bench::SAMPLE_GRID * Bench::SAMPLE_GRID;
+
+    // Each center sits a fraction of a frame off a point whose orbit never
+    // escapes: the Misiurewicz point i, a seahorse-valley boundary point and
+    // the nucleus of a period-16 minibrot on the real axis.
+    const View views[] = {
+        {"misiurewicz", 1.05e-12, 1.000000000000315, 1e12},
+        {"seahorse", -0.743643887035576, 0.1318259042058025, 1e12},
+        {"minibrot", -1.9950998206127755, 9.8e-12, 1e11},
+    };
+
+    std::cout << "[Perturbation bench] " << width << "x" << height << ", " << maxIter << " iterations, "
+              << samples << " exact samples per frame\n";
+
+    std::vector<int> counts(pixels);
+    int failures = 0;
+    for (const View& view : views) {
+        const RenderConfig cfg = RenderConfig::builder().width(width).height(height).maxIterations(maxIter)
+                                     .center(view.centerX, view.centerY).zoom(view.zoom)
+                                     .precision("perturbation").build();
+
+        int centerLength = 0;
+        for (bool choose : {false, true}) {
+            const auto start = std::chrono::steady_clock::now();
+            const ReferenceOrbit orbit = choose ? Perturbation::chooseReference(cfg)
+                                                : Perturbation::referenceOrbit(cfg);
+            const double orbitMs = msSince(start);
+            const uint64_t rebases = Perturbation::computeIterations(cfg, orbit, 0, counts.data());
+            const double totalMs = msSince(start);
+            const int mismatches = sampleMismatches(cfg, counts);
+
+            centerLength = choose ? centerLength : orbit.length;
+            const bool shorter = orbit.length < centerLength;
+            const bool inexact = mismatches > static_cast<int>(Bench::MAX_SAMPLE_MISMATCH * samples);
+            failures += (shorter || inexact) ? 1 : 0;
+
+            std::cout << "[Perturbation bench] " << view.name << ", " << (choose ? "chosen" : "center")
+                      << " reference: " << orbit.length - 1 << " iterations, " << rebases << " rebases, "
+                      << totalMs << " ms (orbit " << orbitMs << " ms), " << mismatches << "/" << samples
+                      << " samples off" << (shorter ? ", SHORTER THAN CENTER" : "")
+                      << (inexact ? ", TOO MANY MISMATCHES" : "") << "\n";
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+// PNG encoder benchmark - encode time and size of a colored CPU-backend frame
+// for each compression level, from one thread up to all cores. Every encoded
+// file is checked: chunk CRCs, then the concatenated IDAT stream must inflate
+// (Adler-32 included) to exactly the serially filtered rows.
+//
+// Usage: png_bench [width height iterations]   (default: 8K, 256 iterations)
+// Exits non-zero if any encoding fails the check.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "config.h"
+#include "constants.h"
+#include "cpu_renderer.h"
+#include "output_writer.h"
+#include "parallel_for.h"
+#include "png_encoder.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t readBigEndian(const unsigned char* p) {
+    return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | uint32_t{p[3]};
+}
+
+// Whether png is a well-formed file whose image data inflates to expected.
+bool verify(const std::vector<unsigned char>& png, const std::vector<unsigned char>& expected) {
+    std::vector<unsigned char> idat;
+    for (size_t p = 8; p + 12 <= png.size();) {
+        const uint32_t length = readBigEndian(&png[p]);
+        if (p + 12 + length > png.size()) {
+            return false;
+        }
+        const unsigned char* type = &png[p + 4];
+        const uLong crc = crc32(0L, type, 4 + length);
+        if (crc != readBigEndian(&png[p + 8 + length])) {
+            return false;
+        }
+        if (std::string(reinterpret_cast<const char*>(type), 4) == "IDAT") {
+            idat.insert(idat.end(), type + 4, type + 4 + length);
+        }
+        p += 12 + length;
+    }
+    std::vector<unsigned char> inflated(expected.size());
+    uLongf inflatedBytes = static_cast<uLongf>(inflated.size());
+    return uncompress(inflated.data(), &inflatedBytes, idat.data(), static_cast<uLong>(idat.size())) == Z_OK &&
+           inflatedBytes == expected.size() && inflated == expected;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int width = argc > 1 ? std::atoi(argv[1]) : 7680;
+    const int height = argc > 2 ? std::atoi(argv[2]) : 4320;
+    const int iterations = argc > 3 ? std::atoi(argv[3]) : 256;
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+
+    const RenderConfig cfg = RenderConfig::builder().width(width).height(height).maxIterations(iterations)
+                                 .center(-0.745, 0.105).zoom(40.0).build();
+    CpuRenderer cpu;
+    OutputWriter writer;
+    std::vector<int> counts(pixels);
+    std::vector<unsigned char> rgb(pixels * 3);
+    cpu.computeIterations(cfg, counts.data());
+    writer.colorize(writer.paletteLut(cfg), counts.data(), pixels, rgb.data());
+
+    const int cores = resolveThreadCount(0);
+    std::vector<int> threadCounts;
+    for (int t = 1; t < cores; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(cores);
+
+    std::cout << "[PNG bench] " << width << "x" << height << " seahorse valley, " << iterations
+              << " iterations, up to " << cores << " threads, " << (Png::CHUNK_BYTES >> 10)
+              << " KiB chunks\n";
+
+    const size_t rowBytes = static_cast<size_t>(width) * 3;
+    bool ok = true;
+    for (int level : {0, 1, 6, 9}) {
+        PngOptions options = OutputWriter::pngOptions(RenderConfig::builder().pngLevel(level).build());
+
+        // Reference image data: every row filtered serially.
+        std::vector<unsigned char> filtered(static_cast<size_t>(height) * (1 + rowBytes));
+        std::vector<unsigned char> scratch(1 + rowBytes);
+        for (int y = 0; y < height; ++y) {
+            const unsigned char* row = rgb.data() + static_cast<size_t>(y) * rowBytes;
+            PngEncoder::filterRow(options.filter, row, y > 0 ? row - rowBytes : nullptr, rowBytes,
+                                  filtered.data() + static_cast<size_t>(y) * (1 + rowBytes), scratch.data());
+        }
+
+        double singleMs = 0.0;
+        for (int threads : threadCounts) {
+            options.threads = threads;
+            PngEncoder::encode(rgb.data(), width, height, options);  // Warm-up (allocation, page faults).
+            const auto start = std::chrono::steady_clock::now();
+            const std::vector<unsigned char> png = PngEncoder::encode(rgb.data(), width, height, options);
+            const double ms = msSince(start);
+            if (threads == 1) {
+                singleMs = ms;
+            }
+            const bool valid = verify(png, filtered);
+            ok = ok && valid;
+            std::cout << "[PNG bench] level " << level << " (" << PngEncoder::filterName(options.filter)
+                      << "), " << threads << " threads: " << ms << " ms, " << singleMs / ms << "x, "
+                      << static_cast<double>(png.size()) / (1 << 20) << " MiB ("
+                      << 100.0 * static_cast<double>(png.size()) / static_cast<double>(rgb.size())
+                      << "% of raw)" << (valid ? "" : " INVALID") << "\n";
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+// Stage benchmark - times every stage of a render separately on fixed scenes
+// and writes all samples with their percentiles as JSON, so results can be
+// compared between releases (typically on a CPU OpenCL runtime such as PoCL).
+//
+// Setup stages (scene independent, once per repetition): device init and
+// program build (binary cache off). Per scene and repetition: buffer
+// allocation, float iteration kernel and readback (profiling events),
+// colorization and in-memory PNG / PPM encoding. With --backend cpu the kernel
+// stage is the native SIMD backend and the OpenCL-only stages are left out.
+// --readback map times mapping a host-accessible iteration buffer instead of
+// copying it, and colorizes straight from the mapping.
+//
+// Usage: stage_bench [--repeats N] [--width W] [--height H] [--iterations N]
+//                    [--backend opencl|cpu] [--device gpu|cpu] [--threads N]
+//                    [--readback copy|map] [--kernels dir] [--output file.json]
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "constants.h"
+#include "cpu_renderer.h"
+#include "device_manager.h"
+#include "kernel_args.h"
+#include "kernel_manager.h"
+#include "memory_manager.h"
+#include "output_writer.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+struct Scene {
+    const char* name;
+    const char* type;
+    double centerX;
+    double centerY;
+    double zoom;
+};
+
+// Default view, a frame entirely inside the main cardioid (every pixel runs
+// to maxIterations), seahorse valley and the classic Julia set.
+const Scene kScenes[] = {
+    {"default", "mandelbrot", Defaults::CENTER_X, Defaults::CENTER_Y, Defaults::ZOOM},
+    {"deep-interior", "mandelbrot", -0.15, 0.0, 8.0},
+    {"seahorse-valley", "mandelbrot", -0.745, 0.105, 40.0},
+    {"julia", "julia", 0.0, 0.0, 1.0},
+};
+
+// Stage names in report order.
+const char* const kStages[] = {"device_init", "program_build", "buffer_alloc", "kernel",
+                               "readback",    "colorize",      "encode_png",   "encode_ppm"};
+
+struct Options {
+    int repeats = 10;
+    int width = 1280;
+    int height = 720;
+    int iterations = Defaults::MAX_ITERATIONS;
+    int threads = Defaults::THREADS_AUTO;
+    std::string backend = "opencl";
+    std::string device = "cpu";
+    std::string readback = "copy";
+    std::string kernelsRoot = "kernels";
+    std::string output = "build/stage_bench.json";
+};
+
+struct Summary {
+    double min;
+    double p10;
+    double median;
+    double p90;
+    double max;
+    double mean;
+};
+
+// Linear interpolation between closest ranks.
+double percentile(const std::vector<double>& sorted, double q) {
+    const double pos = q * static_cast<double>(sorted.size() - 1);
+    const size_t lo = static_cast<size_t>(pos);
+    const size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - static_cast<double>(lo));
+}
+
+Summary summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples) {
+        sum += s;
+    }
+    return {samples.front(), percentile(samples, 0.1), percentile(samples, 0.5), percentile(samples, 0.9),
+            samples.back(), sum / static_cast<double>(samples.size())};
+}
+
+// Samples of each stage, in milliseconds.
+using StageSamples = std::map<std::string, std::vector<double>>;
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double eventTimeMs(cl_event evt) {
+    cl_ulong startNs = 0;
+    cl_ulong endNs = 0;
+    clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_START, sizeof(startNs), &startNs, nullptr);
+    clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_END, sizeof(endNs), &endNs, nullptr);
+    clReleaseEvent(evt);
+    return static_cast<double>(endNs - startNs) * 1e-6;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            throw std::runtime_error("Missing value for " + arg);
+        }
+        const std::string value = argv[++i];
+        if (arg == "--repeats") {
+            opt.repeats = std::stoi(value);
+        } else if (arg == "--width") {
+            opt.width = std::stoi(value);
+        } else if (arg == "--height") {
+            opt.height = std::stoi(value);
+        } else if (arg == "--iterations") {
+            opt.iterations = std::stoi(value);
+        } else if (arg == "--threads") {
+            opt.threads = std::stoi(value);
+        } else if (arg == "--backend") {
+            opt.backend = value;
+        } else if (arg == "--device") {
+            opt.device = value;
+        } else if (arg == "--readback") {
+            opt.readback = value;
+        } else if (arg == "--kernels") {
+            opt.kernelsRoot = value;
+        } else if (arg == "--output") {
+            opt.output = value;
+        } else {
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+    }
+    if (opt.repeats < 1 || opt.width < 1 || opt.height < 1 || opt.iterations < 1) {
+        throw std::runtime_error("--repeats, --width, --height and --iterations must be positive");
+    }
+    if (opt.backend != "opencl" && opt.backend != "cpu") {
+        throw std::runtime_error("--backend must be opencl or cpu");
+    }
+    if (opt.readback != "copy" && opt.readback != "map") {
+        throw std::runtime_error("--readback must be copy or map");
+    }
+    return opt;
+}
+
+RenderConfig sceneConfig(const Options& opt, const Scene& scene) {
+    return RenderConfig::builder()
+        .width(opt.width)
+        .height(opt.height)
+        .maxIterations(opt.iterations)
+        .fractalType(scene.type)
+        .center(scene.centerX, scene.centerY)
+        .zoom(scene.zoom)
+        .threads(opt.threads)
+        .build();
+}
+
+// Discards std::cout while alive (the managers log every initialization).
+class QuietStdout {
+public:
+    QuietStdout() : saved_(std::cout.rdbuf(nullptr)) {}
+    ~QuietStdout() { std::cout.rdbuf(saved_); }
+
+private:
+    std::streambuf* saved_;
+};
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+    }
+    return quoted + "\"";
+}
+
+void writeSummary(std::ostream& out, const std::vector<double>& samples) {
+    const Summary s = summarize(samples);
+    out << "{\"unit\": \"ms\", \"samples\": [";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        out << (i ? ", " : "") << samples[i];
+    }
+    out << "], \"min\": " << s.min << ", \"p10\": " << s.p10 << ", \"median\": " << s.median
+        << ", \"p90\": " << s.p90 << ", \"max\": " << s.max << ", \"mean\": " << s.mean << "}";
+}
+
+void writeStages(std::ostream& out, const StageSamples& stages, const char* indent) {
+    out << "{";
+    bool first = true;
+    for (const char* stage : kStages) {
+        const auto it = stages.find(stage);
+        if (it == stages.end()) {
+            continue;
+        }
+        out << (first ? "\n" : ",\n") << indent << "  \"" << stage << "\": ";
+        writeSummary(out, it->second);
+        first = false;
+    }
+    out << "\n" << indent << "}";
+}
+
+void printStages(const std::string& label, const StageSamples& stages) {
+    for (const char* stage : kStages) {
+        const auto it = stages.find(stage);
+        if (it == stages.end()) {
+            continue;
+        }
+        const Summary s = summarize(it->second);
+        std::cout << "[Stage bench] " << std::left << std::setw(16) << label << std::setw(14) << stage
+                  << std::right << " median " << s.median << " ms (p10 " << s.p10 << ", p90 " << s.p90
+                  << ")\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const Options opt = parseOptions(argc, argv);
+        const bool useDevice = opt.backend == "opencl";
+        const bool mapped = useDevice && opt.readback == "map";
+        const size_t pixelCount = static_cast<size_t>(opt.width) * static_cast<size_t>(opt.height);
+
+        StageSamples setup;
+        std::unique_ptr<DeviceManager> device;
+        std::unique_ptr<KernelManager> kernels;
+        std::string deviceName = "host";
+        if (useDevice) {
+            // The last repetition's managers are kept for the scenes.
+            for (int r = 0; r < opt.repeats; ++r) {
+                QuietStdout quiet;
+                kernels.reset();
+                device.reset();
+                auto start = std::chrono::steady_clock::now();
+                device = std::make_unique<DeviceManager>();
+                device->initialize(opt.device == "cpu");
+                setup["device_init"].push_back(msSince(start));
+
+                start = std::chrono::steady_clock::now();
+                kernels = std::make_unique<KernelManager>();
+                kernels->initialize(opt.kernelsRoot, device->context(), device->device());
+                setup["program_build"].push_back(msSince(start));
+            }
+            deviceName = device->deviceName();
+        }
+
+        CpuRenderer cpu(opt.threads);
+        if (!useDevice) {
+            deviceName = std::string("CPU backend (") + CpuRenderer::isaName(cpu.isa()) + ", " +
+                         std::to_string(cpu.threadCount()) + " threads)";
+        }
+        std::cout << "[Stage bench] " << deviceName << ": " << opt.width << "x" << opt.height << ", "
+                  << opt.iterations << " iterations, " << opt.repeats << " repetitions"
+                  << (mapped ? ", mapped readback" : "") << "\n";
+        printStages("setup", setup);
+
+        OutputWriter writer;
+        std::vector<StageSamples> sceneStages;
+        std::vector<size_t> pngBytes;
+        for (const Scene& scene : kScenes) {
+            const RenderConfig cfg = sceneConfig(opt, scene);
+            const PaletteLut lut = writer.paletteLut(cfg);
+            std::vector<int> counts(pixelCount);
+            std::vector<unsigned char> rgb(pixelCount * 3);
+            std::vector<unsigned char> encoded;
+            StageSamples stages;
+
+            // One untimed repetition first (driver setup, page faults).
+            for (int r = -1; r < opt.repeats; ++r) {
+                const bool record = r >= 0;
+                auto sample = [&](const char* stage, double ms) {
+                    if (record) {
+                        stages[stage].push_back(ms);
+                    }
+                };
+
+                // Counts to colorize: the host copy, or the mapped device buffer.
+                const int* source = counts.data();
+                std::unique_ptr<MemoryManager> memory;
+                if (useDevice) {
+                    auto start = std::chrono::steady_clock::now();
+                    memory = std::make_unique<MemoryManager>(*device);
+                    if (mapped) {
+                        memory->initializeMapped(cfg);
+                    } else {
+                        memory->initialize(cfg);
+                    }
+                    sample("buffer_alloc", msSince(start));
+
+                    cl_command_queue queue = device->commandQueue();
+                    cl_kernel kernel = kernels->iterationKernel(PrecisionTier::Float);
+                    setFractalKernelArgs(kernel, PrecisionTier::Float, cfg, memory->iterationBuffer());
+                    const size_t globalSize[2] = {static_cast<size_t>(cfg.width), static_cast<size_t>(cfg.height)};
+                    cl_event evt = nullptr;
+                    if (clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalSize, nullptr, 0, nullptr, &evt) !=
+                        CL_SUCCESS) {
+                        throw std::runtime_error("Failed to enqueue Mandelbrot kernel");
+                    }
+                    clFinish(queue);
+                    sample("kernel", eventTimeMs(evt));
+
+                    if (mapped) {
+                        memory->mapFrame(&evt);
+                        source = static_cast<const int*>(memory->hostFrame().data);
+                    } else if (clEnqueueReadBuffer(queue, memory->iterationBuffer(), CL_TRUE, 0,
+                                                   pixelCount * sizeof(int), counts.data(), 0, nullptr, &evt) !=
+                               CL_SUCCESS) {
+                        throw std::runtime_error("Failed to read iteration buffer");
+                    }
+                    sample("readback", eventTimeMs(evt));
+                } else {
+                    const auto start = std::chrono::steady_clock::now();
+                    cpu.computeIterations(cfg, counts.data());
+                    sample("kernel", msSince(start));
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                writer.colorize(lut, source, pixelCount, rgb.data(), opt.threads);
+                sample("colorize", msSince(start));
+
+                start = std::chrono::steady_clock::now();
+                encoded = writer.encodeRGBImage(cfg, rgb, "stage_bench.png");
+                sample("encode_png", msSince(start));
+                const size_t pngSize = encoded.size();
+
+                start = std::chrono::steady_clock::now();
+                encoded = writer.encodeRGBImage(cfg, rgb, "stage_bench.ppm");
+                sample("encode_ppm", msSince(start));
+                if (!record) {
+                    pngBytes.push_back(pngSize);
+                }
+            }
+            printStages(scene.name, stages);
+            sceneStages.push_back(std::move(stages));
+        }
+
+        std::ostringstream json;
+        json << std::setprecision(6);
+        json << "{\n  \"benchmark\": \"stage_bench\",\n  \"backend\": \"" << opt.backend << "\",\n"
+             << "  \"readback\": \"" << (useDevice ? opt.readback : "none") << "\",\n"
+             << "  \"device\": " << jsonString(deviceName) << ",\n  \"width\": " << opt.width << ",\n  \"height\": "
+             << opt.height << ",\n  \"iterations\": " << opt.iterations << ",\n  \"repeats\": " << opt.repeats
+             << ",\n  \"setup\": ";
+        writeStages(json, setup, "  ");
+        json << ",\n  \"scenes\": [";
+        for (size_t i = 0; i < sceneStages.size(); ++i) {
+            const Scene& scene = kScenes[i];
+            json << (i ? ",\n" : "\n") << "    {\"name\": \"" << scene.name << "\", \"type\": \"" << scene.type
+                 << "\", \"centerX\": " << scene.centerX << ", \"centerY\": " << scene.centerY
+                 << ", \"zoom\": " << scene.zoom << ", \"pngBytes\": " << pngBytes[i] << ",\n     \"stages\": ";
+            writeStages(json, sceneStages[i], "     ");
+            json << "}";
+        }
+        json << "\n  ]\n}\n";
+
+        std::ofstream out(opt.output);
+        if (!(out << json.str())) {
+            throw std::runtime_error("Failed to write " + opt.output);
+        }
+        std::cout << "[Stage bench] Results written to " << opt.output << "\n";
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
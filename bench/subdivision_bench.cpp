@@ -0,0 +1,141 @@
+// Subdivision benchmark - brute-force CPU render vs. Mariani-Silver
+// subdivision on the same workers, on views with large in-set areas and on
+// the default overview. Each subdivided frame is diffed pixel by pixel
+// against the brute-force one.
+//
+// Boundary tracing cannot see a speck of pixels that is enclosed on all
+// sides (8-connected) by pixels of the fill value: no border sample ever
+// lands on it. Such specks are reported separately; any other difference is
+// a subdivision bug.
+//
+// Usage: subdivision_bench [width height iterations reps]
+// Exits non-zero if a frame has a difference that is not an enclosed speck.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "config.h"
+#include "constants.h"
+#include "cpu_renderer.h"
+#include "mariani_silver.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+struct View {
+    const char* name;
+    double centerX;
+    double centerY;
+    double zoom;
+};
+
+// Whether the mismatched pixel at index belongs to a speck the border
+// samples cannot reach: every pixel 8-connected to it whose brute-force
+// count differs from the fill value was filled too.
+bool enclosedSpeck(const std::vector<int>& brute, const std::vector<int>& subdivided,
+                   int width, int height, size_t index) {
+    const int fill = subdivided[index];
+    std::vector<char> seen(brute.size(), 0);
+    std::vector<size_t> stack = {index};
+    seen[index] = 1;
+    while (!stack.empty()) {
+        const size_t i = stack.back();
+        stack.pop_back();
+        if (subdivided[i] != fill) {
+            return false;
+        }
+        const int x = static_cast<int>(i % width);
+        const int y = static_cast<int>(i / width);
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int nx = x + dx;
+                const int ny = y + dy;
+                if (nx < 0 || ny < 0 || nx >= width || ny >= height) {
+                    return false;  // Touches the image edge, which is always sampled.
+                }
+                const size_t n = static_cast<size_t>(ny) * width + nx;
+                if (!seen[n] && brute[n] != fill) {
+                    seen[n] = 1;
+                    stack.push_back(n);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Fn>
+double bestMs(int reps, Fn&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < reps; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int width = argc > 1 ? std::stoi(argv[1]) : Defaults::WIDTH;
+    const int height = argc > 2 ? std::stoi(argv[2]) : Defaults::HEIGHT;
+    const int maxIter = argc > 3 ? std::stoi(argv[3]) : 10000;
+    const int reps = argc > 4 ? std::stoi(argv[4]) : 3;
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    const double mpix = static_cast<double>(pixels) / 1e6;
+
+    const View views[] = {
+        {"overview", Defaults::CENTER_X, Defaults::CENTER_Y, Defaults::ZOOM},
+        {"cardioid", -0.3, 0.0, 3.0},
+        {"seahorse", -0.745, 0.11, 40.0},
+    };
+
+    const CpuRenderer cpu;
+    std::cout << "[Subdivision bench] " << width << "x" << height << ", " << maxIter << " iterations, "
+              << CpuRenderer::isaName(cpu.isa()) << " x " << cpu.threadCount() << " threads, best of "
+              << reps << "\n";
+
+    std::vector<int> brute(pixels);
+    std::vector<int> subdivided(pixels);
+    int failures = 0;
+    for (const View& view : views) {
+        const RenderConfig cfg = RenderConfig::builder().width(width).height(height).maxIterations(maxIter)
+                                     .center(view.centerX, view.centerY).zoom(view.zoom).build();
+
+        const double bruteMs = bestMs(reps, [&] { cpu.computeIterations(cfg, brute.data()); });
+        MarianiSilver::Stats stats;
+        const double subMs = bestMs(reps, [&] {
+            stats = MarianiSilver::render(cfg, subdivided.data(),
+                [&](const int* points, size_t count, int* results) {
+                    cpu.computePoints(cfg, points, count, results);
+                },
+                Subdivide::MAX_BATCH_POINTS);
+        });
+
+        size_t mismatches = 0;
+        size_t enclosed = 0;
+        for (size_t i = 0; i < pixels; ++i) {
+            if (brute[i] != subdivided[i]) {
+                ++mismatches;
+                enclosed += enclosedSpeck(brute, subdivided, width, height, i) ? 1 : 0;
+            }
+        }
+        failures += mismatches != enclosed ? 1 : 0;
+
+        std::cout << "[Subdivision bench] " << view.name << ": brute " << mpix / (bruteMs * 1e-3)
+                  << " Mpixel/s, subdivided " << mpix / (subMs * 1e-3) << " Mpixel/s ("
+                  << bruteMs / subMs << "x), "
+                  << 100.0 * static_cast<double>(stats.pixelsIterated) / static_cast<double>(pixels)
+                  << "% iterated, " << stats.rounds << " rounds, "
+                  << mismatches << " mismatched pixels (" << enclosed << " in enclosed specks)\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
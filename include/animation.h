@@ -0,0 +1,43 @@
+// Animation - keyframed paths for center, zoom and Julia c, expanded into one
+// RenderConfig per frame for Renderer::renderSequence.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+class Animation {
+public:
+    // View at a position in [0, 1] along the animation.
+    struct Keyframe {
+        double position;
+        double centerX;
+        double centerY;
+        double zoom;
+        double juliaReal;
+        double juliaImag;
+    };
+
+    explicit Animation(std::vector<Keyframe> keyframes);
+
+    // Load a keyframe file. Format (one keyframe per line, '#' starts a comment):
+    //   <position> <centerX> <centerY> <zoom> [<juliaReal> <juliaImag>]
+    // Julia c defaults to base.juliaReal/juliaImag when omitted. Throws
+    // std::runtime_error on I/O or parse errors.
+    static Animation loadKeyframes(const std::string& path, const RenderConfig& base);
+
+    // frameCount copies of base with the view interpolated between keyframes
+    // and outputPath expanded by framePath().
+    std::vector<RenderConfig> frames(const RenderConfig& base, int frameCount) const;
+
+    // Output path for frame index: a %d / %0Nd in pattern is replaced by the
+    // index, otherwise _NNNNN is inserted before the extension.
+    static std::string framePath(const std::string& pattern, int index);
+
+    const std::vector<Keyframe>& keyframes() const { return keyframes_; }
+
+private:
+    std::vector<Keyframe> keyframes_;
+};
@@ -0,0 +1,93 @@
+// BufferPool - size-class cache of OpenCL buffers and host vectors.
+// Allocations are rounded up to a size class (four classes per power of two)
+// and returned to the pool instead of being freed, so repeated renders of
+// compatible dimensions reuse memory. Idle entries are evicted, oldest first,
+// whenever the pool would exceed its byte budget.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "opencl_include.h"
+
+#include "device_manager.h"
+
+class BufferPool {
+public:
+    struct Stats {
+        uint64_t deviceHits = 0;
+        uint64_t deviceMisses = 0;
+        uint64_t hostHits = 0;
+        uint64_t hostMisses = 0;
+        uint64_t evictions = 0;
+        size_t deviceBytes = 0;  // Live + idle device bytes held by the pool.
+        size_t hostBytes = 0;    // Live + idle host bytes held by the pool.
+    };
+
+    explicit BufferPool(DeviceManager& deviceManager);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Byte budget applied separately to device and host memory; shrinking it
+    // evicts idle entries immediately.
+    void setBudget(size_t deviceBytes, size_t hostBytes);
+
+    // Device buffer of at least bytes with the given flags. Throws
+    // std::runtime_error if clCreateBuffer fails.
+    cl_mem acquireDevice(size_t bytes, cl_mem_flags flags);
+
+    // Return a buffer from acquireDevice; null is ignored.
+    void releaseDevice(cl_mem buffer);
+
+    // Host vector resized to count elements; contents are unspecified.
+    std::vector<int> acquireInts(size_t count);
+    std::vector<unsigned char> acquireBytes(size_t count);
+
+    // Hand a host vector back (its capacity is what gets cached).
+    void releaseInts(std::vector<int>&& v);
+    void releaseBytes(std::vector<unsigned char>&& v);
+
+    const Stats& stats() const { return stats_; }
+
+    // Bytes actually allocated for a request of bytes.
+    static size_t sizeClass(size_t bytes);
+
+private:
+    struct DeviceEntry {
+        cl_mem buffer;
+        uint64_t lastUse;
+    };
+    using DeviceKey = std::pair<cl_mem_flags, size_t>;  // flags, class bytes.
+
+    template <typename T>
+    struct HostEntry {
+        std::vector<T> data;
+        uint64_t lastUse;
+    };
+
+    template <typename T>
+    std::vector<T> acquireHost(std::map<size_t, std::vector<HostEntry<T>>>& idle, size_t count);
+    template <typename T>
+    void releaseHost(std::map<size_t, std::vector<HostEntry<T>>>& idle, std::vector<T>&& v);
+
+    // Evict least recently used idle entries until incoming more bytes fit.
+    void trimDevice(size_t incoming);
+    void trimHost(size_t incoming);
+
+    DeviceManager& deviceManager_;
+    size_t deviceBudget_;
+    size_t hostBudget_;
+    uint64_t clock_ = 0;
+
+    std::map<DeviceKey, std::vector<DeviceEntry>> idleDevice_;
+    std::map<cl_mem, DeviceKey> liveDevice_;
+    std::map<size_t, std::vector<HostEntry<int>>> idleInts_;
+    std::map<size_t, std::vector<HostEntry<unsigned char>>> idleBytes_;
+
+    Stats stats_;
+};
@@ -0,0 +1,43 @@
+// ColorHistogram - histogram-equalized palette positions. The frame's escape
+// counts are binned (per-thread histograms on the host, work-group-local
+// atomics in kernels/colorize.cl on the device), then a parallel prefix sum
+// over the bins gives the CDF: count i is colored at the fraction of escaped
+// pixels with a lower count. The palette spreads over the counts that occur
+// instead of iter / maxIterations, which leaves most of it unused at high
+// iteration limits. When maxIterations exceeds the pixel count, even a
+// histogram sized to the frame's highest count can dwarf the frame, so the
+// escape counts are sorted instead and a count's position is found by
+// binary search.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "iteration_format.h"
+
+class ColorHistogram {
+public:
+    // One bin per escape count up to the frame's highest (at least one), then
+    // one counting in-set pixels (count >= maxIterations); negative counts
+    // land in bin 0. Each worker fills a private histogram over a block of
+    // pixels and the histograms are summed bin-parallel.
+    static std::vector<uint32_t> build(const IterationFrame& frame, int maxIterations, int threadCount = 0);
+
+    // Whether a frame of pixelCount pixels is equalized from sortedEscapes
+    // rather than a histogram (maxIterations > pixelCount).
+    static bool sortsCounts(size_t pixelCount, int maxIterations);
+
+    // The frame's escape counts (in-set pixels left out), ascending.
+    static std::vector<int> sortedEscapes(const IterationFrame& frame, int maxIterations, int threadCount = 0);
+
+    // Palette position of count iter from sortedEscapes: the fraction of
+    // escaped pixels with a lower count, as equalizedPositions gives it.
+    static float sortedPosition(const std::vector<int>& sorted, int iter);
+
+    // Palette position in [0, 1) for each escape bin of such a histogram
+    // (counts past the last bin sit at 1, see Palette::buildLut). Falls back
+    // to i / bins when no pixel escaped.
+    static std::vector<float> equalizedPositions(const std::vector<uint32_t>& histogram, int threadCount = 0);
+};
@@ -19,17 +19,154 @@ struct RenderConfig {
     double centerX = FractalConstants::Defaults::CENTER_X;
     double centerY = FractalConstants::Defaults::CENTER_Y;
 
+    // Center as given in decimal (empty = use centerX/centerY). The deep-zoom
+    // reference orbit parses these directly, so digits beyond a double count.
+    std::string centerXText;
+    std::string centerYText;
+
     double zoom = FractalConstants::Defaults::ZOOM;
 
     // Julia set parameter c = juliaReal + i * juliaImag
     double juliaReal = FractalConstants::Defaults::JULIA_REAL;
     double juliaImag = FractalConstants::Defaults::JULIA_IMAG;
 
-    // Optional work-group size override (0 = let OpenCL decide).
+    // Arithmetic for the iteration: "float", "double-float", "double",
+    // "perturbation" (high-precision reference orbit + double deltas, for deep
+    // zooms) or "auto" (cheapest tier that still resolves a pixel).
+    std::string precision = "auto";
+
+    // Time every precision tier on this view instead of writing an image.
+    bool benchPrecision = false;
+
+    // Interior shortcuts of the float iteration loop: "none", "bulb"
+    // (cardioid / period-2 bulb test), "periodicity" (cycle detection) or "all".
+    std::string interior = "none";
+
+    // Time every interior shortcut at Interior::BENCH_ITERATIONS instead of
+    // writing an image.
+    bool benchInterior = false;
+
+    // Storage of iteration counts from the float kernel to the image writer:
+    // "auto" (narrowest of u8/u16/u32 that holds maxIterations), "u8", "u16",
+    // "u32" or "packed" (count + smooth-coloring fraction byte).
+    std::string iterationFormat = "auto";
+
+    // Iterate with a kernel specialized for this fractal type and iteration
+    // count (KernelVariant, built and cached on first use) instead of the
+    // generic one.
+    bool specialize = false;
+
+    // Time the generic iteration kernel of each tier against its specialized
+    // variants on this view instead of writing an image.
+    bool benchVariants = false;
+
+    // Optional work-group size override (0 = the autotuned size for this
+    // device and tier, else let OpenCL decide).
     int localSizeX = FractalConstants::Defaults::LOCAL_SIZE_AUTO;
     int localSizeY = FractalConstants::Defaults::LOCAL_SIZE_AUTO;
 
+    // Pixels of a row each float-kernel work-item computes (0 = autotuned, else 1).
+    int pixelsPerItem = 0;
+
+    // Sweep work-group sizes for every iteration kernel on this device and
+    // save the fastest to tuningFile (empty = never read or write results).
+    bool autotune = false;
+    std::string tuningFile = FractalConstants::Autotune::DEFAULT_FILE;
+
+    // Render backend: "opencl", "cpu" (native SIMD threads) or "auto"
+    // (OpenCL when a platform is available, otherwise CPU).
+    std::string backend = "opencl";
+
+    // Preferred OpenCL device type: "gpu" (fallback to CPU) or "cpu".
+    std::string deviceType = "gpu";
+
+    // Host worker threads: CPU backend, coloring and PNG encoding (0 = one per
+    // hardware thread).
+    int threads = FractalConstants::Defaults::THREADS_AUTO;
+
+    // Tiled rendering: force it on, and/or cap the device bytes per tile
+    // (0 = CL_DEVICE_MAX_MEM_ALLOC_SIZE). Frames larger than the cap are always tiled.
+    bool tiled = false;
+    int tileMemoryMB = FractalConstants::Defaults::TILE_MEMORY_AUTO;
+
+    // Streaming pipeline: render in horizontal bands, overlapping kernel,
+    // readback and color/encode (bandRows 0 = derived from image width).
+    bool streaming = false;
+    int bandRows = FractalConstants::Defaults::BAND_ROWS_AUTO;
+
+    // Color on the device (color-mapping kernel) and read back RGB8 instead
+    // of iteration counts.
+    bool deviceColor = false;
+
+    // How full-frame iteration counts reach the host: "copy"
+    // (clEnqueueReadBuffer into a host vector), "map" (the device buffer is
+    // allocated host-accessible and mapped in place) or "auto" (map on devices
+    // with host-unified memory, copy otherwise).
+    std::string readback = "auto";
+
+    // Mariani-Silver subdivision: iterate tile borders and flood-fill tiles
+    // whose border has one iteration count (float tier only).
+    bool subdivide = false;
+
+    // Edge anti-aliasing: extra jittered subsamples for each pixel whose
+    // count differs from a neighbour (0 = off, float tier only).
+    int antialiasSamples = 0;
+
+    // Render on every OpenCL device of every platform, handing out row chunks
+    // of chunkRows rows to whichever device is free (0 = about
+    // MultiDevice::CHUNKS_PER_DEVICE chunks per device).
+    bool multiDevice = false;
+    int chunkRows = 0;
+
+    // Byte budget for the device and host buffer pools, each (0 = half of
+    // device global memory for the device pool, 1 GiB for the host pool).
+    int poolMemoryMB = FractalConstants::Defaults::POOL_MEMORY_AUTO;
+
+    // Animation mode: keyframe file (empty = single image) and frame count.
+    // outputPath becomes a per-frame pattern (see Animation::framePath).
+    std::string animationFile;
+    int frameCount = FractalConstants::Defaults::ANIMATION_FRAMES;
+
+    // Server mode: "" (render once), "stdin" or "socket" (at socketPath).
+    // serverJobs 0 = 2 on OpenCL, 1 on the CPU backend; queueDepth 0 = default.
+    // Requests larger than serverMaxMegapixels or deeper than
+    // serverMaxIterations are refused.
+    std::string serveMode;
+    std::string socketPath;
+    int serverJobs = 0;
+    int queueDepth = 0;
+    int serverMaxMegapixels = FractalConstants::Server::MAX_MEGAPIXELS;
+    int serverMaxIterations = FractalConstants::Server::MAX_ITERATIONS;
+
+    // Directory for cached OpenCL program binaries (empty = always build
+    // from source).
+    std::string kernelCacheDir = FractalConstants::KernelCache::DEFAULT_DIRECTORY;
+
+    // Chrome trace-event JSON of host stages and OpenCL commands (empty = no
+    // tracing).
+    std::string traceFile;
+
     std::string palette = "default";
+    std::string paletteFile;  // Optional gradient file; overrides palette when set.
+    // How counts map onto the palette: "linear" (iter / maxIterations) or
+    // "histogram" (equalized by the frame's count histogram).
+    std::string coloring = "linear";
+
+    // PNG encoding: zlib level 0 (store only) .. 9, and the row filter
+    // ("auto" = adaptive, or none at level 0; "adaptive", "none", "sub", "up",
+    // "average" or "paeth").
+    int pngLevel = FractalConstants::Png::DEFAULT_LEVEL;
+    std::string pngFilter = "auto";
+
+    // Also save the frame's iteration counts to fieldPath (empty = no field),
+    // optionally as zlib chunks; see IterationField.
+    std::string fieldPath;
+    bool fieldCompress = false;
+
+    // Recolor mode: load this iteration field and write it with the palette,
+    // coloring and output options instead of rendering (empty = render).
+    std::string recolorFile;
+
     std::string outputPath = "images/fractal.png";  // Default output goes to images/.
 
     struct Builder;
@@ -44,12 +181,55 @@ struct RenderConfig::Builder {
     Builder& height(int h) { cfg.height = h; return *this; }
     Builder& maxIterations(int it) { cfg.maxIterations = it; return *this; }
     Builder& fractalType(const std::string& t) { cfg.fractalType = t; return *this; }
-    Builder& center(double x, double y) { cfg.centerX = x; cfg.centerY = y; return *this; }
+    Builder& center(double x, double y) { cfg.centerX = x; cfg.centerY = y; cfg.centerXText.clear(); cfg.centerYText.clear(); return *this; }
+    Builder& center(const std::string& x, const std::string& y) {
+        cfg.centerX = std::stod(x); cfg.centerY = std::stod(y); cfg.centerXText = x; cfg.centerYText = y; return *this;
+    }
     Builder& zoom(double z) { cfg.zoom = z; return *this; }
     Builder& palette(const std::string& p) { cfg.palette = p; return *this; }
+    Builder& paletteFile(const std::string& path) { cfg.paletteFile = path; return *this; }
+    Builder& coloring(const std::string& c) { cfg.coloring = c; return *this; }
+    Builder& pngLevel(int level) { cfg.pngLevel = level; return *this; }
+    Builder& pngFilter(const std::string& f) { cfg.pngFilter = f; return *this; }
     Builder& outputPath(const std::string& path) { cfg.outputPath = path; return *this; }
+    Builder& saveField(const std::string& path) { cfg.fieldPath = path; return *this; }
+    Builder& fieldCompress(bool c) { cfg.fieldCompress = c; return *this; }
+    Builder& recolorFile(const std::string& path) { cfg.recolorFile = path; return *this; }
     Builder& julia(double real, double imag) { cfg.juliaReal = real; cfg.juliaImag = imag; return *this; }
+    Builder& precision(const std::string& p) { cfg.precision = p; return *this; }
+    Builder& benchPrecision(bool b) { cfg.benchPrecision = b; return *this; }
+    Builder& interior(const std::string& i) { cfg.interior = i; return *this; }
+    Builder& iterationFormat(const std::string& f) { cfg.iterationFormat = f; return *this; }
+    Builder& benchInterior(bool b) { cfg.benchInterior = b; return *this; }
+    Builder& specialize(bool s) { cfg.specialize = s; return *this; }
+    Builder& benchVariants(bool b) { cfg.benchVariants = b; return *this; }
     Builder& localSize(int lx, int ly) { cfg.localSizeX = lx; cfg.localSizeY = ly; return *this; }
+    Builder& pixelsPerItem(int n) { cfg.pixelsPerItem = n; return *this; }
+    Builder& autotune(bool a) { cfg.autotune = a; return *this; }
+    Builder& tuningFile(const std::string& path) { cfg.tuningFile = path; return *this; }
+    Builder& backend(const std::string& b) { cfg.backend = b; return *this; }
+    Builder& deviceType(const std::string& d) { cfg.deviceType = d; return *this; }
+    Builder& threads(int n) { cfg.threads = n; return *this; }
+    Builder& tiled(bool t) { cfg.tiled = t; return *this; }
+    Builder& tileMemoryMB(int mb) { cfg.tileMemoryMB = mb; return *this; }
+    Builder& streaming(bool s) { cfg.streaming = s; return *this; }
+    Builder& bandRows(int rows) { cfg.bandRows = rows; return *this; }
+    Builder& deviceColor(bool d) { cfg.deviceColor = d; return *this; }
+    Builder& readback(const std::string& r) { cfg.readback = r; return *this; }
+    Builder& subdivide(bool s) { cfg.subdivide = s; return *this; }
+    Builder& antialiasSamples(int n) { cfg.antialiasSamples = n; return *this; }
+    Builder& multiDevice(bool m) { cfg.multiDevice = m; return *this; }
+    Builder& chunkRows(int rows) { cfg.chunkRows = rows; return *this; }
+    Builder& poolMemoryMB(int mb) { cfg.poolMemoryMB = mb; return *this; }
+    Builder& animation(const std::string& path) { cfg.animationFile = path; return *this; }
+    Builder& frameCount(int n) { cfg.frameCount = n; return *this; }
+    Builder& serve(const std::string& mode, const std::string& path = "") { cfg.serveMode = mode; cfg.socketPath = path; return *this; }
+    Builder& serverJobs(int n) { cfg.serverJobs = n; return *this; }
+    Builder& queueDepth(int n) { cfg.queueDepth = n; return *this; }
+    Builder& serverMaxMegapixels(int n) { cfg.serverMaxMegapixels = n; return *this; }
+    Builder& serverMaxIterations(int n) { cfg.serverMaxIterations = n; return *this; }
+    Builder& kernelCacheDir(const std::string& dir) { cfg.kernelCacheDir = dir; return *this; }
+    Builder& traceFile(const std::string& path) { cfg.traceFile = path; return *this; }
 
     RenderConfig build() const { return cfg; }
 };
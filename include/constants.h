@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace FractalConstants {
 
 // Default render configuration values.
@@ -16,15 +18,25 @@ namespace Defaults {
     constexpr double JULIA_REAL = -0.7;
     constexpr double JULIA_IMAG = 0.27015;
     constexpr int LOCAL_SIZE_AUTO = 0;  // Let OpenCL choose work-group size.
+    constexpr int THREADS_AUTO = 0;  // One CPU worker per hardware thread.
+    constexpr int TILE_MEMORY_AUTO = 0;  // Tile budget = device max allocation.
+    constexpr int BAND_ROWS_AUTO = 0;  // Streaming band height derived from width.
+    constexpr int ANIMATION_FRAMES = 60;  // Frames rendered by --animate without --frames.
+    constexpr int POOL_MEMORY_AUTO = 0;  // Pool budget derived from device memory.
 }
 
 // Color/graphics constants.
 namespace Color {
     constexpr unsigned char MAX_RGB = 255;
     constexpr float MAX_RGB_F = 255.0f;
+    constexpr size_t COLORIZE_CHUNK_PIXELS = 1 << 16;  // Pixels per host colorize task.
+    // Largest palette table (maxIterations + 1 entries, 7 bytes each). Above
+    // it pixels are colored through the palette directly.
+    constexpr int MAX_LUT_ENTRIES = 1 << 22;
 }
 
-// Kernel/mathematical constants.
+// Kernel/mathematical constants, also passed to the kernels as -D build
+// options (KernelManager).
 namespace Kernel {
     // Complex plane viewport scaling factors (from pixel space to complex plane).
     constexpr float VIEWPORT_SCALE_X = 3.5f;
@@ -36,6 +48,149 @@ namespace Kernel {
     constexpr float JULIA_MULTIPLIER = 2.0f;  // 2 * z in z^2 + c.
 }
 
+// CPU backend constants.
+namespace Cpu {
+    constexpr int ROWS_PER_TASK = 4;  // Rows handed to a worker per dynamic-schedule grab.
+    constexpr int AVX2_LANES = 8;  // floats per __m256.
+    constexpr int AVX512_LANES = 16;  // floats per __m512.
+    constexpr size_t POINTS_PER_TASK = 1024;  // Scattered pixels per worker grab (subdivision).
+}
+
+// Iteration buffer formats (IterationFormat).
+namespace IterationStorage {
+    constexpr int U8_MAX_ITERATIONS = 255;
+    constexpr int U16_MAX_ITERATIONS = 65535;
+    constexpr int PACKED_FRACTION_BITS = 8;  // Low bits of a packed word: smooth-coloring fraction.
+    constexpr int PACKED_MAX_ITERATIONS = (1 << (32 - PACKED_FRACTION_BITS)) - 1;
+}
+
+// Histogram-equalized coloring constants.
+namespace Histogram {
+    constexpr size_t MIN_BLOCK_PIXELS = 1 << 16;  // Host: pixels per private histogram, at least.
+    constexpr int MERGE_BINS_PER_TASK = 4096;  // Host: bins summed per worker grab when merging.
+    constexpr size_t DEVICE_GROUPS = 256;  // Device: work-groups of the histogram kernel.
+    constexpr size_t DEVICE_LOCAL_SIZE = 256;  // Device: work-items per group.
+}
+
+// Multi-device scheduling constants.
+namespace MultiDevice {
+    constexpr int CHUNKS_PER_DEVICE = 16;  // Auto chunk height aims for this many chunks per device.
+    constexpr int MIN_CHUNK_ROWS = 4;  // Auto chunks never get thinner than this.
+}
+
+// Streaming pipeline constants.
+namespace Streaming {
+    constexpr int BAND_SLOTS = 3;  // Bands in flight: compute, readback, color/encode.
+    constexpr size_t TARGET_BAND_PIXELS = 1 << 20;  // Auto band height aims for ~1 Mpixel.
+}
+
+// Animation (frame sequence) constants.
+namespace Sequence {
+    constexpr int FRAME_SLOTS = 2;  // Double-buffered frames: one computing, one read back.
+    constexpr int FRAME_NUMBER_DIGITS = 5;  // Zero padding of frame numbers in output paths.
+}
+
+// Render server constants.
+namespace Server {
+    constexpr int OPENCL_JOBS = 2;  // Default concurrent jobs on an OpenCL device.
+    constexpr size_t QUEUE_DEPTH = 16;  // Default bound on queued requests.
+    constexpr int POLL_INTERVAL_MS = 200;  // How often blocked reads check for shutdown.
+    constexpr int SOCKET_BACKLOG = 16;
+    constexpr size_t READ_CHUNK_BYTES = 4096;
+    constexpr size_t MAX_REQUEST_BYTES = 1 << 20;  // Longest accepted request line.
+    constexpr int MAX_MEGAPIXELS = 256;  // Default cap on width * height per request.
+    constexpr int MAX_ITERATIONS = 10000000;  // Default cap on maxIterations per request.
+}
+
+// Buffer pool constants.
+namespace Pool {
+    constexpr size_t MIN_CLASS_BYTES = 64 << 10;  // Smallest size class.
+    constexpr size_t CLASSES_PER_DOUBLING = 4;  // Size classes between powers of two.
+    constexpr size_t DEVICE_BUDGET_DIVISOR = 2;  // Auto device budget = global memory / 2.
+    constexpr size_t FALLBACK_BUDGET_BYTES = size_t{1} << 30;  // Auto host budget, or device without a size.
+}
+
+// Mariani-Silver subdivision constants.
+namespace Subdivide {
+    constexpr int TILE_SIZE = 64;  // Initial rectangle edge in pixels.
+    constexpr int MIN_SPLIT_SIZE = 4;  // Smaller rectangles are iterated outright.
+    constexpr size_t MAX_BATCH_POINTS = size_t{1} << 20;  // Pixels per evaluation batch (device buffer size).
+}
+
+// Adaptive edge anti-aliasing constants.
+namespace Antialias {
+    constexpr int MAX_SAMPLES = 64;
+    constexpr size_t MAX_BATCH_SAMPLES = size_t{1} << 20;  // Subsamples per evaluation batch.
+    constexpr int ROWS_PER_TASK = 16;  // Edge detection rows per worker task.
+}
+
+// Interior shortcut constants (the first three are kernel build options).
+namespace Interior {
+    constexpr int BULB_FLAG = 1;  // Cardioid / period-2 bulb test.
+    constexpr int PERIODICITY_FLAG = 2;  // Brent cycle detection.
+    constexpr int PERIOD_WINDOW_START = 8;  // First interval between saved orbit points; doubles after each.
+    constexpr int BENCH_ITERATIONS[] = {1000, 10000, 100000};  // --bench-interior iteration counts.
+    constexpr int BENCH_REPEATS = 3;  // --bench-interior reports the best of this many runs.
+}
+
+// Precision tier selection constants.
+namespace Precision {
+    constexpr int FLOAT_MANTISSA_BITS = 24;
+    constexpr int DOUBLE_FLOAT_MANTISSA_BITS = 44;  // float2 hi+lo, a few bits short of 48 after rounding.
+    constexpr int DOUBLE_MANTISSA_BITS = 53;
+    constexpr double MIN_ULPS_PER_PIXEL = 4.0;  // Neighbouring pixels must be this many ulps apart.
+    constexpr double MIN_ORBIT_MAGNITUDE = 1.0;  // Typical |z| near the set boundary.
+    constexpr int BENCH_REPEATS = 3;  // --bench-precision reports the best of this many runs.
+}
+
+// Deep-zoom (perturbation) constants.
+namespace DeepZoom {
+    constexpr int GUARD_BITS = 64;  // Reference orbit bits beyond one pixel's depth.
+    constexpr int MIN_FRAC_LIMBS = 2;  // Smallest FixedPoint fraction (64 bits).
+    constexpr int PROBE_WIDTH = 64;  // Probe render for reference selection (height by aspect).
+    constexpr int REFERENCE_RETRIES = 4;  // Reference moves while the orbit still escapes.
+}
+
+// OpenCL program binary cache constants.
+namespace KernelCache {
+    constexpr const char* DEFAULT_DIRECTORY = "build/kernel_cache";
+    constexpr size_t MAX_BINARY_BYTES = size_t{256} << 20;  // Larger entries are treated as corrupt.
+}
+
+// Work-group size autotuning constants.
+namespace Autotune {
+    constexpr const char* DEFAULT_FILE = "build/autotune.txt";
+    constexpr int FRAME_WIDTH = 1024;  // Sweep frame: divisible by every power-of-two width tried.
+    constexpr int FRAME_HEIGHT = 768;
+    constexpr int REPEATS = 3;  // Each candidate reports the best of this many launches.
+    constexpr int MAX_LOCAL_Y = 64;
+    constexpr int PIXELS_PER_ITEM[] = {1, 2, 4};  // Float kernel only.
+    constexpr int REPORT_TOP = 5;  // Fastest candidates printed per kernel.
+}
+
+// Parallel PNG encoder constants.
+namespace Png {
+    constexpr int DEFAULT_LEVEL = 6;  // zlib's default speed/size tradeoff.
+    constexpr size_t CHUNK_BYTES = size_t{256} << 10;  // Filtered bytes deflated per job / IDAT.
+    constexpr size_t WINDOW_BYTES = 32768;  // Deflate window: dictionary carried into each chunk.
+    constexpr int MEM_LEVEL = 8;
+    constexpr size_t FLUSH_SLACK_BYTES = 16;  // Sync-flush marker beyond deflateBound.
+}
+
+// Specialized iteration kernels (KernelVariant, --specialize).
+namespace Specialize {
+    constexpr int DEFAULT_UNROLL = 4;  // Escape-loop steps per bound check.
+    constexpr int BENCH_UNROLLS[] = {2, 4, 8};  // --bench-variants unroll factors.
+    constexpr int BENCH_REPEATS = 3;  // --bench-variants reports the best of this many runs.
+}
+
+// Iteration-field file (--save-field / --recolor) constants.
+namespace Field {
+    constexpr size_t CHUNK_BYTES = size_t{1} << 20;  // Raw bytes per compressed chunk (whole rows).
+    constexpr int COMPRESS_LEVEL = 1;  // zlib level: fields are large and mostly run-length.
+    constexpr size_t DATA_ALIGN_BYTES = 4096;  // Data starts page-aligned for mmap.
+}
+
 // Device/system constants.
 namespace Device {
     constexpr size_t INFO_BUFFER_SIZE = 256;  // Size for device name/vendor queries.
@@ -0,0 +1,48 @@
+// CpuRenderer - native multithreaded SIMD backend for escape-time iterations.
+// Mirrors mandelbrot_iterations in kernels/mandelbrot.cl so the host buffer it
+// fills can go through the same output path as the OpenCL backend.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "config.h"
+
+// Instruction set used for the per-row inner loop.
+enum class CpuIsa {
+    Auto,    // Best supported by the running CPU.
+    Scalar,
+    Avx2,    // 8 pixels per lane group.
+    Avx512   // 16 pixels per lane group.
+};
+
+class CpuRenderer {
+public:
+    explicit CpuRenderer(int threadCount = 0, CpuIsa isa = CpuIsa::Auto);
+
+    // Compute iteration counts for the full image into out (width*height ints).
+    void computeIterations(const RenderConfig& cfg, int* out) const;
+
+    // Compute rows [rowBegin, rowEnd) of the full image; out points at rowBegin.
+    void computeRows(const RenderConfig& cfg, int rowBegin, int rowEnd, int* out) const;
+
+    // Iterate count scattered pixels given as (x, y) pairs into out[0..count).
+    // Same lane loops and per-pixel math as the row path, so results match.
+    void computePoints(const RenderConfig& cfg, const int* points, size_t count, int* out) const;
+
+    // Same for sub-pixel positions given as float (x, y) pairs.
+    void computeSamples(const RenderConfig& cfg, const float* samples, size_t count, int* out) const;
+
+    CpuIsa isa() const { return isa_; }
+    int threadCount() const { return threadCount_; }
+
+    static std::string isaName(CpuIsa isa);
+
+    // Best instruction set supported by the running CPU.
+    static CpuIsa detectIsa();
+
+private:
+    int threadCount_;
+    CpuIsa isa_;
+};
@@ -3,8 +3,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
-#include <OpenCL/opencl.h>
+#include "opencl_include.h"
 
 class DeviceManager {
 public:
@@ -12,25 +13,61 @@ public:
     ~DeviceManager();
 
     // Query platforms/devices and pick a default GPU (fallback to CPU).
-    void initialize();
+    // With preferCpu set, the CPU device is tried first instead.
+    void initialize(bool preferCpu = false);
+
+    // Create the context and queues for one specific device (multi-device
+    // mode creates one DeviceManager per entry of enumerateDevices()).
+    void initializeDevice(cl_device_id device);
+
+    // Every device of every platform, in platform order.
+    static std::vector<cl_device_id> enumerateDevices();
 
     // Print basic device info.
     void printDiagnostics() const;
 
     std::string deviceName() const { return deviceName_; }
 
+    // Largest single buffer the device accepts (CL_DEVICE_MAX_MEM_ALLOC_SIZE).
+    cl_ulong maxMemAllocSize() const { return maxMemAllocSize_; }
+    cl_ulong globalMemSize() const { return globalMemSize_; }
+
+    // Work-group local memory (CL_DEVICE_LOCAL_MEM_SIZE).
+    cl_ulong localMemSize() const { return localMemSize_; }
+
+    // Whether the device shares physical memory with the host
+    // (CL_DEVICE_HOST_UNIFIED_MEMORY): CPU and integrated GPU devices, where a
+    // mapped buffer needs no copy.
+    bool hostUnifiedMemory() const { return hostUnifiedMemory_; }
+
+    // Double precision support (cl_khr_fp64), needed by the perturbation kernel.
+    bool supportsFp64() const { return supportsFp64_; }
+
+    // Whether device lists extension in CL_DEVICE_EXTENSIONS.
+    static bool hasExtension(cl_device_id device, const std::string& extension);
+
     cl_context context() const { return context_; }
     cl_command_queue commandQueue() const { return queue_; }
+
+    // Second in-order queue for readbacks, so copies can overlap kernels
+    // running on commandQueue() (streaming pipeline).
+    cl_command_queue transferQueue() const { return transferQueue_; }
     cl_device_id device() const { return device_; }
 
 private:
     std::string deviceName_{"(no device initialized)"};
     std::string deviceVendor_{"(unknown vendor)"};
+    cl_ulong maxMemAllocSize_{0};
+    cl_ulong globalMemSize_{0};
+    cl_ulong localMemSize_{0};
+    bool supportsFp64_{false};
+    bool hostUnifiedMemory_{false};
 
     cl_platform_id platform_{};
     cl_device_id device_{};
     cl_context context_{};
     cl_command_queue queue_{};
+    cl_command_queue transferQueue_{};
 };
 
 
@@ -0,0 +1,45 @@
+// DeviceSet - one context, queue and kernel set per OpenCL device, across
+// every platform (multi-device rendering). Each member is an ordinary
+// DeviceManager + KernelManager pair bound to its own device, so members can
+// be driven from separate host threads. The primary device reuses the
+// managers the renderer already initialized instead of a second context.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "device_manager.h"
+#include "kernel_manager.h"
+
+class DeviceSet {
+public:
+    struct Member {
+        DeviceManager* device = nullptr;
+        KernelManager* kernels = nullptr;
+    };
+
+    // Initialize every device DeviceManager::enumerateDevices() returns,
+    // except primary's device, whose member is primary/primaryKernels
+    // (borrowed; they must outlive the set). Devices whose context or kernels
+    // fail to build are reported and skipped; throws std::runtime_error if
+    // none is usable.
+    void initialize(const std::string& kernelsRoot, const std::string& cacheDirectory,
+                    DeviceManager& primary, KernelManager& primaryKernels);
+
+    size_t size() const { return members_.size(); }
+    Member& member(size_t index) { return members_[index]; }
+
+    // Iteration tiers every member has built, in the first member's cost
+    // order (so all devices run the same arithmetic).
+    std::vector<PrecisionTier> commonTiers() const;
+
+    // Print one line per member.
+    void printDiagnostics() const;
+
+private:
+    std::vector<Member> members_;
+    std::vector<std::unique_ptr<DeviceManager>> ownedDevices_;  // Non-primary members.
+    std::vector<std::unique_ptr<KernelManager>> ownedKernels_;
+};
@@ -0,0 +1,48 @@
+// EdgeAntialias - adaptive supersampling of edge pixels only.
+// After the base pass, a pixel whose iteration count differs from one of its
+// four neighbours is an edge pixel. Each edge pixel gets samplesPerPixel extra
+// jittered subsamples (an R2 low-discrepancy pattern rotated per pixel), which
+// are iterated in compacted batches of positions, so flat regions cost
+// nothing. Its color becomes the average of the base sample and subsample
+// colors through the palette LUT.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "config.h"
+#include "palette.h"
+
+class EdgeAntialias {
+public:
+    struct Stats {
+        uint64_t edgePixels = 0;
+        uint64_t samples = 0;
+        int batches = 0;
+    };
+
+    // Iterate count sub-pixel positions given as (x, y) float pairs, writing
+    // results[0..count).
+    using EvaluateFn = std::function<void(const float* samples, size_t count, int* results)>;
+
+    // Indices of edge pixels in counts (width*height ints), ascending.
+    static std::vector<uint32_t> findEdges(const int* counts, int width, int height, int threadCount = 0);
+
+    // samplesPerPixel (x, y) positions per edge pixel into out
+    // (edgeCount * samplesPerPixel * 2 floats). Deterministic per pixel.
+    static void samplePositions(const uint32_t* edges, size_t edgeCount, int width,
+                                int samplesPerPixel, float* out);
+
+    // Recolor the edge pixels of rgb (the base frame colored with lut) with
+    // cfg.antialiasSamples subsamples each, calling evaluate with at most
+    // maxBatchSamples positions at a time.
+    static Stats apply(const RenderConfig& cfg,
+                       const int* counts,
+                       const PaletteLut& lut,
+                       unsigned char* rgb,
+                       const EvaluateFn& evaluate,
+                       size_t maxBatchSamples);
+};
@@ -0,0 +1,45 @@
+// FixedPoint - arbitrary-precision signed fixed-point number for the deep-zoom
+// reference orbit. Values are a sign plus a magnitude of 32-bit limbs: the
+// top limb holds the integer part, the others fracLimbs * 32 fraction bits.
+// Orbit values stay below the escape radius, so one integer limb is plenty.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class FixedPoint {
+public:
+    explicit FixedPoint(int fracLimbs = 2);
+
+    // Parse a decimal such as "-0.7436438870371587047521915061" or "1.5e-3"
+    // without going through double. Throws std::runtime_error on bad input.
+    static FixedPoint fromString(const std::string& text, int fracLimbs);
+
+    // Exact conversion of a double with |v| < 2^32.
+    static FixedPoint fromDouble(double v, int fracLimbs);
+
+    double toDouble() const;
+
+    int fracLimbs() const { return fracLimbs_; }
+
+    FixedPoint operator+(const FixedPoint& o) const;
+    FixedPoint operator-(const FixedPoint& o) const;
+    FixedPoint operator*(const FixedPoint& o) const;
+
+private:
+    // |this| vs |o|: -1, 0, 1.
+    int compareMagnitude(const FixedPoint& o) const;
+    // Limb-wise magnitude sum / difference (subMagnitude needs |a| >= |b|).
+    static std::vector<uint32_t> addMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+    static std::vector<uint32_t> subMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+    FixedPoint addSigned(const FixedPoint& o, bool negateOther) const;
+    // Divide the magnitude by a small integer in place (decimal parsing).
+    void divideBy(uint32_t d);
+    bool isZero() const;
+
+    int fracLimbs_;
+    bool negative_ = false;
+    std::vector<uint32_t> limbs_;  // Little-endian; limbs_[fracLimbs_] is the integer part.
+};
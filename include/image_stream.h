@@ -0,0 +1,28 @@
+// ImageStreamWriter - row-by-row PPM/PNG encoders for streaming output.
+// Rows are encoded as they arrive, so a render never has to hold the whole
+// RGB frame in memory. PNG output uses zlib's streaming deflate on one thread
+// (rows arrive in order), with PngEncoder's row filters.
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "png_encoder.h"
+
+class ImageStreamWriter {
+public:
+    virtual ~ImageStreamWriter() = default;
+
+    // Append rowCount rows of packed RGB8 (width * 3 bytes each, top to bottom).
+    virtual void writeRows(const unsigned char* rgb, int rowCount) = 0;
+
+    // Flush trailing encoder state; call once after the last row.
+    virtual void finish() = 0;
+
+    // Choose format based on file extension (".png" -> PNG, otherwise PPM),
+    // matching OutputWriter::writeImage. png sets the compression level and row
+    // filter (threads is ignored). Throws std::runtime_error on failure.
+    static std::unique_ptr<ImageStreamWriter> open(const std::string& path, int width, int height,
+                                                   const PngOptions& png = PngOptions());
+};
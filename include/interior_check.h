@@ -0,0 +1,27 @@
+// InteriorCheck - shortcuts that stop iterating pixels inside the set early.
+// Bulb: points in the main cardioid or the period-2 bulb are in the set
+// (closed-form test, Mandelbrot only) and skip the loop entirely.
+// Periodicity: Brent-style cycle detection; the orbit is compared against a
+// saved point that is refreshed at power-of-two intervals, and a repeat
+// proves the orbit never escapes. Comparisons are exact, so the shortcut
+// only fires on orbits the full loop would also run to maxIterations.
+
+#pragma once
+
+#include <string>
+
+enum class InteriorCheck {
+    None,         // Plain escape-time loop.
+    Bulb,         // Cardioid / period-2 bulb test.
+    Periodicity,  // Brent cycle detection (Mandelbrot and Julia).
+    All           // Both.
+};
+
+// "none", "bulb", "periodicity" or "all" (the --interior names).
+std::string interiorCheckName(InteriorCheck check);
+
+// Inverse of interiorCheckName; throws std::runtime_error on unknown names.
+InteriorCheck interiorCheckFromName(const std::string& name);
+
+// Interior::BULB_FLAG / PERIODICITY_FLAG bits passed to the iteration loops.
+int interiorCheckFlags(InteriorCheck check);
@@ -0,0 +1,63 @@
+// IterationField - binary file of one frame's iteration counts, so a view can
+// be recolored (other palette, coloring or output) without rendering again.
+//
+// Layout (integers little-endian):
+//   "FRACFLD\0", u32 version, u32 dataOffset, u32 width, u32 height,
+//   u32 format (IterationFormat code), u32 bytesPerPixel,
+//   u32 compression (0 = raw, 1 = zlib chunks), u32 chunkRows, u64 dataBytes,
+//   u32 configBytes, configBytes of flat JSON (the RenderConfig fields of the
+//   view, as accepted by applyJsonConfig), then for compressed files one u64
+//   compressed size per chunk. Data starts at dataOffset (page-aligned):
+//   the frame exactly as it was read back, or chunks of chunkRows rows, each
+//   byte-shuffled (all first bytes of its pixels, then all second bytes, ...)
+//   and deflated on its own so chunks compress and inflate in parallel.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "iteration_format.h"
+
+class IterationField {
+public:
+    // Write frame (cfg.width x cfg.height counts) with cfg's view to path.
+    // Raw data is written straight from frame.data; compressed chunks are
+    // built on threadCount workers (0 = all cores). Throws
+    // std::runtime_error on failure.
+    static void write(const std::string& path, const RenderConfig& cfg, const IterationFrame& frame,
+                      bool compress, int threadCount = 0);
+
+    // Map path read-only. Raw fields are used in place; compressed ones are
+    // inflated on threadCount workers into a host frame. Throws
+    // std::runtime_error on missing, truncated or malformed files.
+    static IterationField open(const std::string& path, int threadCount = 0);
+
+    IterationField(IterationField&& other) noexcept;
+    IterationField& operator=(IterationField&& other) noexcept;
+    IterationField(const IterationField&) = delete;
+    IterationField& operator=(const IterationField&) = delete;
+    ~IterationField();
+
+    // The stored view: size, iteration count, fractal and coordinates, and
+    // the coloring it was first written with.
+    const RenderConfig& config() const { return config_; }
+
+    // Counts in the stored format; valid while this object lives.
+    IterationFrame frame() const { return frame_; }
+
+    bool compressed() const { return !inflated_.empty(); }
+    size_t fileBytes() const { return mappingBytes_; }
+
+private:
+    IterationField() = default;
+    void unmap();
+
+    RenderConfig config_;
+    IterationFrame frame_;
+    void* mapping_ = nullptr;
+    size_t mappingBytes_ = 0;
+    std::vector<unsigned char> inflated_;
+};
@@ -0,0 +1,46 @@
+// IterationFormat - storage width of per-pixel iteration counts between the
+// float kernel, the host frame and OutputWriter. Most renders stay far below
+// 65536 iterations, so narrow formats halve or quarter the readback and the
+// host frame. Packed keeps a 24-bit count plus an 8-bit smooth-coloring
+// fraction (1 - log2(log2 |z|) at escape) that OutputWriter blends between
+// neighbouring palette entries.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "config.h"
+
+// Enumerator values are the format codes the kernel switches on.
+enum class IterationFormat {
+    U8 = 0,      // uint8 counts (maxIterations <= 255).
+    U16 = 1,     // uint16 counts (maxIterations <= 65535).
+    U32 = 2,     // int counts, the classic full-width frame.
+    Packed = 3   // uint32: count << 8 | smooth fraction.
+};
+
+// "u8", "u16", "u32" or "packed" (the --iteration-format names).
+std::string iterationFormatName(IterationFormat format);
+
+// Inverse of iterationFormatName; throws std::runtime_error on unknown names.
+IterationFormat iterationFormatFromName(const std::string& name);
+
+// Bytes per pixel on the device and in the host frame.
+size_t iterationFormatBytes(IterationFormat format);
+
+// Largest iteration count the format can hold.
+int iterationFormatMaxIterations(IterationFormat format);
+
+// cfg.iterationFormat when it names a format, otherwise the narrowest plain
+// count format that holds cfg.maxIterations. Throws std::runtime_error if an
+// explicit format cannot hold cfg.maxIterations.
+IterationFormat chooseIterationFormat(const RenderConfig& cfg);
+
+// Read-only view of one frame of iteration data in any format. U32 data is
+// int; U8/U16 are uint8_t/uint16_t; Packed is uint32_t.
+struct IterationFrame {
+    IterationFormat format = IterationFormat::U32;
+    const void* data = nullptr;
+    size_t pixelCount = 0;
+};
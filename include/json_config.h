@@ -0,0 +1,35 @@
+// JSON helpers for the render server: parse one flat JSON object per request
+// line into a RenderConfig and quote strings for responses. Only what the
+// request protocol needs is supported (objects of strings, numbers, booleans
+// and null; no nesting).
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "config.h"
+
+struct JsonScalar {
+    enum class Type { String, Number, Bool, Null };
+    Type type = Type::Null;
+    std::string text;  // Unescaped string, or the literal number/true/false.
+};
+
+using JsonObject = std::map<std::string, JsonScalar>;
+
+// Parse a single flat JSON object; throws std::runtime_error on malformed input.
+JsonObject parseJsonObject(const std::string& text);
+
+// Apply request fields over base. Keys use RenderConfig field names
+// (width, height, maxIterations, fractalType, centerX, ...); keys listed in
+// ignoredKeys are skipped, any other unknown key throws std::runtime_error.
+RenderConfig applyJsonConfig(const JsonObject& obj,
+                             RenderConfig base,
+                             const std::map<std::string, bool>& ignoredKeys = {});
+
+// s as a quoted, escaped JSON string.
+std::string jsonQuote(const std::string& s);
+
+// A scalar written back as JSON (echoing request ids).
+std::string jsonValue(const JsonScalar& v);
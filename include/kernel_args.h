@@ -0,0 +1,27 @@
+// Kernel arguments - host-side argument setup shared by everything that
+// launches the iteration kernels (Renderer, the stage benchmark).
+
+#pragma once
+
+#include "config.h"
+#include "iteration_format.h"
+#include "opencl_include.h"
+#include "perturbation.h"
+#include "precision_tier.h"
+
+// Arguments of the tier's iteration kernel. All tiers share the buffer, size,
+// iteration and mode arguments; the view is passed as float, double, or
+// double-float (center, per-pixel step and Julia c split into hi/lo). Only the
+// float kernel takes the interior shortcut flags, a storage format and pixels
+// per work item; the other tiers always write int, one pixel per item.
+void setFractalKernelArgs(cl_kernel kernel, PrecisionTier tier, const RenderConfig& cfg, cl_mem iterationsBuf,
+                          IterationFormat format = IterationFormat::U32, int pixelsPerItem = 1);
+
+// Arguments of the deep-zoom delta kernel (kernels/perturbation.cl); the
+// orbit's length and reference offset go with the uploaded orbitBuf.
+void setPerturbationKernelArgs(cl_kernel kernel, const RenderConfig& cfg, const ReferenceOrbit& orbit,
+                               cl_mem orbitBuf, cl_mem iterationsBuf);
+
+// View arguments of mandelbrot_points / mandelbrot_samples (float tier); the
+// point count (arg 2) is set per batch.
+void setPointsKernelArgs(cl_kernel kernel, const RenderConfig& cfg, cl_mem pointsBuf, cl_mem iterationsBuf);
@@ -1,28 +1,123 @@
-// KernelManager - stub for loading and building OpenCL kernels.
+// KernelManager - loads and builds the fractal and color-mapping OpenCL kernels.
+// The iteration kernel comes in precision tiers: float, double-float (float2)
+// and, on devices reporting cl_khr_fp64, native double. Every program is
+// built with the shared constants (constants.h, IterationFormat codes) as -D
+// options; iteration kernels can also be built specialized (KernelVariant).
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
-#include <OpenCL/opencl.h>
+#include "opencl_include.h"
+
+#include "precision_tier.h"
+#include "program_cache.h"
+
+// Compile-time specialization of a tier's iteration kernel. The fractal mode
+// and iteration bound become constants (SPEC_JULIA, SPEC_MAX_ITERATIONS), so
+// the compiler drops the mode branches and folds the loop bound, and the
+// escape loop is unrolled unroll-fold (SPEC_UNROLL). Variants take the same
+// arguments as the generic kernel and produce the same counts; those fixed
+// here are ignored.
+struct KernelVariant {
+    PrecisionTier tier = PrecisionTier::Float;  // Not Perturbation.
+    int julia = -1;          // 0 = Mandelbrot, 1 = Julia, -1 = runtime argument.
+    int maxIterations = 0;   // 0 = runtime argument.
+    int unroll = 1;
+
+    // The -D options selecting this variant.
+    std::string buildOptions() const;
+    // E.g. "float julia, 1000 iterations, unroll 4".
+    std::string name() const;
+
+    bool operator<(const KernelVariant& other) const;
+};
 
 class KernelManager {
 public:
     KernelManager() = default;
     ~KernelManager();
 
-    // Load sources and build programs.
-    void initialize(const std::string& kernelsRoot, cl_context context, cl_device_id device);
+    // Load sources and build programs, reusing binaries from cacheDirectory
+    // when their key matches (empty = no binary cache).
+    void initialize(const std::string& kernelsRoot,
+                    cl_context context,
+                    cl_device_id device,
+                    const std::string& cacheDirectory = "");
 
     // Diagnostics about available kernel sources.
     void printDiagnostics() const;
 
     cl_kernel mandelbrotKernel() const { return mandelbrotKernel_; }
 
+    // Float-tier iteration over a list of (x, y) pixels (subdivision).
+    cl_kernel pointsKernel() const { return pointsKernel_; }
+
+    // Float-tier iteration over sub-pixel (x, y) positions (edge anti-aliasing).
+    cl_kernel samplesKernel() const { return samplesKernel_; }
+
+    // Iteration kernel of a tier (null if not built on this device). The
+    // non-float tiers take different argument types; see setFractalKernelArgs
+    // in renderer.cpp.
+    cl_kernel iterationKernel(PrecisionTier tier) const;
+
+    // Built iteration tiers, cheapest first: double-float before double on
+    // GPUs (fp64 usually runs at a fraction of the float rate there), double
+    // first on other devices.
+    const std::vector<PrecisionTier>& availableTiers() const { return tiers_; }
+
+    // Iteration buffer + palette LUT -> packed RGB8 (kernels/colorize.cl).
+    cl_kernel colorizeKernel() const { return colorizeKernel_; }
+
+    // Iteration buffer -> per-count histogram (histogram-equalized coloring).
+    cl_kernel histogramKernel() const { return histogramKernel_; }
+
+    // Deep-zoom delta kernel (kernels/perturbation.cl); null when the device
+    // lacks cl_khr_fp64, in which case deep zooms run on the host.
+    cl_kernel perturbationKernel() const { return perturbationKernel_; }
+
+    // Iteration kernel built as variant, on first request (from the binary
+    // cache when possible) and kept until the manager is destroyed. Null when
+    // the tier is not available or the variant fails to build; callers then
+    // use iterationKernel(variant.tier), which takes the same arguments.
+    cl_kernel variantKernel(const KernelVariant& variant);
+
+    // The -D options every program is built with.
+    static std::string constantOptions();
+
 private:
+    // Build <kernelsRoot>/<name>.cl for device, from the binary cache when
+    // possible; prints the build log on failure.
+    cl_program buildProgram(const std::string& name,
+                            cl_context context,
+                            cl_device_id device,
+                            const std::string& options = "");
+
     std::string kernelsRoot_{"kernels"};
+    cl_context context_{};
+    cl_device_id device_{};
+    ProgramCache cache_{""};
+    int cacheHits_ = 0;
+    int programsBuilt_ = 0;
     cl_program program_{};
     cl_kernel mandelbrotKernel_{};
+    cl_kernel pointsKernel_{};
+    cl_kernel samplesKernel_{};
+    cl_program doubleProgram_{};
+    cl_kernel doubleKernel_{};
+    cl_program doubleFloatProgram_{};
+    cl_kernel doubleFloatKernel_{};
+    std::vector<PrecisionTier> tiers_;
+    cl_program colorizeProgram_{};
+    cl_kernel colorizeKernel_{};
+    cl_kernel histogramKernel_{};
+    cl_program perturbationProgram_{};
+    cl_kernel perturbationKernel_{};
+    // Built variants (null kernel: failed, not retried).
+    std::map<KernelVariant, std::pair<cl_program, cl_kernel>> variants_;
 };
 
 
@@ -0,0 +1,41 @@
+// MarianiSilver - boundary-tracing subdivision that skips uniform regions.
+// The image is cut into tiles that share their edge rows/columns. Each round
+// iterates the still-unknown border pixels of every pending rectangle in one
+// batch; a rectangle whose border has a single iteration count is filled
+// with it, any other is split into four that share the middle lines. Rounds
+// repeat until no rectangle is pending, so the work per round is one flat
+// list of points that a device kernel or the CPU workers can take in bulk.
+//
+// Matches brute force for the Mandelbrot set and connected Julia sets
+// (escape-time level sets are connected there) except for specks of pixels
+// enclosed on every side by one count, which no border sample reaches; at
+// pixel resolution these are rare single pixels inside the set.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "config.h"
+
+class MarianiSilver {
+public:
+    struct Stats {
+        uint64_t pixelsIterated = 0;
+        uint64_t pixelsFilled = 0;
+        uint64_t rectsFilled = 0;
+        int rounds = 0;
+        int batches = 0;
+    };
+
+    // Iterate count pixels given as (x, y) pairs, writing results[0..count).
+    using EvaluateFn = std::function<void(const int* points, size_t count, int* results)>;
+
+    // Fill out (width*height ints) for cfg, calling evaluate with at most
+    // maxBatchPoints pixels at a time.
+    static Stats render(const RenderConfig& cfg,
+                        int* out,
+                        const EvaluateFn& evaluate,
+                        size_t maxBatchPoints);
+};
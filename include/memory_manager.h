@@ -1,27 +1,123 @@
 // MemoryManager - manages OpenCL buffers and host-side image data.
+// Buffers come from a BufferPool, so each initialize* call hands the previous
+// render's buffers back to the pool and compatible renders reuse them.
 
 #pragma once
 
 #include <vector>
 
-#include <OpenCL/opencl.h>
+#include "opencl_include.h"
 
+#include "buffer_pool.h"
 #include "config.h"
 #include "device_manager.h"
+#include "iteration_format.h"
 
 class MemoryManager {
 public:
     explicit MemoryManager(DeviceManager& deviceManager);
     ~MemoryManager();
 
-    void initialize(const RenderConfig& cfg);
+    // Allocate the device iteration buffer and the matching host frame in
+    // format (U32 frames live in hostIterationBuffer, narrower ones in
+    // hostIterationBytes).
+    void initialize(const RenderConfig& cfg, IterationFormat format = IterationFormat::U32);
+
+    // Like initialize(), but the device iteration buffer is allocated in
+    // host-accessible memory (CL_MEM_ALLOC_HOST_PTR) and no host frame is
+    // kept: mapFrame() exposes the buffer itself instead of a readback.
+    void initializeMapped(const RenderConfig& cfg, IterationFormat format = IterationFormat::U32);
+
+    // Map the iteration buffer of initializeMapped() for reading (blocking).
+    // hostFrame() then returns the mapped memory until the next initialize*
+    // call or the destructor unmaps it. evt, when given, receives the map
+    // command's event.
+    void mapFrame(cl_event* evt = nullptr);
+
+    // Allocate the full-frame host frame and a device buffer for one tile of
+    // tilePixels iterations, reused across every tile of the frame.
+    void initializeTiled(const RenderConfig& cfg, size_t tilePixels,
+                         IterationFormat format = IterationFormat::U32);
+
+    // Allocate slotCount device/host band buffers of bandPixels iterations each
+    // for the streaming pipeline. No full-frame host buffer is kept.
+    void initializeBands(const RenderConfig& cfg, size_t bandPixels, int slotCount);
+
+    // Allocate the device iteration buffer, a palette LUT buffer of lutBytes,
+    // a device RGB8 frame and its host copy (device color path), plus a
+    // histogram buffer of histogramBytes when non-zero. No host iteration
+    // buffer is kept.
+    void initializeDeviceColor(const RenderConfig& cfg, size_t lutBytes, size_t histogramBytes = 0);
+
+    // Allocate the full-frame device/host iteration buffers plus a read-only
+    // device buffer of orbitBytes for the deep-zoom reference orbit.
+    void initializePerturbation(const RenderConfig& cfg, size_t orbitBytes);
+
+    // Allocate the full-frame host buffer plus device buffers for batches of
+    // up to maxPoints scattered pixels: (x, y) pairs in pointBuffer and their
+    // counts in iterationBuffer (subdivision).
+    void initializePointBatches(const RenderConfig& cfg, size_t maxPoints);
+
+    // Device buffers for batches of up to maxSamples sub-pixel positions:
+    // float (x, y) pairs in sampleBuffer and their counts in
+    // sampleResultBuffer (edge anti-aliasing). The host frame is kept.
+    void initializeSampleBatches(size_t maxSamples);
+
+    // Allocate only the host iteration buffer (CPU backend, no OpenCL context).
+    void initializeHost(const RenderConfig& cfg);
 
     cl_mem iterationBuffer() const { return iterationBuffer_; }
     std::vector<int>& hostIterationBuffer() { return hostIterations_; }
+    std::vector<unsigned char>& hostIterationBytes() { return hostIterationBytes_; }
+
+    // The host frame the last initialize* call set up, in its format (the
+    // mapped device buffer after mapFrame()).
+    IterationFrame hostFrame() const;
+    void* hostFrameData();
+
+    cl_mem orbitBuffer() const { return orbitBuffer_; }
+    cl_mem pointBuffer() const { return pointBuffer_; }
+    cl_mem sampleBuffer() const { return sampleBuffer_; }
+    cl_mem sampleResultBuffer() const { return sampleResultBuffer_; }
+
+    cl_mem paletteLutBuffer() const { return paletteLutBuffer_; }
+    cl_mem histogramBuffer() const { return histogramBuffer_; }
+    cl_mem rgbBuffer() const { return rgbBuffer_; }
+    std::vector<unsigned char>& hostRgbBuffer() { return hostRgb_; }
+
+    int bandSlotCount() const { return static_cast<int>(bandBuffers_.size()); }
+    cl_mem bandBuffer(int slot) const { return bandBuffers_[static_cast<size_t>(slot)]; }
+    std::vector<int>& hostBandBuffer(int slot) { return hostBands_[static_cast<size_t>(slot)]; }
+
+    const BufferPool::Stats& poolStats() const { return pool_.stats(); }
+
+    // Print pool hit/miss counts and resident bytes.
+    void printPoolStats() const;
 
 private:
+    // Apply cfg.poolMemoryMB (or the auto budget) and return every buffer of
+    // the previous render to the pool.
+    void beginRender(const RenderConfig& cfg);
+    void releaseBuffers();
+    void unmapFrame();
+    void initializeHostFrame(const RenderConfig& cfg, IterationFormat format);
+
     DeviceManager& deviceManager_;
+    BufferPool pool_;
     cl_mem iterationBuffer_{};
     std::vector<int> hostIterations_;
+    std::vector<unsigned char> hostIterationBytes_;
+    IterationFormat hostFormat_ = IterationFormat::U32;
+    void* mappedFrame_ = nullptr;
+    size_t mappedPixels_ = 0;
+    cl_mem orbitBuffer_{};
+    cl_mem pointBuffer_{};
+    cl_mem sampleBuffer_{};
+    cl_mem sampleResultBuffer_{};
+    cl_mem paletteLutBuffer_{};
+    cl_mem histogramBuffer_{};
+    cl_mem rgbBuffer_{};
+    std::vector<unsigned char> hostRgb_;
+    std::vector<cl_mem> bandBuffers_;
+    std::vector<std::vector<int>> hostBands_;
 };
-
@@ -0,0 +1,13 @@
+// Portable OpenCL include - macOS ships the framework header, other platforms
+// use the Khronos layout (ICD loader).
+
+#pragma once
+
+#if defined(__APPLE__)
+#include <OpenCL/opencl.h>
+#else
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 120
+#endif
+#include <CL/cl.h>
+#endif
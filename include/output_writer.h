@@ -1,32 +1,96 @@
 // OutputWriter - simple image writer for iteration data.
-// Supports PPM directly and PNG via stb_image_write (cross-platform).
+// Supports PPM directly and PNG via the parallel PngEncoder.
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "config.h"
+#include "iteration_format.h"
+#include "palette.h"
+#include "png_encoder.h"
 
 class OutputWriter {
 public:
     // Choose format based on file extension:
     //  - ".ppm": write PPM directly
-    //  - ".png": write PNG using stb_image_write (cross-platform)
+    //  - ".png": write PNG with PngEncoder (cfg.pngLevel, cfg.pngFilter,
+    //    cfg.threads workers)
     void writeImage(const RenderConfig& cfg,
                     const std::vector<int>& iterations,
                     const std::string& path) const;
 
+    // Same for a frame in any IterationFormat.
+    void writeImage(const RenderConfig& cfg,
+                    const IterationFrame& frame,
+                    const std::string& path) const;
+
     // Write a PPM image based on iteration counts.
     void writePPM(const RenderConfig& cfg,
                   const std::vector<int>& iterations,
                   const std::string& path) const;
 
+    // Write an already colored RGB8 frame (width * height * 3 bytes, e.g. the
+    // device color kernel's output). Format chosen by extension as above.
+    void writeRGBImage(const RenderConfig& cfg,
+                       const std::vector<unsigned char>& rgb,
+                       const std::string& path) const;
+
+    // Encode an RGB8 frame in memory instead of writing a file; the format is
+    // chosen from path's extension as above (path itself is not touched).
+    std::vector<unsigned char> encodeRGBImage(const RenderConfig& cfg,
+                                              const std::vector<unsigned char>& rgb,
+                                              const std::string& path) const;
+
+    // PNG encoder settings for cfg. Filter "auto" is adaptive, except at
+    // level 0 (store only), where filtering cannot pay off and rows are
+    // stored unfiltered.
+    static PngOptions pngOptions(const RenderConfig& cfg);
+
+    // Palette lookup table for cfg.palette (or cfg.paletteFile), compiled once
+    // per render. Also uploaded for the device color kernel.
+    PaletteLut paletteLut(const RenderConfig& cfg) const;
+
+    // LUT for coloring frame: paletteLut(cfg), or with cfg.coloring ==
+    // "histogram" the palette placed at the frame's equalized positions
+    // (ColorHistogram, built on threadCount workers; sorted counts instead
+    // of a histogram when maxIterations exceeds the pixel count).
+    PaletteLut paletteLut(const RenderConfig& cfg, const IterationFrame& frame, int threadCount = 0) const;
+
+    // Equalized LUT from an iteration histogram whose last bin counts in-set
+    // pixels (ColorHistogram::build, or maxIterations + 1 bins from the device).
+    PaletteLut equalizedLut(const RenderConfig& cfg, const std::vector<uint32_t>& histogram,
+                            int threadCount = 0) const;
+
+    // Map pixelCount iteration counts to packed RGB8 (3 bytes per pixel)
+    // through lut, split across threadCount workers (0 = all cores) with an
+    // AVX2 gather/pack inner loop when available. Also used by the streaming
+    // pipeline to color one band at a time.
+    void colorize(const PaletteLut& lut,
+                  const int* iterations,
+                  size_t pixelCount,
+                  unsigned char* rgb,
+                  int threadCount = 0) const;
+
+    // Same for a frame in any IterationFormat. U8/U16 counts are widened in
+    // the same gather loop; Packed frames blend each count's entry with the
+    // next one by the smooth fraction (scalar loop).
+    void colorize(const PaletteLut& lut,
+                  const IterationFrame& frame,
+                  unsigned char* rgb,
+                  int threadCount = 0) const;
+
 private:
-    // Write a PNG image using stb_image_write.
-    void writePNG(const RenderConfig& cfg,
-                  const std::vector<int>& iterations,
-                  const std::string& path) const;
+
+    // Encode an RGB8 frame (header + a single write for PPM, PngEncoder for PNG).
+    void writeRGBPPM(const RenderConfig& cfg,
+                     const std::vector<unsigned char>& rgb,
+                     const std::string& path) const;
+    void writeRGBPNG(const RenderConfig& cfg,
+                     const std::vector<unsigned char>& rgb,
+                     const std::string& path) const;
 };
 
 
@@ -0,0 +1,129 @@
+// Palette - named color gradients compiled into per-render lookup tables.
+// Coloring a pixel becomes a clamped table gather instead of a per-pixel
+// palette-name dispatch and float divide.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+class Palette;
+
+// RGB8 lookup table for one render: entry i is the color of iteration count i,
+// entry maxIterations is the in-set color. Above Color::MAX_LUT_ENTRIES the
+// LUT is direct instead: no tables, each count is colored through the
+// palette when asked, so memory does not grow with maxIterations.
+struct PaletteLut {
+    int maxIterations = 1;
+    std::vector<unsigned char> rgb;  // (maxIterations + 1) * 3 bytes.
+    std::vector<uint32_t> packed;    // Same entries as r | g << 8 | b << 16 (SIMD gathers).
+
+    // Direct mode only: the palette and the position of escape count i.
+    std::shared_ptr<const Palette> palette;
+    std::function<float(int)> position;
+
+    // Whether a LUT for maxIterations is a table (false = direct).
+    static bool tabulates(int maxIterations);
+
+    bool direct() const { return palette != nullptr; }
+
+    // Color for an iteration count, clamped into the table (tables only).
+    const unsigned char* entry(int iter) const {
+        const int idx = iter < 0 ? 0 : (iter > maxIterations ? maxIterations : iter);
+        return rgb.data() + static_cast<size_t>(idx) * 3;
+    }
+
+    // Color for an iteration count in either mode, written to out[0..2].
+    void color(int iter, unsigned char* out) const;
+};
+
+class Palette {
+public:
+    // Maps t in [0, 1) (iter / maxIter) to a color.
+    using ColorFn = std::function<void(float t, unsigned char& r, unsigned char& g, unsigned char& b)>;
+
+    // Gradient stop: color at position in [0, 1].
+    struct Stop {
+        float position;
+        unsigned char r;
+        unsigned char g;
+        unsigned char b;
+    };
+
+    Palette(std::string name, ColorFn fn);
+    Palette(std::string name, std::vector<Stop> stops);
+
+    const std::string& name() const { return name_; }
+
+    void setInsideColor(unsigned char r, unsigned char g, unsigned char b);
+
+    // Color at palette position t in [0, 1], and the in-set color.
+    void color(float t, unsigned char* out) const { fn_(t, out[0], out[1], out[2]); }
+    const unsigned char* insideColor() const { return inside_; }
+
+    // Evaluate the palette once per iteration count (maxIterations clamped to
+    // >= 1), or a direct LUT when the table would exceed Color::MAX_LUT_ENTRIES.
+    PaletteLut buildLut(int maxIterations) const;
+
+    // Same, but count i is colored at positions[i] instead of i / maxIterations
+    // (histogram equalization). Counts past the end of positions are colored
+    // at 1, so a histogram only needs to cover the frame's highest count.
+    PaletteLut buildLut(int maxIterations, std::vector<float> positions) const;
+
+    // Same, with count i colored at position(i) for 0 <= i < maxIterations
+    // (called per entry for a table, per pixel when direct).
+    PaletteLut buildLut(int maxIterations, std::function<float(int)> position) const;
+
+private:
+    std::string name_;
+    ColorFn fn_;
+    unsigned char inside_[3] = {0, 0, 0};  // In-set color (black).
+};
+
+// Registry of the built-in palettes (default, sunset, neon). Gradient files
+// are loaded per render and never registered, so one render's file cannot
+// replace a built-in or another render's palette.
+class PaletteRegistry {
+public:
+    static PaletteRegistry& instance();
+
+    // Look up a palette by name; throws std::runtime_error if unknown.
+    Palette get(const std::string& name) const;
+
+    bool contains(const std::string& name) const;
+
+    // Register (or replace) a palette.
+    void add(const Palette& palette);
+
+    // Build the palette described by a gradient file (not registered).
+    // Format (one entry per line, '#' starts a comment):
+    //   name <palette-name>            optional, defaults to the file stem
+    //   inside <r> <g> <b>             optional in-set color, defaults to black
+    //   <position> <r> <g> <b>         stop, position in [0, 1], channels 0-255
+    // Throws std::runtime_error on I/O or parse errors, naming file and line.
+    static Palette loadGradientFile(const std::string& path);
+
+    std::vector<std::string> names() const;
+
+    // LUT for cfg.palette at cfg.maxIterations (cfg.paletteFile's gradient instead when set).
+    PaletteLut lutFor(const RenderConfig& cfg);
+
+    // Same with explicit per-count palette positions (see Palette::buildLut).
+    PaletteLut lutFor(const RenderConfig& cfg, std::vector<float> positions);
+    PaletteLut lutFor(const RenderConfig& cfg, std::function<float(int)> position);
+
+private:
+    PaletteRegistry();
+
+    Palette paletteFor(const RenderConfig& cfg);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Palette> palettes_;
+};
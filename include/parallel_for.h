@@ -0,0 +1,93 @@
+// Minimal host-side parallel loop helpers used by CPU-side render stages.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Resolve a requested worker count (0 = one per hardware thread).
+inline int resolveThreadCount(int requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+// Run fn(begin, end) over [0, count) in chunks of `grain`, handed out
+// dynamically so expensive rows (e.g. in-set regions) do not stall a worker.
+// Runs inline when only one worker is requested.
+template <typename Fn>
+void parallelForDynamic(int count, int grain, int threadCount, Fn&& fn) {
+    if (count <= 0) {
+        return;
+    }
+    grain = std::max(1, grain);
+    const int chunks = (count + grain - 1) / grain;
+    const int workers = std::min(resolveThreadCount(threadCount), chunks);
+
+    std::atomic<int> next{0};
+    auto work = [&]() {
+        for (;;) {
+            const int chunk = next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunks) {
+                return;
+            }
+            const int begin = chunk * grain;
+            fn(begin, std::min(count, begin + grain));
+        }
+    };
+
+    if (workers <= 1) {
+        work();
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(static_cast<size_t>(workers - 1));
+    for (int i = 1; i < workers; ++i) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+// In-place inclusive prefix sum in three passes: each worker sums one
+// contiguous block, the block totals are scanned serially (one per worker),
+// then each worker rescans its block from its offset.
+template <typename T>
+void parallelInclusiveScan(std::vector<T>& values, int threadCount) {
+    const int count = static_cast<int>(values.size());
+    const int blocks = std::max(1, std::min(resolveThreadCount(threadCount), count));
+    const int blockSize = (count + blocks - 1) / std::max(1, blocks);
+    std::vector<T> offsets(static_cast<size_t>(blocks), T{});
+
+    parallelForDynamic(blocks, 1, threadCount, [&](int begin, int end) {
+        for (int b = begin; b < end; ++b) {
+            T sum{};
+            for (int i = b * blockSize; i < std::min(count, (b + 1) * blockSize); ++i) {
+                sum += values[static_cast<size_t>(i)];
+            }
+            offsets[static_cast<size_t>(b)] = sum;
+        }
+    });
+    T running{};
+    for (T& offset : offsets) {
+        const T blockSum = offset;
+        offset = running;
+        running += blockSum;
+    }
+    parallelForDynamic(blocks, 1, threadCount, [&](int begin, int end) {
+        for (int b = begin; b < end; ++b) {
+            T sum = offsets[static_cast<size_t>(b)];
+            for (int i = b * blockSize; i < std::min(count, (b + 1) * blockSize); ++i) {
+                sum += values[static_cast<size_t>(i)];
+                values[static_cast<size_t>(i)] = sum;
+            }
+        }
+    });
+}
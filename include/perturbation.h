@@ -0,0 +1,51 @@
+// Perturbation - deep-zoom iteration past the reach of float/double.
+// One reference orbit Z_n is computed on the host in arbitrary precision
+// (FixedPoint) at the view center; every pixel then iterates only its small
+// offset delta_n = z_n - Z_n in double:
+//   delta_{n+1} = (2 Z_n + delta_n) delta_n + dc
+// When |Z_m + delta| < |delta| (the reference no longer tracks the pixel, the
+// classic glitch) or the reference orbit runs out, the pixel is rebased onto
+// the start of the orbit: delta = z - Z_0, m = 0. kernels/perturbation.cl runs
+// the same loop on the device.
+//
+// A reference that escapes long before maxIterations makes every pixel that
+// outlives it rebase over and over. chooseReference then tries the
+// longest-lived pixel of a coarse probe render as the reference, so pixels
+// iterate relative to an orbit that lasts about as long as they do.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "config.h"
+
+struct ReferenceOrbit {
+    std::vector<double> points;  // Interleaved re, im of Z_0 .. Z_{length-1}.
+    int length = 0;
+    int precisionBits = 0;  // Fraction bits used for the high-precision orbit.
+    double offsetX = 0.0;  // Reference point minus the view center.
+    double offsetY = 0.0;
+};
+
+class Perturbation {
+public:
+    // Reference orbit at the view center (cfg.centerXText/centerYText when set,
+    // so centers finer than a double survive) plus (offsetX, offsetY), until
+    // escape or maxIterations.
+    static ReferenceOrbit referenceOrbit(const RenderConfig& cfg, double offsetX = 0.0, double offsetY = 0.0);
+
+    // Center orbit, or when it escapes before maxIterations, the orbit of the
+    // longest-lived pixel of a DeepZoom::PROBE_WIDTH-wide probe render if that
+    // lasts longer and rebases the probe less; repeated up to
+    // DeepZoom::REFERENCE_RETRIES times while it keeps improving.
+    static ReferenceOrbit chooseReference(const RenderConfig& cfg, int threadCount = 0);
+
+    // Iterate every pixel's delta against orbit on threadCount workers
+    // (0 = all cores) into out (width*height ints). Returns the number of
+    // glitch rebases.
+    static uint64_t computeIterations(const RenderConfig& cfg,
+                                      const ReferenceOrbit& orbit,
+                                      int threadCount,
+                                      int* out);
+};
@@ -0,0 +1,60 @@
+// PngEncoder - parallel PNG encoder for whole RGB8 frames.
+// Rows are filtered concurrently, then cut into chunks that are deflated
+// concurrently. Each chunk is a raw deflate segment primed with the previous
+// chunk's last 32 KiB (deflateSetDictionary) and ended on a byte boundary
+// (Z_SYNC_FLUSH), so the segments concatenate into one zlib stream whose
+// Adler-32 is combined from the per-chunk checksums (adler32_combine).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+
+// PNG row filter. Adaptive picks the cheapest of the five for every row
+// (minimum sum of absolute differences, as libpng and stb do).
+enum class PngFilter { None = 0, Sub = 1, Up = 2, Average = 3, Paeth = 4, Adaptive };
+
+struct PngOptions {
+    int level = FractalConstants::Png::DEFAULT_LEVEL;  // 0 = store only, 1 = fastest .. 9 = smallest.
+    PngFilter filter = PngFilter::Adaptive;
+    int threads = 0;  // 0 = one per hardware thread.
+};
+
+class PngEncoder {
+public:
+    // Complete PNG file image of width x height packed RGB8 pixels.
+    static std::vector<unsigned char> encode(const unsigned char* rgb, int width, int height,
+                                             const PngOptions& options);
+
+    // encode() to path. Throws std::runtime_error on failure.
+    static void write(const std::string& path, const unsigned char* rgb, int width, int height,
+                      const PngOptions& options);
+
+    // Filter one row of rowBytes bytes against prev (nullptr for the first
+    // row) into out: the filter type byte, then rowBytes filtered bytes.
+    // Adaptive also needs scratch of 1 + rowBytes bytes.
+    static void filterRow(PngFilter filter, const unsigned char* row, const unsigned char* prev, size_t rowBytes,
+                          unsigned char* out, unsigned char* scratch);
+
+    // PNG signature and IHDR chunk of a width x height RGB8 image, appended to
+    // png. Shared with the streaming writer (image_stream.cpp).
+    static void appendHeader(std::vector<unsigned char>& png, int width, int height);
+
+    // Append one chunk (length, type, data, CRC) to png. crc must already
+    // cover type and data; the overload without it computes it.
+    static void appendChunk(std::vector<unsigned char>& png, const char type[4], const unsigned char* data,
+                            size_t len, unsigned long crc);
+    static void appendChunk(std::vector<unsigned char>& png, const char type[4], const unsigned char* data,
+                            size_t len);
+
+    static void putBigEndian(unsigned char* p, uint32_t v);
+
+    // "none", "sub", "up", "average", "paeth" or "adaptive"; throws
+    // std::runtime_error on anything else.
+    static PngFilter filterFromName(const std::string& name);
+    static const char* filterName(PngFilter filter);
+};
@@ -0,0 +1,35 @@
+// PrecisionTier - arithmetic used for the escape-time iteration, and the
+// rule that picks the cheapest one able to resolve a view.
+// A view needs about log2(|orbit| / pixel spacing) + 2 mantissa bits (pixels
+// at least Precision::MIN_ULPS_PER_PIXEL ulps apart); each tier covers up to
+// its mantissa width, and Perturbation covers any depth.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+enum class PrecisionTier {
+    Float,        // 24-bit mantissa: kernels/mandelbrot.cl, CPU SIMD backend.
+    DoubleFloat,  // float2 hi+lo pair, ~44 bits: kernels/mandelbrot_df.cl.
+    Double,       // Native fp64, 53 bits: kernels/mandelbrot_double.cl.
+    Perturbation  // Reference orbit + double deltas (see perturbation.h).
+};
+
+// "float", "double-float", "double" or "perturbation" (the --precision names).
+std::string precisionTierName(PrecisionTier tier);
+
+// Inverse of precisionTierName; throws std::runtime_error on unknown names.
+PrecisionTier precisionTierFromName(const std::string& name);
+
+// Mantissa bits the tier resolves (Perturbation: unbounded).
+int precisionTierBits(PrecisionTier tier);
+
+// Mantissa bits needed to keep neighbouring pixels of cfg's view distinct.
+int requiredPrecisionBits(const RenderConfig& cfg);
+
+// cfg.precision when it names a tier, otherwise the first of candidates
+// (cheapest first) with enough bits, or Perturbation when none has.
+PrecisionTier choosePrecisionTier(const RenderConfig& cfg, const std::vector<PrecisionTier>& candidates);
@@ -0,0 +1,39 @@
+// ProgramCache - on-disk cache of built OpenCL program binaries.
+// Entries are keyed by device name, driver version, build options and a hash
+// of the kernel source, so any change to one of them forces a source rebuild.
+
+#pragma once
+
+#include <string>
+
+#include "opencl_include.h"
+
+class ProgramCache {
+public:
+    // An empty directory disables the cache.
+    explicit ProgramCache(std::string directory);
+
+    bool enabled() const { return !directory_.empty(); }
+
+    // Identity of one program build on one device.
+    static std::string makeKey(cl_device_id device,
+                               const std::string& source,
+                               const std::string& options);
+
+    // Create and build a program from a cached binary; returns nullptr when
+    // the cache is disabled, the key has no entry or the binary is rejected.
+    cl_program load(const std::string& name,
+                    const std::string& key,
+                    cl_context context,
+                    cl_device_id device,
+                    const std::string& options) const;
+
+    // Store the binary of a built single-device program. Failures are
+    // reported and otherwise ignored (the cache is an optimization).
+    void store(const std::string& name, const std::string& key, cl_program program) const;
+
+private:
+    std::string entryPath(const std::string& name, const std::string& key) const;
+
+    std::string directory_;
+};
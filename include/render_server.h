@@ -0,0 +1,74 @@
+// RenderServer - long-running render daemon that keeps the device context,
+// built kernels and pooled buffers warm between requests.
+//
+// Protocol: one JSON object per line (RenderConfig field names, see
+// json_config.h) plus optional "id" (echoed back) and "response": "path"
+// (default, image written to outputPath) or "bytes" (image returned base64
+// encoded). One JSON response line per request; with several jobs in flight
+// responses may arrive out of order, so clients should match on "id".
+//
+// Trust model: anyone who can write to stdin or connect to the socket can
+// render as the daemon's user, so access control is the socket file's
+// permissions. Within that, requests cannot leave the working directory
+// (outputPath and paletteFile must be relative without "..") and are capped
+// at RenderConfig::serverMaxMegapixels and serverMaxIterations; threads is
+// clamped to the core count.
+
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "device_manager.h"
+#include "kernel_manager.h"
+#include "memory_manager.h"
+#include "renderer.h"
+#include "worker_pool.h"
+
+class RenderServer {
+public:
+    // defaults supplies every field a request leaves out (and the backend).
+    // Each concurrent job gets its own kernels and buffers on the shared device.
+    RenderServer(DeviceManager& deviceManager, const RenderConfig& defaults);
+
+    // Serve requests read from in, writing responses to out, until EOF.
+    void serve(std::istream& in, std::ostream& out);
+
+    // Listen on a Unix domain socket at path until SIGINT/SIGTERM. Each
+    // connection speaks the same line protocol. Throws std::runtime_error if
+    // the socket cannot be created (or on platforms without Unix sockets).
+    void serveSocket(const std::string& path);
+
+private:
+    struct JobContext {
+        explicit JobContext(DeviceManager& deviceManager);
+
+        KernelManager kernels;
+        MemoryManager memory;
+        Renderer renderer;
+    };
+
+    using Responder = std::function<void(const std::string&)>;
+
+    // Queue one request line; respond is called (from a worker thread) with
+    // the response line.
+    void submit(const std::string& line, Responder respond);
+
+    // Parse, render and format the response for one request.
+    std::string handle(const std::string& line);
+
+    JobContext* checkout();
+    void checkin(JobContext* context);
+
+    DeviceManager& deviceManager_;
+    RenderConfig defaults_;
+    std::vector<std::unique_ptr<JobContext>> contexts_;
+    std::vector<JobContext*> idleContexts_;
+    std::mutex contextMutex_;
+    std::unique_ptr<WorkerPool> workers_;
+};
@@ -2,13 +2,24 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "config.h"
 #include "device_manager.h"
+#include "device_set.h"
 #include "kernel_manager.h"
 #include "memory_manager.h"
 #include "fractal_strategy.h"
+#include "iteration_format.h"
+#include "palette.h"
+#include "precision_tier.h"
+
+// cfg.outputPath with bare file names placed under images/ (paths that contain
+// a directory separator are used as given).
+std::string resolveOutputPath(const RenderConfig& cfg);
 
 class Renderer {
 public:
@@ -19,14 +30,141 @@ public:
     // Set the active fractal strategy.
     void setStrategy(std::unique_ptr<FractalStrategy> strategy);
 
-    // Perform a render using the active strategy and Mandelbrot kernel.
+    // Devices used when cfg.multiDevice is set (null = primary device only).
+    void setDeviceSet(DeviceSet* devices);
+
+    // Perform a render using the active strategy on the backend selected by
+    // cfg.backend ("cpu" -> native SIMD threads, otherwise the OpenCL kernel).
     void render(const RenderConfig& cfg);
 
+    // Render like render() but return the encoded image (format from the
+    // outputPath extension) instead of writing it. Streaming is disabled.
+    std::vector<unsigned char> renderEncoded(const RenderConfig& cfg);
+
+    // Load the iteration field cfg.recolorFile (IterationField) and write it
+    // like a rendered frame, with the palette, coloring and output options
+    // of cfg and the view stored in the file. Uses no OpenCL objects.
+    void recolor(const RenderConfig& cfg);
+
+    // Render an animation (one config per frame, same size/iterations/palette)
+    // with a single context. Frames are double-buffered on the device: frame
+    // N+1 computes while frame N is read back, colored and handed to a host
+    // encoder pool. Reports aggregate frames per second.
+    void renderSequence(const std::vector<RenderConfig>& frames);
+
+    // Time each available precision tier (and perturbation) on cfg's view,
+    // best of Precision::BENCH_REPEATS runs, and print Mpixel/s per tier. No
+    // image is written.
+    void benchmarkTiers(const RenderConfig& cfg);
+
+    // Time the float iteration with each interior shortcut (none, bulb,
+    // periodicity, all) at every Interior::BENCH_ITERATIONS count on cfg's
+    // view, and count pixels that differ from the plain loop. No image is
+    // written.
+    void benchmarkInterior(const RenderConfig& cfg);
+
+    // Time each available tier's generic iteration kernel against variants
+    // specialized for cfg's view: fractal mode only, mode + iteration bound,
+    // and those with each Specialize::BENCH_UNROLLS factor. Prints build and
+    // kernel time (best of Specialize::BENCH_REPEATS), the speedup over the
+    // generic kernel and pixels that differ from it. No image is written.
+    void benchmarkVariants(const RenderConfig& cfg);
+
+    // Time every legal work-group shape (and, for the float kernel, pixels
+    // per work item) of each available iteration kernel on an
+    // Autotune::FRAME_WIDTH x FRAME_HEIGHT frame of cfg's view, print the
+    // fastest and store the best per device and kernel in cfg.tuningFile.
+    // No image is written.
+    void autotune(const RenderConfig& cfg);
+
 private:
+    // Fill the host iteration buffer with the OpenCL kernel.
+    void renderOpenCL(const RenderConfig& cfg);
+
+    // Fill the host iteration buffer on every DeviceSet member: one host
+    // thread per device pulls row chunks from a shared counter, then
+    // per-device throughput is printed.
+    void renderMultiDevice(const RenderConfig& cfg);
+
+    // Fill the host iteration buffer tile by tile through one reusable device
+    // buffer of at most budgetBytes (frames larger than a single allocation).
+    void renderTiled(const RenderConfig& cfg, size_t budgetBytes);
+
+    // Full-frame render colored on the device: the color kernel maps the
+    // iteration buffer through a palette LUT and only RGB8 is read back.
+    void renderDeviceColor(const RenderConfig& cfg);
+    // Clear the histogram buffer, count iterationsBuf into it on the device
+    // and read it back (maxIterations + 1 bins); evt times the kernel.
+    std::vector<uint32_t> runHistogramKernel(const RenderConfig& cfg,
+                                             cl_kernel kernel,
+                                             cl_mem iterationsBuf,
+                                             size_t pixelCount,
+                                             cl_event* evt);
+
+    // Iteration tier for cfg: cfg.precision, or under "auto" the cheapest
+    // built tier (float only on the CPU backend) that resolves the view,
+    // falling back to perturbation. Throws if an explicit tier is unavailable
+    // on the device; on the CPU backend an explicit double or double-float
+    // runs as perturbation, which iterates deltas in double.
+    PrecisionTier selectTier(const RenderConfig& cfg) const;
+
+    // The tier's iteration kernel for cfg: with cfg.specialize the variant
+    // compiled for its fractal mode and iteration bound (unrolled
+    // Specialize::DEFAULT_UNROLL-fold), else or if that does not build the
+    // generic kernel. The static form picks from another device's kernels
+    // (multi-device members).
+    cl_kernel iterationKernelFor(const RenderConfig& cfg, PrecisionTier tier);
+    static cl_kernel iterationKernelFor(KernelManager& kernels, const RenderConfig& cfg, PrecisionTier tier);
+
+    // Whether the full iteration frame fits one device allocation (device
+    // color path needs it resident) and the palette LUT is a table the
+    // color kernel can gather from.
+    bool deviceColorFits(const RenderConfig& cfg) const;
+
+    // cfg with the autotuned work-group size and pixels per work item for
+    // tier on this device filled in where cfg leaves them unset (OpenCL
+    // single-device renders with a tuning file only). A tuned size that does
+    // not divide the frame is dropped with a note.
+    RenderConfig applyTuning(const RenderConfig& cfg, PrecisionTier tier) const;
+
+    // Pipelined band render: band N+1 computes while band N is read back on the
+    // transfer queue and band N-1 is colored and streamed to the encoder.
+    void renderStreaming(const RenderConfig& cfg);
+
+    // Device bytes a single tile may use: CL_DEVICE_MAX_MEM_ALLOC_SIZE, capped
+    // by cfg.tileMemoryMB.
+    size_t tileBudgetBytes(const RenderConfig& cfg) const;
+
+    // Whether a full-frame render maps the iteration buffer instead of
+    // copying it back (cfg.readback, "auto" following host-unified memory).
+    bool mappedReadback(const RenderConfig& cfg) const;
+
+    // Deep zoom: compute the high-precision reference orbit, then fill the
+    // host iteration buffer with the perturbation kernel (or on the host when
+    // the device has no fp64 or the frame exceeds one allocation).
+    void renderPerturbation(const RenderConfig& cfg);
+
+    // Mariani-Silver: iterate tile borders in batches (points kernel, or the
+    // CPU workers on the cpu backend) and flood-fill uniform tiles.
+    void renderSubdivided(const RenderConfig& cfg);
+
+    // Fill the host iteration buffer with the native CPU backend.
+    void renderCpu(const RenderConfig& cfg);
+
+    // Color and write the host frame (any IterationFormat) to cfg.outputPath.
+    void writeOutput(const RenderConfig& cfg, const IterationFrame& frame);
+
+    // Edge anti-aliasing of rgb (counts colored with lut): iterate subsamples
+    // of the edge pixels with the samples kernel, or the CPU workers on the
+    // cpu backend, and blend them in.
+    void antialiasEdges(const RenderConfig& cfg, const int* counts, const PaletteLut& lut, unsigned char* rgb);
+
     DeviceManager& deviceManager_;
     KernelManager& kernelManager_;
     MemoryManager& memoryManager_;
     std::unique_ptr<FractalStrategy> strategy_;
+    DeviceSet* deviceSet_ = nullptr;
+    std::vector<unsigned char>* encoded_ = nullptr;  // Set during renderEncoded().
 };
 
 
@@ -0,0 +1,64 @@
+// Trace - optional pipeline tracing, exported as Chrome trace-event JSON
+// (chrome://tracing or ui.perfetto.dev).
+// Host stages are recorded by scoped timers; OpenCL commands by their
+// profiling timestamps (QUEUED, SUBMIT, START, END), read back when the trace
+// is written. Until start() is called every hook is a relaxed atomic load.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "opencl_include.h"
+
+class Trace {
+public:
+    // Begin recording; the trace is written to path by finish().
+    static void start(const std::string& path);
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Stop recording, wait for the recorded OpenCL commands, resolve their
+    // timestamps and write the JSON file. No-op when tracing is off.
+    static void finish();
+
+    // Times its own lifetime as a slice on the calling thread's track. name
+    // and category must outlive the trace (string literals).
+    class Scope {
+    public:
+        explicit Scope(const char* name, const char* category = "host");
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name_;
+        const char* category_;
+        int64_t startNs_ = -1;
+    };
+
+    // Wraps the event argument of one clEnqueue* call:
+    //   clEnqueueReadBuffer(..., 0, nullptr, Trace::Command("Readback", &evt).event());
+    // event() is the caller's pointer (possibly nullptr) while tracing is off.
+    // When on, a null request is replaced by an event the trace owns, and the
+    // event is retained and recorded when the Command goes out of scope.
+    class Command {
+    public:
+        explicit Command(const char* name, cl_event* requested = nullptr);
+        ~Command();
+        Command(const Command&) = delete;
+        Command& operator=(const Command&) = delete;
+
+        cl_event* event() { return slot_; }
+
+    private:
+        const char* name_;
+        cl_event* slot_;
+        cl_event owned_ = nullptr;
+        int64_t enqueueNs_ = -1;
+    };
+
+private:
+    static std::atomic<bool> enabled_;
+};
@@ -0,0 +1,64 @@
+// WorkGroupTuning - autotuned work-group sizes per device and iteration kernel.
+// --autotune sweeps the legal candidates and stores the fastest in a small
+// text file; later renders on the same device read it back when no local size
+// is given on the command line.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "opencl_include.h"
+
+class WorkGroupTuning {
+public:
+    // One launch shape. localX == 0 leaves the work-group size to OpenCL.
+    struct Entry {
+        int localX = 0;
+        int localY = 0;
+        int pixelsPerItem = 1;
+        double ms = 0.0;  // Best sweep time (informational).
+    };
+
+    // What the device and kernel accept.
+    struct Limits {
+        size_t maxWorkGroupSize = 0;   // min(CL_DEVICE_MAX_WORK_GROUP_SIZE, CL_KERNEL_WORK_GROUP_SIZE)
+        size_t preferredMultiple = 1;  // CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE
+        size_t maxItemsX = 0;          // CL_DEVICE_MAX_WORK_ITEM_SIZES[0]
+        size_t maxItemsY = 0;          // CL_DEVICE_MAX_WORK_ITEM_SIZES[1]
+    };
+
+    // An empty path disables loading and saving.
+    explicit WorkGroupTuning(std::string path);
+
+    bool enabled() const { return !path_.empty(); }
+    const std::string& path() const { return path_; }
+
+    // Read the results file; a missing file leaves the table empty and
+    // malformed lines are skipped.
+    void load();
+
+    // Write the table, via a temporary file renamed into place. Failures are
+    // reported and otherwise ignored.
+    void save() const;
+
+    // Stored entry for (device, kernel), or nullptr.
+    const Entry* find(const std::string& device, const std::string& kernel) const;
+    void set(const std::string& device, const std::string& kernel, const Entry& entry);
+
+    // Identity of a device for the table: name, vendor and driver version, so
+    // a driver update invalidates its results.
+    static std::string deviceKey(cl_device_id device);
+
+    // Work-group shapes legal for limits that tile a width x height launch:
+    // power-of-two sizes whose total is within maxWorkGroupSize and a multiple
+    // of preferredMultiple (when the device's maximum allows one), each width
+    // dividing width / pixelsPerItem. With allowPixelsPerItem every shape is
+    // repeated for Autotune::PIXELS_PER_ITEM; otherwise pixelsPerItem is 1.
+    static std::vector<Entry> candidates(const Limits& limits, int width, int height, bool allowPixelsPerItem);
+
+private:
+    std::string path_;
+    std::map<std::string, Entry> entries_;  // Keyed by device + '\t' + kernel.
+};
@@ -0,0 +1,51 @@
+// WorkerPool - fixed set of host threads draining a bounded job queue.
+// Used for background work that must not stall the render loop (e.g.
+// encoding finished frames while the device computes the next one).
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool {
+public:
+    // workerCount 0 = one per hardware thread; submit() blocks while
+    // maxPending jobs are queued (0 = two per worker).
+    explicit WorkerPool(int workerCount = 0, size_t maxPending = 0);
+
+    // Drains the queue and joins the workers (errors are dropped; call wait()
+    // first to observe them).
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // Block until every submitted job has finished; rethrows the first
+    // exception a job raised.
+    void wait();
+
+    int workerCount() const { return static_cast<int>(threads_.size()); }
+
+private:
+    void run();
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> jobs_;
+    size_t maxPending_;
+    size_t active_ = 0;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+
+    std::mutex mutex_;
+    std::condition_variable jobReady_;
+    std::condition_variable spaceFree_;
+    std::condition_variable idle_;
+};
@@ -0,0 +1,62 @@
+// Color-mapping kernels.
+// colorize_rgb maps iteration counts to packed RGB8 through a palette lookup
+// table with maxIterations + 1 RGB entries (entry maxIterations = inside the
+// set), so the readback is the final image at 3 bytes per pixel.
+// iteration_histogram counts pixels per iteration count for histogram-
+// equalized coloring.
+
+__kernel void colorize_rgb(__global const int* iterations,
+                           __global const uchar* paletteLut,
+                           __global uchar* rgb,
+                           int pixelCount,
+                           int maxIterations) {
+    const int idx = get_global_id(0);
+    if (idx >= pixelCount) {
+        return;
+    }
+
+    const int iter = clamp(iterations[idx], 0, maxIterations);
+    vstore3(vload3(iter, paletteLut), idx, rgb);
+}
+
+// Grid-stride histogram of maxIterations + 1 bins (histogram must start
+// zeroed). With useLocal set, each work-group counts into localBins with local
+// atomics and adds its non-zero bins to the global histogram once, so global
+// atomics scale with groups x bins instead of pixels. Without it (too many
+// bins for local memory) every pixel goes straight to the global histogram.
+__kernel void iteration_histogram(__global const int* iterations,
+                                  int pixelCount,
+                                  int maxIterations,
+                                  __global uint* histogram,
+                                  __local uint* localBins,
+                                  int useLocal) {
+    const int bins = maxIterations + 1;
+    const int lid = get_local_id(0);
+    const int lsize = get_local_size(0);
+
+    if (useLocal) {
+        for (int b = lid; b < bins; b += lsize) {
+            localBins[b] = 0;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    for (int i = get_global_id(0); i < pixelCount; i += get_global_size(0)) {
+        const int iter = clamp(iterations[i], 0, maxIterations);
+        if (useLocal) {
+            atomic_inc(&localBins[iter]);
+        } else {
+            atomic_inc(&histogram[iter]);
+        }
+    }
+
+    if (useLocal) {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (int b = lid; b < bins; b += lsize) {
+            const uint n = localBins[b];
+            if (n) {
+                atomic_add(&histogram[b], n);
+            }
+        }
+    }
+}
@@ -1,36 +1,93 @@
 // Mandelbrot / Julia kernel.
 // juliaMode == 0 -> Mandelbrot (c from pixel, z0 = 0)
 // juliaMode != 0 -> Julia (c from (juliaRe, juliaImag), z0 from pixel)
+//
+// Global ids are absolute pixel coordinates. The output buffer covers only the
+// dispatched range (row pitch = global size in X), so a tiled render can launch
+// with a global offset into a small reusable buffer; a full-frame launch with no
+// offset keeps the plain y * width + x layout.
+// mandelbrot_points evaluates an arbitrary pixel list (Mariani-Silver
+// subdivision) with the same per-pixel function; mandelbrot_samples does the
+// same for sub-pixel positions (edge anti-aliasing subsamples).
+//
+// interior selects shortcuts for pixels inside the set: BULB_FLAG skips the
+// main cardioid and period-2 bulb (Mandelbrot only), PERIODICITY_FLAG stops
+// when the orbit repeats a point saved at power-of-two intervals (Brent).
+// Repeats are compared exactly, so either shortcut returns maxIterations only
+// where the full loop would.
+//
+// format selects how mandelbrot_iterations stores counts (IterationFormat in
+// iteration_format.h): uchar, ushort, int, or a packed uint holding the count
+// above an 8-bit smooth-coloring fraction.
+//
+// pixelsPerItem lets one mandelbrot_iterations work item cover several pixels
+// of its row, spaced one global size apart so neighbouring items still touch
+// neighbouring pixels; the host launches width / pixelsPerItem items in X.
+// With pixelsPerItem == 1 the layout is the one described above.
+//
+// The math constants (VIEWPORT_SCALE_X, ESCAPE_RADIUS_SQUARED, ...), the
+// interior shortcut bits (BULB_FLAG, ...) and the storage format codes
+// (FORMAT_U8, ..., PACKED_FRACTION_BITS) are -D build options generated from
+// constants.h and IterationFormat by KernelManager.
+//
+// Specialized builds (KernelVariant) also define SPEC_JULIA (0 or 1) and/or
+// SPEC_MAX_ITERATIONS, which replace the juliaMode and maxIterations
+// arguments with constants, and SPEC_UNROLL, the escape-loop steps taken per
+// iteration-bound check. Counts are identical to the generic build.
 
-// Kernel constants (matches C++ constants.h for consistency).
-#define VIEWPORT_SCALE_X 3.5f
-#define VIEWPORT_SCALE_Y 2.0f
-#define PIXEL_OFFSET 0.5f
-#define ESCAPE_RADIUS_SQUARED 4.0f
-#define JULIA_MULTIPLIER 2.0f
+#ifndef SPEC_UNROLL
+#define SPEC_UNROLL 1
+#endif
 
-__kernel void mandelbrot_iterations(__global int* iterations,
-                                    int width,
-                                    int height,
-                                    float centerX,
-                                    float centerY,
-                                    float zoom,
-                                    int maxIterations,
-                                    float juliaRe,
-                                    float juliaImag,
-                                    int juliaMode) {
-    const int gx = get_global_id(0);
-    const int gy = get_global_id(1);
-
-    if (gx >= width || gy >= height) {
-        return;
+// One z -> z^2 + c step plus the periodicity bookkeeping; true when the orbit
+// is back at the saved point (a cycle: the pixel never escapes).
+inline bool orbit_step(float* x, float* y, float cx, float cy, int periodicity,
+                       float* savedX, float* savedY, int* window, int* step) {
+    const float xtemp = *x * *x - *y * *y + cx;
+    *y = JULIA_MULTIPLIER * *x * *y + cy;
+    *x = xtemp;
+    if (periodicity) {
+        if (*x == *savedX && *y == *savedY) {
+            return true;
+        }
+        if (++*step == *window) {
+            *savedX = *x;
+            *savedY = *y;
+            *step = 0;
+            *window *= 2;
+        }
     }
+    return false;
+}
 
-    const int idx = gy * width + gx;
+// Escape-time count at pixel coordinates (gx, gy), which may be fractional;
+// shared by every entry point so a subdivided render matches the full-frame
+// one bit for bit. *radius2 receives |z|^2 where the loop stopped (0 when a
+// shortcut fired).
+int iterate_pixel(float gx,
+                  float gy,
+                  int width,
+                  int height,
+                  float centerX,
+                  float centerY,
+                  float zoom,
+                  int maxIterations,
+                  float juliaRe,
+                  float juliaImag,
+                  int juliaMode,
+                  int interior,
+                  float* radius2) {
+#ifdef SPEC_JULIA
+    juliaMode = SPEC_JULIA;
+#endif
+#ifdef SPEC_MAX_ITERATIONS
+    maxIterations = SPEC_MAX_ITERATIONS;
+#endif
+    *radius2 = 0.0f;
 
     // Map pixel coordinate to complex plane.
-    float px = ((float)gx / (float)width - PIXEL_OFFSET) * VIEWPORT_SCALE_X / zoom + centerX;
-    float py = ((float)gy / (float)height - PIXEL_OFFSET) * VIEWPORT_SCALE_Y / zoom + centerY;
+    float px = (gx / (float)width - PIXEL_OFFSET) * VIEWPORT_SCALE_X / zoom + centerX;
+    float py = (gy / (float)height - PIXEL_OFFSET) * VIEWPORT_SCALE_Y / zoom + centerY;
 
     float x, y;
     float cx, cy;
@@ -48,16 +105,152 @@ __kernel void mandelbrot_iterations(__global int* iterations,
         cx = juliaRe;
         cy = juliaImag;
     }
+
+    if (juliaMode == 0 && (interior & BULB_FLAG)) {
+        const float xq = cx - 0.25f;
+        const float y2 = cy * cy;
+        const float q = xq * xq + y2;
+        const float xb = cx + 1.0f;
+        if (q * (q + xq) <= 0.25f * y2 || xb * xb + y2 <= 0.0625f) {
+            return maxIterations;
+        }
+    }
+    const int periodicity = interior & PERIODICITY_FLAG;
+    float savedX = x;
+    float savedY = y;
+    int window = PERIOD_WINDOW_START;
+    int step = 0;
+
     int iter = 0;
 
+#if SPEC_UNROLL > 1
+    // The bound is checked once per SPEC_UNROLL steps, escape after each one.
+    while (iter + SPEC_UNROLL <= maxIterations) {
+        #pragma unroll
+        for (int u = 0; u < SPEC_UNROLL; ++u) {
+            if (x * x + y * y > ESCAPE_RADIUS_SQUARED) {
+                *radius2 = x * x + y * y;
+                return iter;
+            }
+            ++iter;
+            if (orbit_step(&x, &y, cx, cy, periodicity, &savedX, &savedY, &window, &step)) {
+                return maxIterations;
+            }
+        }
+    }
+#endif
     while (x * x + y * y <= ESCAPE_RADIUS_SQUARED && iter < maxIterations) {
-        float xtemp = x * x - y * y + cx;
-        y = JULIA_MULTIPLIER * x * y + cy;
-        x = xtemp;
         ++iter;
+        if (orbit_step(&x, &y, cx, cy, periodicity, &savedX, &savedY, &window, &step)) {
+            return maxIterations;  // Cycle: the orbit never escapes.
+        }
     }
+    *radius2 = x * x + y * y;
+    return iter;
+}
 
-    iterations[idx] = iter;
+// Store one count at idx in the buffer's format. The packed fraction is
+// 1 - log2(log2 |z|) at escape (the continuous-count remainder), scaled to a
+// byte; pixels that never escaped store 0.
+void store_count(__global uchar* out, int idx, int iter, float radius2, int maxIterations, int format) {
+    if (format == FORMAT_U8) {
+        out[idx] = (uchar)iter;
+    } else if (format == FORMAT_U16) {
+        ((__global ushort*)out)[idx] = (ushort)iter;
+    } else if (format == FORMAT_PACKED) {
+        uint fraction = 0;
+        if (iter < maxIterations && radius2 > ESCAPE_RADIUS_SQUARED) {
+            const float f = 1.0f - log2(0.5f * log2(radius2));
+            fraction = (uint)clamp(f * (float)(1 << PACKED_FRACTION_BITS), 0.0f,
+                                   (float)((1 << PACKED_FRACTION_BITS) - 1));
+        }
+        ((__global uint*)out)[idx] = ((uint)iter << PACKED_FRACTION_BITS) | fraction;
+    } else {
+        ((__global int*)out)[idx] = iter;
+    }
 }
 
+__kernel void mandelbrot_iterations(__global uchar* iterations,
+                                    int width,
+                                    int height,
+                                    float centerX,
+                                    float centerY,
+                                    float zoom,
+                                    int maxIterations,
+                                    float juliaRe,
+                                    float juliaImag,
+                                    int juliaMode,
+                                    int interior,
+                                    int format,
+                                    int pixelsPerItem) {
+    const int gy = get_global_id(1);
+    if (gy >= height) {
+        return;
+    }
+
+    const int offsetX = (int)get_global_offset(0);
+    const int column = (int)get_global_id(0) - offsetX;
+    const int stride = (int)get_global_size(0);
+    const int rowBase = (gy - (int)get_global_offset(1)) * stride * pixelsPerItem;
 
+    for (int p = 0; p < pixelsPerItem; ++p) {
+        const int local = column + p * stride;
+        const int gx = offsetX + local;
+        if (gx >= width) {
+            break;
+        }
+        float radius2;
+        const int iter = iterate_pixel((float)gx, (float)gy, width, height, centerX, centerY, zoom,
+                                       maxIterations, juliaRe, juliaImag, juliaMode, interior, &radius2);
+        store_count(iterations, rowBase + local, iter, radius2, maxIterations, format);
+    }
+}
+
+// Scattered pixels for subdivision: points holds (x, y) pairs, one work item
+// per pair, results are written in the same order.
+__kernel void mandelbrot_points(__global int* iterations,
+                                __global const int2* points,
+                                int count,
+                                int width,
+                                int height,
+                                float centerX,
+                                float centerY,
+                                float zoom,
+                                int maxIterations,
+                                float juliaRe,
+                                float juliaImag,
+                                int juliaMode,
+                                int interior) {
+    const int i = get_global_id(0);
+    if (i >= count) {
+        return;
+    }
+    const int2 p = points[i];
+    float radius2;
+    iterations[i] = iterate_pixel((float)p.x, (float)p.y, width, height, centerX, centerY, zoom,
+                                  maxIterations, juliaRe, juliaImag, juliaMode, interior, &radius2);
+}
+
+// Same arguments as mandelbrot_points, with sub-pixel sample positions.
+__kernel void mandelbrot_samples(__global int* iterations,
+                                 __global const float2* samples,
+                                 int count,
+                                 int width,
+                                 int height,
+                                 float centerX,
+                                 float centerY,
+                                 float zoom,
+                                 int maxIterations,
+                                 float juliaRe,
+                                 float juliaImag,
+                                 int juliaMode,
+                                 int interior) {
+    const int i = get_global_id(0);
+    if (i >= count) {
+        return;
+    }
+    const float2 s = samples[i];
+    float radius2;
+    iterations[i] = iterate_pixel(s.x, s.y, width, height, centerX, centerY, zoom,
+                                  maxIterations, juliaRe, juliaImag, juliaMode, interior, &radius2);
+}
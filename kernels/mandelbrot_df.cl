@@ -0,0 +1,130 @@
+// Mandelbrot / Julia kernel in double-float arithmetic: each value is a float2
+// (hi, lo) with hi + lo carrying ~44 significant bits, built from float
+// operations only. Bridges the zooms between float and native double on
+// devices where fp64 is slow or missing.
+//
+// The host passes the center, per-pixel step and Julia c already split into
+// (hi, lo) pairs. Output indexing, build-option constants and the SPEC_*
+// specialization options follow mandelbrot_iterations.
+
+// Error-free transforms rely on every operation rounding exactly once.
+#pragma OPENCL FP_CONTRACT OFF
+
+#ifndef SPEC_UNROLL
+#define SPEC_UNROLL 1
+#endif
+
+// s + e == a + b exactly.
+inline float2 df_two_sum(float a, float b) {
+    const float s = a + b;
+    const float bb = s - a;
+    const float e = (a - (s - bb)) + (b - bb);
+    return (float2)(s, e);
+}
+
+// Same, for |a| >= |b|.
+inline float2 df_quick_two_sum(float a, float b) {
+    const float s = a + b;
+    return (float2)(s, b - (s - a));
+}
+
+inline float2 df_add(float2 a, float2 b) {
+    float2 s = df_two_sum(a.x, b.x);
+    const float2 t = df_two_sum(a.y, b.y);
+    s.y += t.x;
+    s = df_quick_two_sum(s.x, s.y);
+    s.y += t.y;
+    return df_quick_two_sum(s.x, s.y);
+}
+
+inline float2 df_sub(float2 a, float2 b) {
+    return df_add(a, -b);
+}
+
+// fma gives the exact low part of a.x * b.x.
+inline float2 df_mul(float2 a, float2 b) {
+    const float p = a.x * b.x;
+    float e = fma(a.x, b.x, -p);
+    e += a.x * b.y + a.y * b.x;
+    return df_quick_two_sum(p, e);
+}
+
+inline float2 df_mul_f(float2 a, float b) {
+    const float p = a.x * b;
+    float e = fma(a.x, b, -p);
+    e += a.y * b;
+    return df_quick_two_sum(p, e);
+}
+
+// z -> z^2 + c in double-float; false (z unchanged) once |z|^2 exceeds the
+// escape radius.
+inline bool df_step(float2* x, float2* y, float2 cx, float2 cy) {
+    const float2 x2 = df_mul(*x, *x);
+    const float2 y2 = df_mul(*y, *y);
+    if (x2.x + y2.x > ESCAPE_RADIUS_SQUARED) {
+        return false;
+    }
+    const float2 xy = df_mul(*x, *y);
+    *x = df_add(df_sub(x2, y2), cx);
+    *y = df_add(xy * 2.0f, cy);
+    return true;
+}
+
+int iterate_df(float2 x, float2 y, float2 cx, float2 cy, int maxIterations) {
+    int iter = 0;
+#if SPEC_UNROLL > 1
+    while (iter + SPEC_UNROLL <= maxIterations) {
+        #pragma unroll
+        for (int u = 0; u < SPEC_UNROLL; ++u) {
+            if (!df_step(&x, &y, cx, cy)) {
+                return iter;
+            }
+            ++iter;
+        }
+    }
+#endif
+    while (iter < maxIterations && df_step(&x, &y, cx, cy)) {
+        ++iter;
+    }
+    return iter;
+}
+
+__kernel void mandelbrot_iterations_df(__global int* iterations,
+                                       int width,
+                                       int height,
+                                       float2 centerX,
+                                       float2 centerY,
+                                       float2 stepX,
+                                       float2 stepY,
+                                       int maxIterations,
+                                       float2 juliaRe,
+                                       float2 juliaImag,
+                                       int juliaMode) {
+#ifdef SPEC_JULIA
+    juliaMode = SPEC_JULIA;
+#endif
+#ifdef SPEC_MAX_ITERATIONS
+    maxIterations = SPEC_MAX_ITERATIONS;
+#endif
+    const int gx = get_global_id(0);
+    const int gy = get_global_id(1);
+
+    if (gx >= width || gy >= height) {
+        return;
+    }
+
+    const int idx = (gy - (int)get_global_offset(1)) * (int)get_global_size(0)
+                  + (gx - (int)get_global_offset(0));
+
+    // Pixel offsets from the center in whole (or half) pixels are exact in
+    // float; only the step multiply and center add need the extra precision.
+    const float2 px = df_add(centerX, df_mul_f(stepX, (float)gx - 0.5f * (float)width));
+    const float2 py = df_add(centerY, df_mul_f(stepY, (float)gy - 0.5f * (float)height));
+
+    const float2 x = juliaMode ? px : (float2)(0.0f, 0.0f);
+    const float2 y = juliaMode ? py : (float2)(0.0f, 0.0f);
+    const float2 cx = juliaMode ? juliaRe : px;
+    const float2 cy = juliaMode ? juliaImag : py;
+
+    iterations[idx] = iterate_df(x, y, cx, cy, maxIterations);
+}
@@ -0,0 +1,73 @@
+// Mandelbrot / Julia kernel in native double precision (cl_khr_fp64).
+// Same mapping, loop and output indexing as mandelbrot_iterations in
+// mandelbrot.cl; KernelManager builds it only on devices reporting fp64.
+// Constants and the SPEC_* specialization options are those of
+// mandelbrot.cl (the float constants are exact in double).
+
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+
+#ifndef SPEC_UNROLL
+#define SPEC_UNROLL 1
+#endif
+
+int iterate_double(double x, double y, double cx, double cy, int maxIterations) {
+    int iter = 0;
+#if SPEC_UNROLL > 1
+    while (iter + SPEC_UNROLL <= maxIterations) {
+        #pragma unroll
+        for (int u = 0; u < SPEC_UNROLL; ++u) {
+            if (x * x + y * y > ESCAPE_RADIUS_SQUARED) {
+                return iter;
+            }
+            const double xtemp = x * x - y * y + cx;
+            y = JULIA_MULTIPLIER * x * y + cy;
+            x = xtemp;
+            ++iter;
+        }
+    }
+#endif
+    while (x * x + y * y <= ESCAPE_RADIUS_SQUARED && iter < maxIterations) {
+        const double xtemp = x * x - y * y + cx;
+        y = JULIA_MULTIPLIER * x * y + cy;
+        x = xtemp;
+        ++iter;
+    }
+    return iter;
+}
+
+__kernel void mandelbrot_iterations_double(__global int* iterations,
+                                           int width,
+                                           int height,
+                                           double centerX,
+                                           double centerY,
+                                           double zoom,
+                                           int maxIterations,
+                                           double juliaRe,
+                                           double juliaImag,
+                                           int juliaMode) {
+#ifdef SPEC_JULIA
+    juliaMode = SPEC_JULIA;
+#endif
+#ifdef SPEC_MAX_ITERATIONS
+    maxIterations = SPEC_MAX_ITERATIONS;
+#endif
+    const int gx = get_global_id(0);
+    const int gy = get_global_id(1);
+
+    if (gx >= width || gy >= height) {
+        return;
+    }
+
+    const int idx = (gy - (int)get_global_offset(1)) * (int)get_global_size(0)
+                  + (gx - (int)get_global_offset(0));
+
+    const double px = ((double)gx / (double)width - PIXEL_OFFSET) * VIEWPORT_SCALE_X / zoom + centerX;
+    const double py = ((double)gy / (double)height - PIXEL_OFFSET) * VIEWPORT_SCALE_Y / zoom + centerY;
+
+    const double x = juliaMode ? px : 0.0;
+    const double y = juliaMode ? py : 0.0;
+    const double cx = juliaMode ? juliaRe : px;
+    const double cy = juliaMode ? juliaImag : py;
+
+    iterations[idx] = iterate_double(x, y, cx, cy, maxIterations);
+}
@@ -0,0 +1,61 @@
+// Perturbation (deep-zoom) kernel - see include/perturbation.h.
+// orbit holds the host's high-precision reference orbit Z_0 .. Z_{orbitLength-1}
+// rounded to double; each work-item iterates only its offset from it:
+//   delta_{n+1} = (2 Z_n + delta_n) delta_n + dc
+// and rebases onto Z_0 when |Z_m + delta| < |delta| (glitch) or the orbit ends.
+// Needs cl_khr_fp64; KernelManager skips this program on devices without it.
+//
+// Output indexing follows mandelbrot_iterations (relative to the global offset),
+// as do PIXEL_OFFSET and ESCAPE_RADIUS_SQUARED (build options).
+
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+
+__kernel void perturbation_iterations(__global int* iterations,
+                                      __global const double2* orbit,
+                                      int orbitLength,
+                                      int width,
+                                      int height,
+                                      double scaleX,
+                                      double scaleY,
+                                      int maxIterations,
+                                      int juliaMode,
+                                      double refOffsetX,
+                                      double refOffsetY) {
+    const int gx = get_global_id(0);
+    const int gy = get_global_id(1);
+
+    if (gx >= width || gy >= height) {
+        return;
+    }
+
+    const int idx = (gy - (int)get_global_offset(1)) * (int)get_global_size(0)
+                  + (gx - (int)get_global_offset(0));
+
+    // Pixel offset from the reference point (refOffset from the view center).
+    const double2 dc = (double2)(((double)gx / (double)width - PIXEL_OFFSET) * scaleX - refOffsetX,
+                                 ((double)gy / (double)height - PIXEL_OFFSET) * scaleY - refOffsetY);
+
+    // Mandelbrot: delta_0 = 0 and dc is added every step. Julia: delta_0 = dc.
+    double2 d = juliaMode ? dc : (double2)(0.0, 0.0);
+    const double2 add = juliaMode ? (double2)(0.0, 0.0) : dc;
+    const double2 z0 = orbit[0];
+    const int last = orbitLength - 1;
+
+    int m = 0;
+    int iter = 0;
+    double2 z = z0 + d;
+    while (dot(z, z) <= ESCAPE_RADIUS_SQUARED && iter < maxIterations) {
+        const double2 t = 2.0 * orbit[m] + d;
+        d = (double2)(t.x * d.x - t.y * d.y, t.x * d.y + t.y * d.x) + add;
+        ++m;
+        ++iter;
+
+        z = orbit[m] + d;
+        if (dot(z, z) < dot(d, d) || m == last) {
+            d = z - z0;
+            m = 0;
+        }
+    }
+
+    iterations[idx] = iter;
+}
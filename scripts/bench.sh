@@ -0,0 +1,91 @@
+#!/usr/bin/env bash
+# Build and run the host-side benchmarks (no OpenCL device needed; the output
+# writer's trace hooks only link against the ICD loader).
+set -euo pipefail
+
+PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+SRC_DIR="${PROJECT_ROOT}/src"
+BUILD_DIR="${PROJECT_ROOT}/build"
+
+mkdir -p "${BUILD_DIR}"
+
+# macOS ships OpenCL as a framework; elsewhere link the ICD loader.
+if [[ "$(uname -s)" == "Darwin" ]]; then
+    OPENCL_LIBS=(-framework OpenCL)
+else
+    OPENCL_LIBS=(-lOpenCL)
+fi
+
+echo "[bench] Compiling palette_bench..."
+g++ -std=c++17 -O2 -Wextra -pthread \
+    -I"${PROJECT_ROOT}/include" \
+    "${PROJECT_ROOT}/bench/palette_bench.cpp" \
+    "${SRC_DIR}/cpu_renderer.cpp" \
+    "${SRC_DIR}/interior_check.cpp" \
+    "${SRC_DIR}/palette.cpp" \
+    "${SRC_DIR}/output_writer.cpp" \
+    "${SRC_DIR}/png_encoder.cpp" \
+    "${SRC_DIR}/iteration_format.cpp" \
+    "${SRC_DIR}/color_histogram.cpp" \
+    "${SRC_DIR}/trace.cpp" \
+    "${OPENCL_LIBS[@]}" -lz \
+    -o "${BUILD_DIR}/palette_bench" \
+    2>&1 | sed 's/^/[g++] /'
+
+echo "[bench] Compiling subdivision_bench..."
+g++ -std=c++17 -O2 -Wextra -pthread \
+    -I"${PROJECT_ROOT}/include" \
+    "${PROJECT_ROOT}/bench/subdivision_bench.cpp" \
+    "${SRC_DIR}/cpu_renderer.cpp" \
+    "${SRC_DIR}/interior_check.cpp" \
+    "${SRC_DIR}/mariani_silver.cpp" \
+    -o "${BUILD_DIR}/subdivision_bench" \
+    2>&1 | sed 's/^/[g++] /'
+
+echo "[bench] Compiling antialias_bench..."
+g++ -std=c++17 -O2 -Wextra -pthread \
+    -I"${PROJECT_ROOT}/include" \
+    "${PROJECT_ROOT}/bench/antialias_bench.cpp" \
+    "${SRC_DIR}/cpu_renderer.cpp" \
+    "${SRC_DIR}/interior_check.cpp" \
+    "${SRC_DIR}/edge_antialias.cpp" \
+    "${SRC_DIR}/palette.cpp" \
+    "${SRC_DIR}/output_writer.cpp" \
+    "${SRC_DIR}/png_encoder.cpp" \
+    "${SRC_DIR}/iteration_format.cpp" \
+    "${SRC_DIR}/color_histogram.cpp" \
+    "${SRC_DIR}/trace.cpp" \
+    "${OPENCL_LIBS[@]}" -lz \
+    -o "${BUILD_DIR}/antialias_bench" \
+    2>&1 | sed 's/^/[g++] /'
+
+echo "[bench] Compiling png_bench..."
+g++ -std=c++17 -O2 -Wextra -pthread \
+    -I"${PROJECT_ROOT}/include" \
+    "${PROJECT_ROOT}/bench/png_bench.cpp" \
+    "${SRC_DIR}/cpu_renderer.cpp" \
+    "${SRC_DIR}/interior_check.cpp" \
+    "${SRC_DIR}/palette.cpp" \
+    "${SRC_DIR}/output_writer.cpp" \
+    "${SRC_DIR}/png_encoder.cpp" \
+    "${SRC_DIR}/iteration_format.cpp" \
+    "${SRC_DIR}/color_histogram.cpp" \
+    "${SRC_DIR}/trace.cpp" \
+    "${OPENCL_LIBS[@]}" -lz \
+    -o "${BUILD_DIR}/png_bench" \
+    2>&1 | sed 's/^/[g++] /'
+
+echo "[bench] Compiling perturbation_bench..."
+g++ -std=c++17 -O2 -Wextra -pthread \
+    -I"${PROJECT_ROOT}/include" \
+    "${PROJECT_ROOT}/bench/perturbation_bench.cpp" \
+    "${SRC_DIR}/perturbation.cpp" \
+    "${SRC_DIR}/fixed_point.cpp" \
+    -o "${BUILD_DIR}/perturbation_bench" \
+    2>&1 | sed 's/^/[g++] /'
+
+"${BUILD_DIR}/palette_bench" "$@"
+"${BUILD_DIR}/subdivision_bench"
+"${BUILD_DIR}/antialias_bench"
+"${BUILD_DIR}/png_bench"
+"${BUILD_DIR}/perturbation_bench"
@@ -7,22 +7,51 @@ BUILD_DIR="${PROJECT_ROOT}/build"
 
 mkdir -p "${BUILD_DIR}"
 
+# macOS ships OpenCL as a framework; elsewhere link the ICD loader.
+if [[ "$(uname -s)" == "Darwin" ]]; then
+    OPENCL_LIBS=(-framework OpenCL)
+else
+    OPENCL_LIBS=(-lOpenCL)
+fi
+
 echo "[build] Compiling OpenCL Fractal Renderer (scaffold)..."
 
-g++ -std=c++17 -O2 -Wextra \
+g++ -std=c++17 -O2 -Wextra -pthread \
     -I"${PROJECT_ROOT}/include" \
     "${SRC_DIR}/main.cpp" \
     "${SRC_DIR}/cli_parser.cpp" \
     "${SRC_DIR}/device_manager.cpp" \
     "${SRC_DIR}/kernel_manager.cpp" \
+    "${SRC_DIR}/device_set.cpp" \
+    "${SRC_DIR}/program_cache.cpp" \
     "${SRC_DIR}/memory_manager.cpp" \
+    "${SRC_DIR}/buffer_pool.cpp" \
     "${SRC_DIR}/fractal_strategy.cpp" \
     "${SRC_DIR}/renderer.cpp" \
+    "${SRC_DIR}/kernel_args.cpp" \
+    "${SRC_DIR}/animation.cpp" \
+    "${SRC_DIR}/worker_pool.cpp" \
+    "${SRC_DIR}/render_server.cpp" \
+    "${SRC_DIR}/json_config.cpp" \
+    "${SRC_DIR}/cpu_renderer.cpp" \
+    "${SRC_DIR}/precision_tier.cpp" \
+    "${SRC_DIR}/interior_check.cpp" \
+    "${SRC_DIR}/iteration_format.cpp" \
+    "${SRC_DIR}/color_histogram.cpp" \
+    "${SRC_DIR}/perturbation.cpp" \
+    "${SRC_DIR}/fixed_point.cpp" \
+    "${SRC_DIR}/mariani_silver.cpp" \
+    "${SRC_DIR}/edge_antialias.cpp" \
+    "${SRC_DIR}/work_group_tuning.cpp" \
+    "${SRC_DIR}/trace.cpp" \
     "${SRC_DIR}/output_writer.cpp" \
-    -framework OpenCL \
+    "${SRC_DIR}/png_encoder.cpp" \
+    "${SRC_DIR}/iteration_field.cpp" \
+    "${SRC_DIR}/palette.cpp" \
+    "${SRC_DIR}/image_stream.cpp" \
+    "${OPENCL_LIBS[@]}" -lz \
     -o "${BUILD_DIR}/fractal_renderer" \
     2>&1 | sed 's/^/[g++] /'
 
 echo "[build] Done. Binary at ${BUILD_DIR}/fractal_renderer"
 
-
@@ -0,0 +1,14 @@
+#!/usr/bin/env bash
+# Throughput comparison: native CPU backend vs. the OpenCL CPU device on the
+# same scene. Extra arguments are forwarded to both runs (e.g. --iterations).
+set -euo pipefail
+
+PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+RUN="${PROJECT_ROOT}/scripts/run.sh"
+SCENE=(--width 1920 --height 1080 --iterations 1000 --output compare_backends.ppm)
+
+echo "[compare] OpenCL CPU device:"
+"${RUN}" "${SCENE[@]}" --backend opencl --device cpu "$@" | grep -E '^\[(Device\] Selected|Fractal kernel)'
+
+echo "[compare] Native CPU backend:"
+"${RUN}" "${SCENE[@]}" --backend cpu "$@" | grep -E '^\[CPU kernel'
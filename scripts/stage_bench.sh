@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# Build and run the per-stage benchmark (needs an OpenCL runtime unless run
+# with --backend cpu). Arguments are passed through; results go to
+# build/stage_bench.json unless --output is given.
+set -euo pipefail
+
+PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+SRC_DIR="${PROJECT_ROOT}/src"
+BUILD_DIR="${PROJECT_ROOT}/build"
+
+mkdir -p "${BUILD_DIR}"
+
+# macOS ships OpenCL as a framework; elsewhere link the ICD loader.
+if [[ "$(uname -s)" == "Darwin" ]]; then
+    OPENCL_LIBS=(-framework OpenCL)
+else
+    OPENCL_LIBS=(-lOpenCL)
+fi
+
+echo "[bench] Compiling stage_bench..."
+g++ -std=c++17 -O2 -Wextra -pthread \
+    -I"${PROJECT_ROOT}/include" \
+    "${PROJECT_ROOT}/bench/stage_bench.cpp" \
+    "${SRC_DIR}/device_manager.cpp" \
+    "${SRC_DIR}/kernel_manager.cpp" \
+    "${SRC_DIR}/program_cache.cpp" \
+    "${SRC_DIR}/memory_manager.cpp" \
+    "${SRC_DIR}/buffer_pool.cpp" \
+    "${SRC_DIR}/kernel_args.cpp" \
+    "${SRC_DIR}/trace.cpp" \
+    "${SRC_DIR}/cpu_renderer.cpp" \
+    "${SRC_DIR}/precision_tier.cpp" \
+    "${SRC_DIR}/interior_check.cpp" \
+    "${SRC_DIR}/iteration_format.cpp" \
+    "${SRC_DIR}/color_histogram.cpp" \
+    "${SRC_DIR}/output_writer.cpp" \
+    "${SRC_DIR}/png_encoder.cpp" \
+    "${SRC_DIR}/palette.cpp" \
+    "${OPENCL_LIBS[@]}" -lz \
+    -o "${BUILD_DIR}/stage_bench" \
+    2>&1 | sed 's/^/[g++] /'
+
+cd "${PROJECT_ROOT}"
+"${BUILD_DIR}/stage_bench" "$@"
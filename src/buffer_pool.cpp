@@ -0,0 +1,216 @@
+// BufferPool implementation - size-class reuse of device and host allocations.
+
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "constants.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+// Oldest idle entry across a map of per-class lists; returns false if empty.
+template <typename Map>
+bool findOldest(Map& idle, typename Map::iterator& classIt, size_t& index, uint64_t& lastUse) {
+    bool found = false;
+    for (auto it = idle.begin(); it != idle.end(); ++it) {
+        for (size_t i = 0; i < it->second.size(); ++i) {
+            if (!found || it->second[i].lastUse < lastUse) {
+                found = true;
+                classIt = it;
+                index = i;
+                lastUse = it->second[i].lastUse;
+            }
+        }
+    }
+    return found;
+}
+
+template <typename Map>
+void eraseEntry(Map& idle, typename Map::iterator classIt, size_t index) {
+    auto& list = classIt->second;
+    list.erase(list.begin() + static_cast<std::ptrdiff_t>(index));
+    if (list.empty()) {
+        idle.erase(classIt);
+    }
+}
+
+} // namespace
+
+BufferPool::BufferPool(DeviceManager& deviceManager)
+    : deviceManager_(deviceManager)
+    , deviceBudget_(Pool::FALLBACK_BUDGET_BYTES)
+    , hostBudget_(Pool::FALLBACK_BUDGET_BYTES)
+{
+}
+
+BufferPool::~BufferPool() {
+    for (auto& entry : idleDevice_) {
+        for (const DeviceEntry& e : entry.second) {
+            clReleaseMemObject(e.buffer);
+        }
+    }
+    for (auto& entry : liveDevice_) {
+        clReleaseMemObject(entry.first);
+    }
+}
+
+size_t BufferPool::sizeClass(size_t bytes) {
+    if (bytes <= Pool::MIN_CLASS_BYTES) {
+        return Pool::MIN_CLASS_BYTES;
+    }
+    // Round up to a multiple of a quarter of the largest power of two <= bytes:
+    // classes p, 1.25p, 1.5p, 1.75p, 2p waste at most 25%.
+    size_t pow2 = Pool::MIN_CLASS_BYTES;
+    while (pow2 <= bytes / 2) {
+        pow2 *= 2;
+    }
+    const size_t step = pow2 / Pool::CLASSES_PER_DOUBLING;
+    return (bytes + step - 1) / step * step;
+}
+
+void BufferPool::setBudget(size_t deviceBytes, size_t hostBytes) {
+    deviceBudget_ = deviceBytes;
+    hostBudget_ = hostBytes;
+    trimDevice(0);
+    trimHost(0);
+}
+
+cl_mem BufferPool::acquireDevice(size_t bytes, cl_mem_flags flags) {
+    const DeviceKey key{flags, sizeClass(bytes)};
+    auto it = idleDevice_.find(key);
+    if (it != idleDevice_.end()) {
+        const cl_mem buffer = it->second.back().buffer;
+        it->second.pop_back();
+        if (it->second.empty()) {
+            idleDevice_.erase(it);
+        }
+        liveDevice_.emplace(buffer, key);
+        ++stats_.deviceHits;
+        return buffer;
+    }
+
+    ++stats_.deviceMisses;
+    trimDevice(key.second);
+
+    cl_int err = CL_SUCCESS;
+    cl_mem buffer = clCreateBuffer(deviceManager_.context(), flags, key.second, nullptr, &err);
+    if ((err != CL_SUCCESS || !buffer) && !idleDevice_.empty()) {
+        // Allocation failed with idle buffers still cached: drop them all and retry once.
+        trimDevice(deviceBudget_ + 1);
+        buffer = clCreateBuffer(deviceManager_.context(), flags, key.second, nullptr, &err);
+    }
+    if (err != CL_SUCCESS || !buffer) {
+        throw std::runtime_error("Failed to create pooled OpenCL buffer");
+    }
+    liveDevice_.emplace(buffer, key);
+    stats_.deviceBytes += key.second;
+    return buffer;
+}
+
+void BufferPool::releaseDevice(cl_mem buffer) {
+    if (!buffer) {
+        return;
+    }
+    auto it = liveDevice_.find(buffer);
+    if (it == liveDevice_.end()) {
+        throw std::runtime_error("Released an OpenCL buffer the pool does not own");
+    }
+    const DeviceKey key = it->second;
+    liveDevice_.erase(it);
+    idleDevice_[key].push_back({buffer, ++clock_});
+    trimDevice(0);
+}
+
+void BufferPool::trimDevice(size_t incoming) {
+    while (stats_.deviceBytes + incoming > deviceBudget_) {
+        auto classIt = idleDevice_.begin();
+        size_t index = 0;
+        uint64_t lastUse = 0;
+        if (!findOldest(idleDevice_, classIt, index, lastUse)) {
+            return;  // Everything left is in use; the budget only bounds the cache.
+        }
+        clReleaseMemObject(classIt->second[index].buffer);
+        stats_.deviceBytes -= classIt->first.second;
+        ++stats_.evictions;
+        eraseEntry(idleDevice_, classIt, index);
+    }
+}
+
+template <typename T>
+std::vector<T> BufferPool::acquireHost(std::map<size_t, std::vector<HostEntry<T>>>& idle, size_t count) {
+    const size_t classBytes = sizeClass(count * sizeof(T));
+    auto it = idle.find(classBytes);
+    if (it != idle.end()) {
+        std::vector<T> v = std::move(it->second.back().data);
+        it->second.pop_back();
+        if (it->second.empty()) {
+            idle.erase(it);
+        }
+        v.resize(count);
+        ++stats_.hostHits;
+        return v;
+    }
+
+    ++stats_.hostMisses;
+    trimHost(classBytes);
+    std::vector<T> v;
+    v.reserve(classBytes / sizeof(T));
+    v.resize(count);
+    stats_.hostBytes += v.capacity() * sizeof(T);
+    return v;
+}
+
+template <typename T>
+void BufferPool::releaseHost(std::map<size_t, std::vector<HostEntry<T>>>& idle, std::vector<T>&& v) {
+    const size_t bytes = v.capacity() * sizeof(T);
+    if (bytes == 0) {
+        return;
+    }
+    // Capacities come from acquireHost, so they sit exactly on a class.
+    idle[sizeClass(bytes)].push_back({std::move(v), ++clock_});
+    v = std::vector<T>();
+    trimHost(0);
+}
+
+std::vector<int> BufferPool::acquireInts(size_t count) {
+    return acquireHost(idleInts_, count);
+}
+
+std::vector<unsigned char> BufferPool::acquireBytes(size_t count) {
+    return acquireHost(idleBytes_, count);
+}
+
+void BufferPool::releaseInts(std::vector<int>&& v) {
+    releaseHost(idleInts_, std::move(v));
+}
+
+void BufferPool::releaseBytes(std::vector<unsigned char>&& v) {
+    releaseHost(idleBytes_, std::move(v));
+}
+
+void BufferPool::trimHost(size_t incoming) {
+    while (stats_.hostBytes + incoming > hostBudget_) {
+        auto intIt = idleInts_.begin();
+        auto byteIt = idleBytes_.begin();
+        size_t intIndex = 0;
+        size_t byteIndex = 0;
+        uint64_t intUse = 0;
+        uint64_t byteUse = 0;
+        const bool haveInt = findOldest(idleInts_, intIt, intIndex, intUse);
+        const bool haveByte = findOldest(idleBytes_, byteIt, byteIndex, byteUse);
+        if (!haveInt && !haveByte) {
+            return;
+        }
+        if (haveInt && (!haveByte || intUse < byteUse)) {
+            stats_.hostBytes -= std::min(stats_.hostBytes, intIt->second[intIndex].data.capacity() * sizeof(int));
+            eraseEntry(idleInts_, intIt, intIndex);
+        } else {
+            stats_.hostBytes -= std::min(stats_.hostBytes, byteIt->second[byteIndex].data.capacity());
+            eraseEntry(idleBytes_, byteIt, byteIndex);
+        }
+        ++stats_.evictions;
+    }
+}
@@ -7,6 +7,11 @@
 
 #include "cli_parser.h"
 #include "constants.h"
+#include "interior_check.h"
+#include "iteration_format.h"
+#include "palette.h"
+#include "png_encoder.h"
+#include "precision_tier.h"
 
 void print_help() {
     std::cout
@@ -30,10 +35,84 @@ void print_help() {
         << FractalConstants::Defaults::JULIA_REAL << ")\n"
         << "  --julia-imag <real>           Julia parameter imaginary part (default: "
         << FractalConstants::Defaults::JULIA_IMAG << ")\n"
-        << "  --local-size-x <int>          Optional local work-group size in X (default: auto)\n"
-        << "  --local-size-y <int>          Optional local work-group size in Y (default: auto)\n"
-        << "  --palette <name>              Color palette name (default: default)\n"
+        << "  --precision <tier>            Iteration arithmetic: auto, float, double-float, double or\n"
+        << "                                perturbation (deep zoom); auto picks the cheapest tier\n"
+        << "                                that resolves the view (default: auto)\n"
+        << "  --bench-precision             Time every precision tier on this view and exit\n"
+        << "  --interior <mode>             Interior shortcuts of the float loop: none, bulb\n"
+        << "                                (cardioid/period-2 bulb), periodicity or all (default: none)\n"
+        << "  --bench-interior              Time each interior mode at 1k/10k/100k iterations and exit\n"
+        << "  --specialize                  Iterate with a kernel compiled for this fractal type and\n"
+        << "                                iteration count (built once, binary-cached)\n"
+        << "  --bench-variants              Time each tier's generic kernel against its specialized\n"
+        << "                                variants on this view and exit\n"
+        << "  --iteration-format <fmt>      Iteration buffer format of the float kernel: auto, u8, u16,\n"
+        << "                                u32 or packed (count + smooth-coloring byte); auto picks\n"
+        << "                                the narrowest that holds --iterations (default: auto)\n"
+        << "  --local-size-x <int>          Optional local work-group size in X (default: autotuned,\n"
+        << "                                else chosen by OpenCL)\n"
+        << "  --local-size-y <int>          Optional local work-group size in Y (default: as above)\n"
+        << "  --pixels-per-item <int>       Pixels of a row per float-kernel work-item (default:\n"
+        << "                                autotuned, else 1)\n"
+        << "  --autotune                    Sweep legal work-group sizes and pixels per work-item for\n"
+        << "                                each iteration kernel, save the fastest and exit\n"
+        << "  --tuning-file <path>          Autotune results (default: "
+        << FractalConstants::Autotune::DEFAULT_FILE << ")\n"
+        << "  --no-tuning-file              Neither read nor write autotune results\n"
+        << "  --backend opencl|cpu|auto     Render backend (default: opencl; auto falls back to cpu\n"
+        << "                                when no OpenCL platform is usable)\n"
+        << "  --device gpu|cpu              Preferred OpenCL device type (default: gpu)\n"
+        << "  --threads <int>               Host worker threads: CPU backend, coloring, PNG encoding\n"
+        << "                                (default: all cores)\n"
+        << "  --tiled                       Render in tiles through one reusable device buffer\n"
+        << "  --tile-memory-mb <int>        Max device MiB per tile (default: device max allocation)\n"
+        << "  --stream                      Pipeline horizontal bands: kernel, readback and\n"
+        << "                                color/encode overlap; host memory stays bounded\n"
+        << "  --band-rows <int>             Rows per streaming band (default: ~1 Mpixel bands)\n"
+        << "  --device-color                Color on the device and read back RGB8 (OpenCL backend)\n"
+        << "  --readback copy|map|auto      Full-frame iteration readback: copy into host memory, or\n"
+        << "                                map the device buffer in place; auto maps on devices that\n"
+        << "                                share host memory (default: auto)\n"
+        << "  --subdivide                   Mariani-Silver: iterate tile borders, fill uniform tiles\n"
+        << "                                (float tier; skips large in-set regions)\n"
+        << "  --antialias <samples>         Extra jittered samples (1-" << FractalConstants::Antialias::MAX_SAMPLES
+        << ") for each edge pixel,\n"
+        << "                                i.e. whose count differs from a neighbour (default: off)\n"
+        << "  --multi-device                Render on every OpenCL device of every platform; row\n"
+        << "                                chunks go to whichever device is free\n"
+        << "  --chunk-rows <int>            Rows per multi-device chunk (default: ~16 per device)\n"
+        << "  --pool-memory-mb <int>        Buffer pool budget in MiB, device and host each\n"
+        << "                                (default: half of device memory / 1 GiB)\n"
+        << "  --animate <file>              Render a keyframed animation (center, zoom, Julia c)\n"
+        << "  --frames <int>                Frames to render with --animate (default: 60)\n"
+        << "  --serve                       Serve newline-delimited JSON render requests on stdin\n"
+        << "                                (responses on stdout, logs on stderr)\n"
+        << "  --serve-socket <path>         Serve the same protocol on a Unix domain socket\n"
+        << "  --jobs <int>                  Concurrent server jobs (default: 2 OpenCL, 1 CPU)\n"
+        << "  --queue-depth <int>           Max queued server requests (default: 16)\n"
+        << "  --max-megapixels <int>        Largest width x height a server request may ask for\n"
+        << "                                (default: 256)\n"
+        << "  --max-iterations <int>        Largest maxIterations a server request may ask for\n"
+        << "                                (default: 10000000)\n"
+        << "  --kernel-cache <dir>          OpenCL program binary cache (default: build/kernel_cache)\n"
+        << "  --no-kernel-cache             Always build OpenCL programs from source\n"
+        << "  --trace <file.json>           Record host stages and OpenCL command timestamps as\n"
+        << "                                Chrome trace-event JSON (chrome://tracing, Perfetto)\n"
+        << "  --palette <name>              Color palette: default, sunset, neon (default: default)\n"
+        << "  --palette-file <file>         Load a gradient file and use it as the palette\n"
+        << "  --coloring linear|histogram   Palette mapping: iter / max, or equalized by the frame's\n"
+        << "                                iteration histogram (default: linear)\n"
+        << "  --png-level <0-9>             PNG compression: 0 stores only, 1 fastest, 9 smallest\n"
+        << "                                (default: " << FractalConstants::Png::DEFAULT_LEVEL << ")\n"
+        << "  --png-filter <name>           PNG row filter: auto, adaptive, none, sub, up, average or\n"
+        << "                                paeth (default: auto = adaptive, none at level 0)\n"
         << "  --output <file>               Output image path (default: fractal.png/ppm/png)\n"
+        << "  --save-field <file>           Also save the raw iteration counts with the view, for\n"
+        << "                                --recolor\n"
+        << "  --field-compress              Store the saved field as zlib chunks (smaller; inflated\n"
+        << "                                on load instead of mapped)\n"
+        << "  --recolor <file>              Color a saved iteration field with the palette, coloring\n"
+        << "                                and output options; no rendering, no OpenCL\n"
         << "  -h, --help                    Show this help and exit\n";
 }
 
@@ -54,8 +133,9 @@ RenderConfig parse_args(int argc, char** argv) {
         } else if (arg == "--iterations" && i + 1 < argc) {
             builder.maxIterations(std::stoi(argv[++i]));
         } else if (arg == "--center" && i + 2 < argc) {
-            double x = std::stod(argv[++i]);
-            double y = std::stod(argv[++i]);
+            // Keep the decimal text: deep zooms need more digits than a double holds.
+            std::string x{argv[++i]};
+            std::string y{argv[++i]};
             builder.center(x, y);
         } else if (arg == "--zoom" && i + 1 < argc) {
             builder.zoom(std::stod(argv[++i]));
@@ -65,16 +145,161 @@ RenderConfig parse_args(int argc, char** argv) {
         } else if (arg == "--julia-imag" && i + 1 < argc) {
             double ji = std::stod(argv[++i]);
             builder.julia(builder.build().juliaReal, ji);
+        } else if (arg == "--precision" && i + 1 < argc) {
+            std::string precision{argv[++i]};
+            if (precision != "auto") {
+                precisionTierFromName(precision);  // Throws on unknown names.
+            }
+            builder.precision(precision);
+        } else if (arg == "--bench-precision") {
+            builder.benchPrecision(true);
+        } else if (arg == "--interior" && i + 1 < argc) {
+            std::string interior{argv[++i]};
+            interiorCheckFromName(interior);  // Throws on unknown names.
+            builder.interior(interior);
+        } else if (arg == "--iteration-format" && i + 1 < argc) {
+            std::string format{argv[++i]};
+            if (format != "auto") {
+                iterationFormatFromName(format);  // Throws on unknown names.
+            }
+            builder.iterationFormat(format);
+        } else if (arg == "--bench-interior") {
+            builder.benchInterior(true);
+        } else if (arg == "--specialize") {
+            builder.specialize(true);
+        } else if (arg == "--bench-variants") {
+            builder.benchVariants(true);
         } else if (arg == "--palette" && i + 1 < argc) {
-            builder.palette(argv[++i]);
+            std::string palette{argv[++i]};
+            if (!PaletteRegistry::instance().contains(palette)) {
+                throw std::runtime_error("Unknown palette: " + palette);
+            }
+            builder.palette(palette);
+        } else if (arg == "--palette-file" && i + 1 < argc) {
+            builder.paletteFile(argv[++i]);
+        } else if (arg == "--coloring" && i + 1 < argc) {
+            std::string coloring{argv[++i]};
+            if (coloring != "linear" && coloring != "histogram") {
+                throw std::runtime_error("Unknown coloring: " + coloring);
+            }
+            builder.coloring(coloring);
+        } else if (arg == "--png-level" && i + 1 < argc) {
+            const int level = std::stoi(argv[++i]);
+            if (level < 0 || level > 9) {
+                throw std::runtime_error("--png-level must be 0..9");
+            }
+            builder.pngLevel(level);
+        } else if (arg == "--png-filter" && i + 1 < argc) {
+            std::string filter{argv[++i]};
+            if (filter != "auto") {
+                PngEncoder::filterFromName(filter);  // Throws on unknown names.
+            }
+            builder.pngFilter(filter);
         } else if (arg == "--local-size-x" && i + 1 < argc) {
             int lx = std::stoi(argv[++i]);
             builder.localSize(lx, builder.build().localSizeY);
         } else if (arg == "--local-size-y" && i + 1 < argc) {
             int ly = std::stoi(argv[++i]);
             builder.localSize(builder.build().localSizeX, ly);
+        } else if (arg == "--pixels-per-item" && i + 1 < argc) {
+            const int pixels = std::stoi(argv[++i]);
+            if (pixels < 1) {
+                throw std::runtime_error("--pixels-per-item must be at least 1");
+            }
+            builder.pixelsPerItem(pixels);
+        } else if (arg == "--autotune") {
+            builder.autotune(true);
+        } else if (arg == "--tuning-file" && i + 1 < argc) {
+            builder.tuningFile(argv[++i]);
+        } else if (arg == "--no-tuning-file") {
+            builder.tuningFile("");
+        } else if (arg == "--backend" && i + 1 < argc) {
+            std::string backend{argv[++i]};
+            if (backend != "opencl" && backend != "cpu" && backend != "auto") {
+                throw std::runtime_error("Unknown backend: " + backend);
+            }
+            builder.backend(backend);
+        } else if (arg == "--device" && i + 1 < argc) {
+            std::string device{argv[++i]};
+            if (device != "gpu" && device != "cpu") {
+                throw std::runtime_error("Unknown device type: " + device);
+            }
+            builder.deviceType(device);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            builder.threads(std::stoi(argv[++i]));
+        } else if (arg == "--tiled") {
+            builder.tiled(true);
+        } else if (arg == "--tile-memory-mb" && i + 1 < argc) {
+            builder.tileMemoryMB(std::stoi(argv[++i]));
+        } else if (arg == "--stream") {
+            builder.streaming(true);
+        } else if (arg == "--band-rows" && i + 1 < argc) {
+            builder.bandRows(std::stoi(argv[++i]));
+        } else if (arg == "--device-color") {
+            builder.deviceColor(true);
+        } else if (arg == "--readback" && i + 1 < argc) {
+            std::string readback{argv[++i]};
+            if (readback != "copy" && readback != "map" && readback != "auto") {
+                throw std::runtime_error("Unknown readback mode: " + readback);
+            }
+            builder.readback(readback);
+        } else if (arg == "--subdivide") {
+            builder.subdivide(true);
+        } else if (arg == "--antialias" && i + 1 < argc) {
+            const int samples = std::stoi(argv[++i]);
+            if (samples < 0 || samples > FractalConstants::Antialias::MAX_SAMPLES) {
+                throw std::runtime_error("--antialias takes 0.." +
+                                         std::to_string(FractalConstants::Antialias::MAX_SAMPLES) + " samples");
+            }
+            builder.antialiasSamples(samples);
+        } else if (arg == "--multi-device") {
+            builder.multiDevice(true);
+        } else if (arg == "--chunk-rows" && i + 1 < argc) {
+            builder.chunkRows(std::stoi(argv[++i]));
+        } else if (arg == "--animate" && i + 1 < argc) {
+            builder.animation(argv[++i]);
+        } else if (arg == "--frames" && i + 1 < argc) {
+            const int frames = std::stoi(argv[++i]);
+            if (frames < 1) {
+                throw std::runtime_error("--frames must be at least 1");
+            }
+            builder.frameCount(frames);
+        } else if (arg == "--serve") {
+            builder.serve("stdin");
+        } else if (arg == "--serve-socket" && i + 1 < argc) {
+            builder.serve("socket", argv[++i]);
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            builder.serverJobs(std::stoi(argv[++i]));
+        } else if (arg == "--queue-depth" && i + 1 < argc) {
+            builder.queueDepth(std::stoi(argv[++i]));
+        } else if (arg == "--max-megapixels" && i + 1 < argc) {
+            const int megapixels = std::stoi(argv[++i]);
+            if (megapixels < 1) {
+                throw std::runtime_error("--max-megapixels must be at least 1");
+            }
+            builder.serverMaxMegapixels(megapixels);
+        } else if (arg == "--max-iterations" && i + 1 < argc) {
+            const int iterations = std::stoi(argv[++i]);
+            if (iterations < 1) {
+                throw std::runtime_error("--max-iterations must be at least 1");
+            }
+            builder.serverMaxIterations(iterations);
+        } else if (arg == "--kernel-cache" && i + 1 < argc) {
+            builder.kernelCacheDir(argv[++i]);
+        } else if (arg == "--no-kernel-cache") {
+            builder.kernelCacheDir("");
+        } else if (arg == "--trace" && i + 1 < argc) {
+            builder.traceFile(argv[++i]);
+        } else if (arg == "--pool-memory-mb" && i + 1 < argc) {
+            builder.poolMemoryMB(std::stoi(argv[++i]));
         } else if (arg == "--output" && i + 1 < argc) {
             builder.outputPath(argv[++i]);
+        } else if (arg == "--save-field" && i + 1 < argc) {
+            builder.saveField(argv[++i]);
+        } else if (arg == "--field-compress") {
+            builder.fieldCompress(true);
+        } else if (arg == "--recolor" && i + 1 < argc) {
+            builder.recolorFile(argv[++i]);
         } else {
             throw std::runtime_error("Unknown or incomplete argument: " + arg);
         }
@@ -90,7 +315,21 @@ void print_config_summary(const RenderConfig& cfg) {
               << "  Iterations : " << cfg.maxIterations << "\n"
               << "  Center     : (" << cfg.centerX << ", " << cfg.centerY << ")\n"
               << "  Zoom       : " << cfg.zoom << "\n"
-              << "  Palette    : " << cfg.palette << "\n"
+              << "  Precision  : " << cfg.precision << "\n"
+              << "  Interior   : " << cfg.interior << "\n"
+              << "  Iter format: " << cfg.iterationFormat << "\n"
+              << "  Backend    : " << cfg.backend << "\n"
+              << "  Palette    : " << (cfg.paletteFile.empty() ? cfg.palette : cfg.paletteFile)
+              << " (" << cfg.coloring << ")\n"
+              << "  Antialias  : "
+              << (cfg.antialiasSamples > 0 ? std::to_string(cfg.antialiasSamples) + " samples per edge pixel" : "off")
+              << "\n"
               << "  Output     : " << cfg.outputPath << "\n";
+    if (!cfg.fieldPath.empty()) {
+        std::cout << "  Field      : " << cfg.fieldPath << (cfg.fieldCompress ? " (zlib chunks)" : " (raw)") << "\n";
+    }
+    if (!cfg.recolorFile.empty()) {
+        std::cout << "  Recolor    : " << cfg.recolorFile << "\n";
+    }
 }
 
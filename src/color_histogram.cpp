@@ -0,0 +1,210 @@
+// ColorHistogram implementation - per-thread histograms and the CDF scan.
+
+#include "color_histogram.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "constants.h"
+#include "parallel_for.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+// Counts are stored value >> shift (shift = fraction bits for packed words).
+template <typename Count>
+int countAt(const Count* counts, size_t i, int shift) {
+    return static_cast<int>(static_cast<int64_t>(counts[i]) >> shift);
+}
+
+// Pixel blocks of at least Histogram::MIN_BLOCK_PIXELS, one per worker.
+int blockCount(size_t pixelCount, int threadCount) {
+    const size_t maxBlocks = std::max<size_t>(1, pixelCount / Histogram::MIN_BLOCK_PIXELS);
+    return static_cast<int>(std::min<size_t>(resolveThreadCount(threadCount), maxBlocks));
+}
+
+// Each block's histogram grows to the highest escape count it sees, so bins
+// follow the frame rather than maxIterations; in-set pixels are tallied apart.
+template <typename Count>
+std::vector<uint32_t> buildHistogram(const Count* counts, size_t pixelCount, int shift,
+                                     int maxIterations, int threadCount) {
+    const int blocks = blockCount(pixelCount, threadCount);
+    const size_t blockPixels = (pixelCount + blocks - 1) / blocks;
+
+    std::vector<std::vector<uint32_t>> partial(static_cast<size_t>(blocks));
+    std::vector<uint64_t> inside(static_cast<size_t>(blocks), 0);
+    parallelForDynamic(blocks, 1, threadCount, [&](int begin, int end) {
+        for (int b = begin; b < end; ++b) {
+            std::vector<uint32_t>& hist = partial[static_cast<size_t>(b)];
+            uint64_t in = 0;
+            const size_t first = static_cast<size_t>(b) * blockPixels;
+            const size_t last = std::min(pixelCount, first + blockPixels);
+            for (size_t i = first; i < last; ++i) {
+                const int iter = std::max(countAt(counts, i, shift), 0);
+                if (iter >= maxIterations) {
+                    ++in;
+                    continue;
+                }
+                if (static_cast<size_t>(iter) >= hist.size()) {
+                    hist.resize(static_cast<size_t>(iter) + 1, 0);
+                }
+                ++hist[static_cast<size_t>(iter)];
+            }
+            inside[static_cast<size_t>(b)] = in;
+        }
+    });
+
+    size_t escapeBins = 1;
+    uint64_t inSet = 0;
+    for (int b = 0; b < blocks; ++b) {
+        escapeBins = std::max(escapeBins, partial[static_cast<size_t>(b)].size());
+        inSet += inside[static_cast<size_t>(b)];
+    }
+    std::vector<uint32_t> merged(escapeBins + 1, 0);
+    merged[escapeBins] = static_cast<uint32_t>(inSet);
+    parallelForDynamic(static_cast<int>(escapeBins), Histogram::MERGE_BINS_PER_TASK, threadCount,
+                       [&](int begin, int end) {
+        for (const std::vector<uint32_t>& hist : partial) {
+            const int stop = std::min(end, static_cast<int>(hist.size()));
+            for (int i = begin; i < stop; ++i) {
+                merged[static_cast<size_t>(i)] += hist[static_cast<size_t>(i)];
+            }
+        }
+    });
+    return merged;
+}
+
+// Escape counts sorted block by block, then merged pairwise.
+template <typename Count>
+std::vector<int> sortEscapes(const Count* counts, size_t pixelCount, int shift, int maxIterations,
+                             int threadCount) {
+    const int blocks = blockCount(pixelCount, threadCount);
+    const size_t blockPixels = (pixelCount + blocks - 1) / blocks;
+
+    std::vector<std::vector<int>> partial(static_cast<size_t>(blocks));
+    parallelForDynamic(blocks, 1, threadCount, [&](int begin, int end) {
+        for (int b = begin; b < end; ++b) {
+            std::vector<int>& escapes = partial[static_cast<size_t>(b)];
+            const size_t first = static_cast<size_t>(b) * blockPixels;
+            const size_t last = std::min(pixelCount, first + blockPixels);
+            for (size_t i = first; i < last; ++i) {
+                const int iter = std::max(countAt(counts, i, shift), 0);
+                if (iter < maxIterations) {
+                    escapes.push_back(iter);
+                }
+            }
+            std::sort(escapes.begin(), escapes.end());
+        }
+    });
+
+    std::vector<int> sorted;
+    std::vector<size_t> bounds = {0};
+    for (const std::vector<int>& escapes : partial) {
+        sorted.insert(sorted.end(), escapes.begin(), escapes.end());
+        bounds.push_back(sorted.size());
+    }
+    partial.clear();
+    while (bounds.size() > 2) {
+        const int pairs = static_cast<int>((bounds.size() - 1) / 2);
+        parallelForDynamic(pairs, 1, threadCount, [&](int begin, int end) {
+            for (int pair = begin; pair < end; ++pair) {
+                const size_t b = static_cast<size_t>(pair) * 2;
+                std::inplace_merge(sorted.begin() + static_cast<std::ptrdiff_t>(bounds[b]),
+                                   sorted.begin() + static_cast<std::ptrdiff_t>(bounds[b + 1]),
+                                   sorted.begin() + static_cast<std::ptrdiff_t>(bounds[b + 2]));
+            }
+        });
+        std::vector<size_t> merged;
+        for (size_t b = 0; b < bounds.size(); b += 2) {
+            merged.push_back(bounds[b]);
+        }
+        if (merged.back() != bounds.back()) {
+            merged.push_back(bounds.back());
+        }
+        bounds = std::move(merged);
+    }
+    return sorted;
+}
+
+} // namespace
+
+std::vector<uint32_t> ColorHistogram::build(const IterationFrame& frame, int maxIterations, int threadCount) {
+    maxIterations = std::max(1, maxIterations);
+    switch (frame.format) {
+        case IterationFormat::U8:
+            return buildHistogram(static_cast<const uint8_t*>(frame.data), frame.pixelCount, 0,
+                                  maxIterations, threadCount);
+        case IterationFormat::U16:
+            return buildHistogram(static_cast<const uint16_t*>(frame.data), frame.pixelCount, 0,
+                                  maxIterations, threadCount);
+        case IterationFormat::U32:
+            return buildHistogram(static_cast<const int*>(frame.data), frame.pixelCount, 0,
+                                  maxIterations, threadCount);
+        case IterationFormat::Packed:
+            return buildHistogram(static_cast<const uint32_t*>(frame.data), frame.pixelCount,
+                                  IterationStorage::PACKED_FRACTION_BITS, maxIterations, threadCount);
+    }
+    throw std::runtime_error("Unknown iteration format");
+}
+
+bool ColorHistogram::sortsCounts(size_t pixelCount, int maxIterations) {
+    return static_cast<uint64_t>(maxIterations) > pixelCount;
+}
+
+std::vector<int> ColorHistogram::sortedEscapes(const IterationFrame& frame, int maxIterations, int threadCount) {
+    maxIterations = std::max(1, maxIterations);
+    switch (frame.format) {
+        case IterationFormat::U8:
+            return sortEscapes(static_cast<const uint8_t*>(frame.data), frame.pixelCount, 0,
+                               maxIterations, threadCount);
+        case IterationFormat::U16:
+            return sortEscapes(static_cast<const uint16_t*>(frame.data), frame.pixelCount, 0,
+                               maxIterations, threadCount);
+        case IterationFormat::U32:
+            return sortEscapes(static_cast<const int*>(frame.data), frame.pixelCount, 0,
+                               maxIterations, threadCount);
+        case IterationFormat::Packed:
+            return sortEscapes(static_cast<const uint32_t*>(frame.data), frame.pixelCount,
+                               IterationStorage::PACKED_FRACTION_BITS, maxIterations, threadCount);
+    }
+    throw std::runtime_error("Unknown iteration format");
+}
+
+float ColorHistogram::sortedPosition(const std::vector<int>& sorted, int iter) {
+    if (sorted.empty()) {
+        return 0.0f;
+    }
+    const size_t below = static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), iter) - sorted.begin());
+    // Same rounding as equalizedPositions, so both forms color alike.
+    return static_cast<float>(static_cast<double>(below) * (1.0 / static_cast<double>(sorted.size())));
+}
+
+std::vector<float> ColorHistogram::equalizedPositions(const std::vector<uint32_t>& histogram, int threadCount) {
+    if (histogram.size() < 2) {
+        throw std::runtime_error("Histogram needs at least one escape bin");
+    }
+    const size_t escapeBins = histogram.size() - 1;  // The last bin is the in-set color.
+    std::vector<uint64_t> cdf(histogram.begin(), histogram.begin() + static_cast<std::ptrdiff_t>(escapeBins));
+    parallelInclusiveScan(cdf, threadCount);
+
+    std::vector<float> positions(escapeBins);
+    const uint64_t escaped = cdf.back();
+    if (escaped == 0) {
+        for (size_t i = 0; i < escapeBins; ++i) {
+            positions[i] = static_cast<float>(i) / static_cast<float>(escapeBins);
+        }
+        return positions;
+    }
+    // Exclusive CDF: the share of escaped pixels strictly below count i, so
+    // positions stay in [0, 1) like iter / maxIterations.
+    const double scale = 1.0 / static_cast<double>(escaped);
+    parallelForDynamic(static_cast<int>(escapeBins), Histogram::MERGE_BINS_PER_TASK, threadCount,
+                       [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const size_t b = static_cast<size_t>(i);
+            positions[b] = static_cast<float>(static_cast<double>(cdf[b] - histogram[b]) * scale);
+        }
+    });
+    return positions;
+}
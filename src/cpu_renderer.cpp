@@ -0,0 +1,436 @@
+// CpuRenderer implementation - scalar, AVX2 and AVX-512 row loops spread
+// across worker threads. The math follows kernels/mandelbrot.cl step for step
+// (same float operations in the same order) so both backends agree.
+
+#include "cpu_renderer.h"
+
+#include <algorithm>
+
+#include "constants.h"
+#include "interior_check.h"
+#include "parallel_for.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FRACTAL_CPU_X86 1
+#include <immintrin.h>
+#else
+#define FRACTAL_CPU_X86 0
+#endif
+
+namespace {
+
+using namespace FractalConstants;
+
+// Render parameters narrowed to the float values the OpenCL kernel sees.
+struct ViewParams {
+    int width;
+    int height;
+    float centerX;
+    float centerY;
+    float zoom;
+    int maxIterations;
+    float juliaRe;
+    float juliaImag;
+    bool juliaMode;
+    int interior;  // Interior::*_FLAG bits.
+};
+
+ViewParams makeViewParams(const RenderConfig& cfg) {
+    ViewParams v{};
+    v.width = cfg.width;
+    v.height = cfg.height;
+    v.centerX = static_cast<float>(cfg.centerX);
+    v.centerY = static_cast<float>(cfg.centerY);
+    v.zoom = static_cast<float>(cfg.zoom);
+    v.maxIterations = cfg.maxIterations;
+    v.juliaRe = static_cast<float>(cfg.juliaReal);
+    v.juliaImag = static_cast<float>(cfg.juliaImag);
+    v.juliaMode = (cfg.fractalType == "julia");
+    v.interior = interiorCheckFlags(interiorCheckFromName(cfg.interior));
+    return v;
+}
+
+// Pixel coordinates may be fractional (anti-aliasing subsamples); whole
+// pixels convert exactly, as (float)gx does in the kernel.
+float mapRow(const ViewParams& v, float gy) {
+    return (gy / (float)v.height - Kernel::PIXEL_OFFSET) * Kernel::VIEWPORT_SCALE_Y / v.zoom + v.centerY;
+}
+
+float mapColumn(const ViewParams& v, float gx) {
+    return (gx / (float)v.width - Kernel::PIXEL_OFFSET) * Kernel::VIEWPORT_SCALE_X / v.zoom + v.centerX;
+}
+
+// Main cardioid or period-2 bulb (c is in the set).
+bool inCardioidOrBulb(float cx, float cy) {
+    const float xq = cx - 0.25f;
+    const float y2 = cy * cy;
+    const float q = xq * xq + y2;
+    const float xb = cx + 1.0f;
+    return q * (q + xq) <= 0.25f * y2 || xb * xb + y2 <= 0.0625f;
+}
+
+int iteratePixel(const ViewParams& v, float px, float py) {
+    float x = v.juliaMode ? px : 0.0f;
+    float y = v.juliaMode ? py : 0.0f;
+    const float cx = v.juliaMode ? v.juliaRe : px;
+    const float cy = v.juliaMode ? v.juliaImag : py;
+
+    if (!v.juliaMode && (v.interior & Interior::BULB_FLAG) && inCardioidOrBulb(cx, cy)) {
+        return v.maxIterations;
+    }
+    const bool periodicity = (v.interior & Interior::PERIODICITY_FLAG) != 0;
+    float savedX = x;
+    float savedY = y;
+    int window = Interior::PERIOD_WINDOW_START;
+    int step = 0;
+
+    int iter = 0;
+    while (x * x + y * y <= Kernel::ESCAPE_RADIUS_SQUARED && iter < v.maxIterations) {
+        const float xtemp = x * x - y * y + cx;
+        y = Kernel::JULIA_MULTIPLIER * x * y + cy;
+        x = xtemp;
+        ++iter;
+        if (periodicity) {
+            if (x == savedX && y == savedY) {
+                return v.maxIterations;  // Cycle: the orbit never escapes.
+            }
+            if (++step == window) {
+                savedX = x;
+                savedY = y;
+                step = 0;
+                window *= 2;
+            }
+        }
+    }
+    return iter;
+}
+
+void iterateRowScalar(const ViewParams& v, int gy, int* out) {
+    const float py = mapRow(v, static_cast<float>(gy));
+    for (int gx = 0; gx < v.width; ++gx) {
+        out[gx] = iteratePixel(v, mapColumn(v, static_cast<float>(gx)), py);
+    }
+}
+
+// Scattered pixels: points holds (x, y) pairs, whole pixels (int) or
+// sub-pixel positions (float).
+template <typename Coord>
+void iteratePointsScalar(const ViewParams& v, const Coord* points, size_t count, int* out) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = iteratePixel(v, mapColumn(v, static_cast<float>(points[2 * i])),
+                              mapRow(v, static_cast<float>(points[2 * i + 1])));
+    }
+}
+
+#if FRACTAL_CPU_X86
+
+alignas(64) const float kLaneOffsets[Cpu::AVX512_LANES] = {
+    0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+    8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f
+};
+
+// Map up to lanes scattered pixels into px/py lane arrays. Missing lanes
+// repeat the last pixel so every lane iterates a real point.
+template <typename Coord>
+void mapPointLanes(const ViewParams& v, const Coord* points, size_t count, int lanes, float* px, float* py) {
+    for (int l = 0; l < lanes; ++l) {
+        const size_t i = std::min(static_cast<size_t>(l), count - 1);
+        px[l] = mapColumn(v, static_cast<float>(points[2 * i]));
+        py[l] = mapRow(v, static_cast<float>(points[2 * i + 1]));
+    }
+}
+
+// Escaped lanes are frozen with a blend so their counts match the scalar loop
+// exactly; the group exits once every lane has escaped.
+// Interior shortcuts retire lanes through the inside mask: those lanes stop
+// counting and report maxIterations, as the scalar loop does.
+__attribute__((target("avx2")))
+__m256i iterateLanesAvx2(const ViewParams& v, __m256 px, __m256 py) {
+    const __m256 escapeV = _mm256_set1_ps(Kernel::ESCAPE_RADIUS_SQUARED);
+    const __m256 multV = _mm256_set1_ps(Kernel::JULIA_MULTIPLIER);
+
+    __m256 x = v.juliaMode ? px : _mm256_setzero_ps();
+    __m256 y = v.juliaMode ? py : _mm256_setzero_ps();
+    const __m256 cx = v.juliaMode ? _mm256_set1_ps(v.juliaRe) : px;
+    const __m256 cy = v.juliaMode ? _mm256_set1_ps(v.juliaImag) : py;
+
+    __m256 inside = _mm256_setzero_ps();
+    if (!v.juliaMode && (v.interior & Interior::BULB_FLAG)) {
+        const __m256 xq = _mm256_sub_ps(cx, _mm256_set1_ps(0.25f));
+        const __m256 y2 = _mm256_mul_ps(cy, cy);
+        const __m256 q = _mm256_add_ps(_mm256_mul_ps(xq, xq), y2);
+        const __m256 xb = _mm256_add_ps(cx, _mm256_set1_ps(1.0f));
+        inside = _mm256_or_ps(
+            _mm256_cmp_ps(_mm256_mul_ps(q, _mm256_add_ps(q, xq)), _mm256_mul_ps(_mm256_set1_ps(0.25f), y2), _CMP_LE_OQ),
+            _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(xb, xb), y2), _mm256_set1_ps(0.0625f), _CMP_LE_OQ));
+    }
+    const bool periodicity = (v.interior & Interior::PERIODICITY_FLAG) != 0;
+    __m256 savedX = x;
+    __m256 savedY = y;
+    int window = Interior::PERIOD_WINDOW_START;
+    int step = 0;
+
+    __m256i iters = _mm256_setzero_si256();
+    for (int i = 0; i < v.maxIterations; ++i) {
+        const __m256 x2 = _mm256_mul_ps(x, x);
+        const __m256 y2 = _mm256_mul_ps(y, y);
+        const __m256 active = _mm256_andnot_ps(inside, _mm256_cmp_ps(_mm256_add_ps(x2, y2), escapeV, _CMP_LE_OQ));
+        if (_mm256_movemask_ps(active) == 0) {
+            break;
+        }
+        // Active lanes are all-ones (-1): subtracting increments them.
+        iters = _mm256_sub_epi32(iters, _mm256_castps_si256(active));
+        const __m256 nx = _mm256_add_ps(_mm256_sub_ps(x2, y2), cx);
+        const __m256 ny = _mm256_add_ps(_mm256_mul_ps(multV, _mm256_mul_ps(x, y)), cy);
+        x = _mm256_blendv_ps(x, nx, active);
+        y = _mm256_blendv_ps(y, ny, active);
+        if (periodicity) {
+            const __m256 repeat = _mm256_and_ps(_mm256_cmp_ps(x, savedX, _CMP_EQ_OQ), _mm256_cmp_ps(y, savedY, _CMP_EQ_OQ));
+            inside = _mm256_or_ps(inside, _mm256_and_ps(active, repeat));
+            if (++step == window) {
+                savedX = x;
+                savedY = y;
+                step = 0;
+                window *= 2;
+            }
+        }
+    }
+    return _mm256_blendv_epi8(iters, _mm256_set1_epi32(v.maxIterations), _mm256_castps_si256(inside));
+}
+
+__attribute__((target("avx2")))
+void iterateRowAvx2(const ViewParams& v, int gy, int* out) {
+    const __m256 lanes = _mm256_load_ps(kLaneOffsets);
+    const __m256 widthV = _mm256_set1_ps((float)v.width);
+    const __m256 offsetV = _mm256_set1_ps(Kernel::PIXEL_OFFSET);
+    const __m256 scaleXV = _mm256_set1_ps(Kernel::VIEWPORT_SCALE_X);
+    const __m256 zoomV = _mm256_set1_ps(v.zoom);
+    const __m256 centerXV = _mm256_set1_ps(v.centerX);
+    const __m256 pyV = _mm256_set1_ps(mapRow(v, static_cast<float>(gy)));
+
+    alignas(32) int lanesOut[Cpu::AVX2_LANES];
+    for (int gx0 = 0; gx0 < v.width; gx0 += Cpu::AVX2_LANES) {
+        const __m256 gx = _mm256_add_ps(_mm256_set1_ps((float)gx0), lanes);
+        const __m256 px = _mm256_add_ps(
+            _mm256_div_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_div_ps(gx, widthV), offsetV), scaleXV), zoomV),
+            centerXV);
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanesOut), iterateLanesAvx2(v, px, pyV));
+        const int count = std::min(Cpu::AVX2_LANES, v.width - gx0);
+        std::copy(lanesOut, lanesOut + count, out + gx0);
+    }
+}
+
+template <typename Coord>
+__attribute__((target("avx2")))
+void iteratePointsAvx2(const ViewParams& v, const Coord* points, size_t count, int* out) {
+    alignas(32) float px[Cpu::AVX2_LANES];
+    alignas(32) float py[Cpu::AVX2_LANES];
+    alignas(32) int lanesOut[Cpu::AVX2_LANES];
+    for (size_t i = 0; i < count; i += Cpu::AVX2_LANES) {
+        const size_t n = std::min<size_t>(Cpu::AVX2_LANES, count - i);
+        mapPointLanes(v, points + 2 * i, n, Cpu::AVX2_LANES, px, py);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanesOut),
+                           iterateLanesAvx2(v, _mm256_load_ps(px), _mm256_load_ps(py)));
+        std::copy(lanesOut, lanesOut + n, out + i);
+    }
+}
+
+__attribute__((target("avx512f")))
+__m512i iterateLanesAvx512(const ViewParams& v, __m512 px, __m512 py) {
+    const __m512 escapeV = _mm512_set1_ps(Kernel::ESCAPE_RADIUS_SQUARED);
+    const __m512 multV = _mm512_set1_ps(Kernel::JULIA_MULTIPLIER);
+    const __m512i oneV = _mm512_set1_epi32(1);
+
+    __m512 x = v.juliaMode ? px : _mm512_setzero_ps();
+    __m512 y = v.juliaMode ? py : _mm512_setzero_ps();
+    const __m512 cx = v.juliaMode ? _mm512_set1_ps(v.juliaRe) : px;
+    const __m512 cy = v.juliaMode ? _mm512_set1_ps(v.juliaImag) : py;
+
+    __mmask16 inside = 0;
+    if (!v.juliaMode && (v.interior & Interior::BULB_FLAG)) {
+        const __m512 xq = _mm512_sub_ps(cx, _mm512_set1_ps(0.25f));
+        const __m512 y2 = _mm512_mul_ps(cy, cy);
+        const __m512 q = _mm512_add_ps(_mm512_mul_ps(xq, xq), y2);
+        const __m512 xb = _mm512_add_ps(cx, _mm512_set1_ps(1.0f));
+        inside = _mm512_cmp_ps_mask(_mm512_mul_ps(q, _mm512_add_ps(q, xq)), _mm512_mul_ps(_mm512_set1_ps(0.25f), y2), _CMP_LE_OQ) |
+                 _mm512_cmp_ps_mask(_mm512_add_ps(_mm512_mul_ps(xb, xb), y2), _mm512_set1_ps(0.0625f), _CMP_LE_OQ);
+    }
+    const bool periodicity = (v.interior & Interior::PERIODICITY_FLAG) != 0;
+    __m512 savedX = x;
+    __m512 savedY = y;
+    int window = Interior::PERIOD_WINDOW_START;
+    int step = 0;
+
+    __m512i iters = _mm512_setzero_si512();
+    for (int i = 0; i < v.maxIterations; ++i) {
+        const __m512 x2 = _mm512_mul_ps(x, x);
+        const __m512 y2 = _mm512_mul_ps(y, y);
+        const __mmask16 active = _mm512_cmp_ps_mask(_mm512_add_ps(x2, y2), escapeV, _CMP_LE_OQ) & ~inside;
+        if (active == 0) {
+            break;
+        }
+        iters = _mm512_mask_add_epi32(iters, active, iters, oneV);
+        const __m512 nx = _mm512_add_ps(_mm512_sub_ps(x2, y2), cx);
+        const __m512 ny = _mm512_add_ps(_mm512_mul_ps(multV, _mm512_mul_ps(x, y)), cy);
+        x = _mm512_mask_blend_ps(active, x, nx);
+        y = _mm512_mask_blend_ps(active, y, ny);
+        if (periodicity) {
+            inside |= _mm512_mask_cmp_ps_mask(active, x, savedX, _CMP_EQ_OQ) &
+                      _mm512_cmp_ps_mask(y, savedY, _CMP_EQ_OQ);
+            if (++step == window) {
+                savedX = x;
+                savedY = y;
+                step = 0;
+                window *= 2;
+            }
+        }
+    }
+    return _mm512_mask_mov_epi32(iters, inside, _mm512_set1_epi32(v.maxIterations));
+}
+
+__attribute__((target("avx512f")))
+void iterateRowAvx512(const ViewParams& v, int gy, int* out) {
+    const __m512 lanes = _mm512_load_ps(kLaneOffsets);
+    const __m512 widthV = _mm512_set1_ps((float)v.width);
+    const __m512 offsetV = _mm512_set1_ps(Kernel::PIXEL_OFFSET);
+    const __m512 scaleXV = _mm512_set1_ps(Kernel::VIEWPORT_SCALE_X);
+    const __m512 zoomV = _mm512_set1_ps(v.zoom);
+    const __m512 centerXV = _mm512_set1_ps(v.centerX);
+    const __m512 pyV = _mm512_set1_ps(mapRow(v, static_cast<float>(gy)));
+
+    alignas(64) int lanesOut[Cpu::AVX512_LANES];
+    for (int gx0 = 0; gx0 < v.width; gx0 += Cpu::AVX512_LANES) {
+        const __m512 gx = _mm512_add_ps(_mm512_set1_ps((float)gx0), lanes);
+        const __m512 px = _mm512_add_ps(
+            _mm512_div_ps(_mm512_mul_ps(_mm512_sub_ps(_mm512_div_ps(gx, widthV), offsetV), scaleXV), zoomV),
+            centerXV);
+
+        _mm512_store_si512(lanesOut, iterateLanesAvx512(v, px, pyV));
+        const int count = std::min(Cpu::AVX512_LANES, v.width - gx0);
+        std::copy(lanesOut, lanesOut + count, out + gx0);
+    }
+}
+
+template <typename Coord>
+__attribute__((target("avx512f")))
+void iteratePointsAvx512(const ViewParams& v, const Coord* points, size_t count, int* out) {
+    alignas(64) float px[Cpu::AVX512_LANES];
+    alignas(64) float py[Cpu::AVX512_LANES];
+    alignas(64) int lanesOut[Cpu::AVX512_LANES];
+    for (size_t i = 0; i < count; i += Cpu::AVX512_LANES) {
+        const size_t n = std::min<size_t>(Cpu::AVX512_LANES, count - i);
+        mapPointLanes(v, points + 2 * i, n, Cpu::AVX512_LANES, px, py);
+        _mm512_store_si512(lanesOut, iterateLanesAvx512(v, _mm512_load_ps(px), _mm512_load_ps(py)));
+        std::copy(lanesOut, lanesOut + n, out + i);
+    }
+}
+
+#endif // FRACTAL_CPU_X86
+
+using RowFn = void (*)(const ViewParams&, int, int*);
+template <typename Coord>
+using PointsFn = void (*)(const ViewParams&, const Coord*, size_t, int*);
+
+RowFn rowFunctionFor(CpuIsa isa) {
+#if FRACTAL_CPU_X86
+    switch (isa) {
+        case CpuIsa::Avx512: return iterateRowAvx512;
+        case CpuIsa::Avx2: return iterateRowAvx2;
+        default: break;
+    }
+#else
+    (void)isa;
+#endif
+    return iterateRowScalar;
+}
+
+template <typename Coord>
+PointsFn<Coord> pointsFunctionFor(CpuIsa isa) {
+#if FRACTAL_CPU_X86
+    switch (isa) {
+        case CpuIsa::Avx512: return iteratePointsAvx512<Coord>;
+        case CpuIsa::Avx2: return iteratePointsAvx2<Coord>;
+        default: break;
+    }
+#else
+    (void)isa;
+#endif
+    return iteratePointsScalar<Coord>;
+}
+
+// Points spread over the workers in POINTS_PER_TASK chunks.
+template <typename Coord>
+void computePointList(const RenderConfig& cfg, CpuIsa isa, int threadCount,
+                      const Coord* points, size_t count, int* out) {
+    const ViewParams view = makeViewParams(cfg);
+    const PointsFn<Coord> pointsFn = pointsFunctionFor<Coord>(isa);
+    const int chunks = static_cast<int>((count + Cpu::POINTS_PER_TASK - 1) / Cpu::POINTS_PER_TASK);
+
+    parallelForDynamic(chunks, 1, threadCount, [&](int begin, int end) {
+        const size_t first = static_cast<size_t>(begin) * Cpu::POINTS_PER_TASK;
+        const size_t last = std::min(count, static_cast<size_t>(end) * Cpu::POINTS_PER_TASK);
+        pointsFn(view, points + 2 * first, last - first, out + first);
+    });
+}
+
+} // namespace
+
+CpuRenderer::CpuRenderer(int threadCount, CpuIsa isa)
+    : threadCount_(resolveThreadCount(threadCount))
+    , isa_(isa)
+{
+    // Never run an instruction set the CPU cannot execute (enum is ordered
+    // Scalar < Avx2 < Avx512).
+    const CpuIsa best = detectIsa();
+    if (isa_ == CpuIsa::Auto || static_cast<int>(isa_) > static_cast<int>(best)) {
+        isa_ = best;
+    }
+}
+
+CpuIsa CpuRenderer::detectIsa() {
+#if FRACTAL_CPU_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return CpuIsa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return CpuIsa::Avx2;
+    }
+#endif
+    return CpuIsa::Scalar;
+}
+
+std::string CpuRenderer::isaName(CpuIsa isa) {
+    switch (isa) {
+        case CpuIsa::Avx512: return "avx512";
+        case CpuIsa::Avx2: return "avx2";
+        case CpuIsa::Scalar: return "scalar";
+        case CpuIsa::Auto: break;
+    }
+    return "auto";
+}
+
+void CpuRenderer::computeIterations(const RenderConfig& cfg, int* out) const {
+    computeRows(cfg, 0, cfg.height, out);
+}
+
+void CpuRenderer::computeRows(const RenderConfig& cfg, int rowBegin, int rowEnd, int* out) const {
+    const ViewParams view = makeViewParams(cfg);
+    const RowFn rowFn = rowFunctionFor(isa_);
+
+    parallelForDynamic(rowEnd - rowBegin, Cpu::ROWS_PER_TASK, threadCount_,
+                       [&](int begin, int end) {
+        for (int r = begin; r < end; ++r) {
+            rowFn(view, rowBegin + r, out + static_cast<size_t>(r) * view.width);
+        }
+    });
+}
+
+void CpuRenderer::computePoints(const RenderConfig& cfg, const int* points, size_t count, int* out) const {
+    computePointList(cfg, isa_, threadCount_, points, count, out);
+}
+
+void CpuRenderer::computeSamples(const RenderConfig& cfg, const float* samples, size_t count, int* out) const {
+    computePointList(cfg, isa_, threadCount_, samples, count, out);
+}
@@ -3,13 +3,20 @@
 #include "device_manager.h"
 
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "constants.h"
+#include "trace.h"
 
 DeviceManager::DeviceManager() = default;
 
 DeviceManager::~DeviceManager() {
+    if (transferQueue_) {
+        clReleaseCommandQueue(transferQueue_);
+    }
     if (queue_) {
         clReleaseCommandQueue(queue_);
     }
@@ -18,11 +25,11 @@ DeviceManager::~DeviceManager() {
     }
 }
 
-void DeviceManager::initialize() {
-    cl_int err = CL_SUCCESS;
+namespace {
 
+std::vector<cl_platform_id> platformIds() {
     cl_uint numPlatforms = 0;
-    err = clGetPlatformIDs(0, nullptr, &numPlatforms);
+    cl_int err = clGetPlatformIDs(0, nullptr, &numPlatforms);
     if (err != CL_SUCCESS || numPlatforms == 0) {
         throw std::runtime_error("No OpenCL platforms found");
     }
@@ -32,10 +39,37 @@ void DeviceManager::initialize() {
     if (err != CL_SUCCESS) {
         throw std::runtime_error("Failed to get OpenCL platform IDs");
     }
+    return platforms;
+}
+
+} // namespace
+
+std::vector<cl_device_id> DeviceManager::enumerateDevices() {
+    std::vector<cl_device_id> all;
+    for (cl_platform_id platform : platformIds()) {
+        cl_uint numDevices = 0;
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 0, nullptr, &numDevices) != CL_SUCCESS || numDevices == 0) {
+            continue;
+        }
+        std::vector<cl_device_id> devices(numDevices);
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, numDevices, devices.data(), nullptr) == CL_SUCCESS) {
+            all.insert(all.end(), devices.begin(), devices.end());
+        }
+    }
+    return all;
+}
+
+void DeviceManager::initialize(bool preferCpu) {
+    Trace::Scope scope("Device init", "device");
+    cl_int err = CL_SUCCESS;
+    const std::vector<cl_platform_id> platforms = platformIds();
 
     // Pick the first platform with a GPU, otherwise fall back to CPU on the first platform.
     platform_ = platforms[0];
     cl_device_type desiredTypes[] = {CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_CPU};
+    if (preferCpu) {
+        std::swap(desiredTypes[0], desiredTypes[1]);
+    }
     cl_device_id chosenDevice = nullptr;
 
     for (cl_device_type type : desiredTypes) {
@@ -55,7 +89,13 @@ void DeviceManager::initialize() {
         throw std::runtime_error("No suitable OpenCL device found");
     }
 
-    device_ = chosenDevice;
+    initializeDevice(chosenDevice);
+}
+
+void DeviceManager::initializeDevice(cl_device_id device) {
+    cl_int err = CL_SUCCESS;
+    device_ = device;
+    clGetDeviceInfo(device_, CL_DEVICE_PLATFORM, sizeof(platform_), &platform_, nullptr);
 
     // Query name and vendor.
     char nameBuf[FractalConstants::Device::INFO_BUFFER_SIZE] = {};
@@ -65,6 +105,18 @@ void DeviceManager::initialize() {
     deviceName_ = nameBuf;
     deviceVendor_ = vendorBuf;
 
+    // Memory limits drive tile sizing for frames larger than one allocation.
+    clGetDeviceInfo(device_, CL_DEVICE_MAX_MEM_ALLOC_SIZE,
+                    sizeof(maxMemAllocSize_), &maxMemAllocSize_, nullptr);
+    clGetDeviceInfo(device_, CL_DEVICE_GLOBAL_MEM_SIZE,
+                    sizeof(globalMemSize_), &globalMemSize_, nullptr);
+    clGetDeviceInfo(device_, CL_DEVICE_LOCAL_MEM_SIZE,
+                    sizeof(localMemSize_), &localMemSize_, nullptr);
+    cl_bool unified = CL_FALSE;
+    clGetDeviceInfo(device_, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(unified), &unified, nullptr);
+    hostUnifiedMemory_ = unified == CL_TRUE;
+    supportsFp64_ = hasExtension(device_, "cl_khr_fp64");
+
     // Create context.
     context_ = clCreateContext(nullptr, 1, &device_, nullptr, nullptr, &err);
     if (err != CL_SUCCESS || !context_) {
@@ -76,6 +128,30 @@ void DeviceManager::initialize() {
     if (err != CL_SUCCESS || !queue_) {
         throw std::runtime_error("Failed to create OpenCL command queue");
     }
+
+    transferQueue_ = clCreateCommandQueue(context_, device_, CL_QUEUE_PROFILING_ENABLE, &err);
+    if (err != CL_SUCCESS || !transferQueue_) {
+        throw std::runtime_error("Failed to create OpenCL transfer queue");
+    }
+}
+
+bool DeviceManager::hasExtension(cl_device_id device, const std::string& extension) {
+    size_t size = 0;
+    if (clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, 0, nullptr, &size) != CL_SUCCESS || size == 0) {
+        return false;
+    }
+    std::string extensions(size, '\0');
+    clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, size, &extensions[0], nullptr);
+
+    // Space-separated list; match whole names only.
+    std::istringstream names(extensions.c_str());
+    std::string name;
+    while (names >> name) {
+        if (name == extension) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void DeviceManager::printDiagnostics() const {
@@ -93,6 +169,11 @@ void DeviceManager::printDiagnostics() const {
     std::cout << "[Device] Selected device: " << deviceName_ << " (" << deviceVendor_ << ")\n";
     std::cout << "[Device]  Max work-group size: " << wgSize << "\n";
     std::cout << "[Device]  Image support      : " << (imageSupport ? "yes" : "no") << "\n";
+    std::cout << "[Device]  Max alloc size     : " << (maxMemAllocSize_ >> 20) << " MiB\n";
+    std::cout << "[Device]  Global memory      : " << (globalMemSize_ >> 20) << " MiB\n";
+    std::cout << "[Device]  Local memory       : " << (localMemSize_ >> 10) << " KiB\n";
+    std::cout << "[Device]  Host-unified memory: " << (hostUnifiedMemory_ ? "yes" : "no") << "\n";
+    std::cout << "[Device]  Double precision   : " << (supportsFp64_ ? "yes" : "no") << "\n";
 }
 
 
@@ -0,0 +1,62 @@
+// DeviceSet implementation - per-device contexts and kernels.
+
+#include "device_set.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+void DeviceSet::initialize(const std::string& kernelsRoot, const std::string& cacheDirectory,
+                           DeviceManager& primary, KernelManager& primaryKernels) {
+    members_.clear();
+    ownedDevices_.clear();
+    ownedKernels_.clear();
+    for (cl_device_id id : DeviceManager::enumerateDevices()) {
+        if (id == primary.device()) {
+            members_.push_back({&primary, &primaryKernels});
+            continue;
+        }
+        auto device = std::make_unique<DeviceManager>();
+        auto kernels = std::make_unique<KernelManager>();
+        try {
+            device->initializeDevice(id);
+            kernels->initialize(kernelsRoot, device->context(), id, cacheDirectory);
+        } catch (const std::exception& ex) {
+            std::cout << "[Multi-device] Skipping " << device->deviceName() << ": " << ex.what() << "\n";
+            continue;
+        }
+        members_.push_back({device.get(), kernels.get()});
+        ownedDevices_.push_back(std::move(device));
+        ownedKernels_.push_back(std::move(kernels));
+    }
+    if (members_.empty()) {
+        throw std::runtime_error("No usable OpenCL device for multi-device rendering");
+    }
+}
+
+std::vector<PrecisionTier> DeviceSet::commonTiers() const {
+    std::vector<PrecisionTier> tiers;
+    if (members_.empty()) {
+        return tiers;
+    }
+    for (PrecisionTier tier : members_.front().kernels->availableTiers()) {
+        const bool everywhere = std::all_of(members_.begin(), members_.end(), [tier](const Member& m) {
+            const std::vector<PrecisionTier>& own = m.kernels->availableTiers();
+            return std::find(own.begin(), own.end(), tier) != own.end();
+        });
+        if (everywhere) {
+            tiers.push_back(tier);
+        }
+    }
+    return tiers;
+}
+
+void DeviceSet::printDiagnostics() const {
+    std::cout << "[Multi-device] " << members_.size() << " device(s):\n";
+    for (size_t i = 0; i < members_.size(); ++i) {
+        const DeviceManager& device = *members_[i].device;
+        std::cout << "[Multi-device]  " << i << ": " << device.deviceName() << " ("
+                  << (device.globalMemSize() >> 20) << " MiB, fp64 "
+                  << (device.supportsFp64() ? "yes" : "no") << ")\n";
+    }
+}
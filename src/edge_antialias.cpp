@@ -0,0 +1,148 @@
+// EdgeAntialias implementation - edge detection, jittered sample positions and
+// the per-pixel color resolve, batch by batch.
+
+#include "edge_antialias.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "constants.h"
+#include "parallel_for.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+// R2 sequence steps (1/g and 1/g^2 for the plastic number g): successive
+// points fill the unit square evenly for any sample count.
+constexpr double kR2StepX = 0.7548776662466927;
+constexpr double kR2StepY = 0.5698402909980532;
+
+// Integer hash (lowbias32) giving each pixel its own rotation of the pattern,
+// so neighbouring edge pixels do not share sample offsets.
+uint32_t hashPixel(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+double unitFraction(uint32_t bits) {
+    return static_cast<double>(bits) / 4294967296.0;
+}
+
+double wrap(double v) {
+    return v - static_cast<double>(static_cast<int64_t>(v));
+}
+
+} // namespace
+
+std::vector<uint32_t> EdgeAntialias::findEdges(const int* counts, int width, int height, int threadCount) {
+    const int blocks = (height + Antialias::ROWS_PER_TASK - 1) / Antialias::ROWS_PER_TASK;
+    std::vector<std::vector<uint32_t>> blockEdges(static_cast<size_t>(std::max(blocks, 0)));
+
+    parallelForDynamic(blocks, 1, threadCount, [&](int begin, int end) {
+        for (int b = begin; b < end; ++b) {
+            std::vector<uint32_t>& edges = blockEdges[static_cast<size_t>(b)];
+            const int rowEnd = std::min(height, (b + 1) * Antialias::ROWS_PER_TASK);
+            for (int y = b * Antialias::ROWS_PER_TASK; y < rowEnd; ++y) {
+                const int* row = counts + static_cast<size_t>(y) * width;
+                const int* above = y > 0 ? row - width : nullptr;
+                const int* below = y + 1 < height ? row + width : nullptr;
+                for (int x = 0; x < width; ++x) {
+                    const int c = row[x];
+                    if ((x > 0 && row[x - 1] != c) || (x + 1 < width && row[x + 1] != c) ||
+                        (above && above[x] != c) || (below && below[x] != c)) {
+                        edges.push_back(static_cast<uint32_t>(static_cast<size_t>(y) * width + x));
+                    }
+                }
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& edges : blockEdges) {
+        total += edges.size();
+    }
+    std::vector<uint32_t> all;
+    all.reserve(total);
+    for (const auto& edges : blockEdges) {
+        all.insert(all.end(), edges.begin(), edges.end());
+    }
+    return all;
+}
+
+void EdgeAntialias::samplePositions(const uint32_t* edges, size_t edgeCount, int width,
+                                    int samplesPerPixel, float* out) {
+    for (size_t e = 0; e < edgeCount; ++e) {
+        const uint32_t index = edges[e];
+        const uint32_t x = index % static_cast<uint32_t>(width);
+        const uint32_t y = index / static_cast<uint32_t>(width);
+        const uint32_t seed = hashPixel(index);
+        const double rotateX = unitFraction(seed);
+        const double rotateY = unitFraction(hashPixel(seed));
+
+        // The base sample sits at the pixel coordinate itself, so subsamples
+        // cover the footprint [-0.5, 0.5) around it.
+        float* s = out + e * static_cast<size_t>(samplesPerPixel) * 2;
+        for (int k = 1; k <= samplesPerPixel; ++k) {
+            s[0] = static_cast<float>(x + wrap(rotateX + k * kR2StepX) - 0.5);
+            s[1] = static_cast<float>(y + wrap(rotateY + k * kR2StepY) - 0.5);
+            s += 2;
+        }
+    }
+}
+
+EdgeAntialias::Stats EdgeAntialias::apply(const RenderConfig& cfg,
+                                          const int* counts,
+                                          const PaletteLut& lut,
+                                          unsigned char* rgb,
+                                          const EvaluateFn& evaluate,
+                                          size_t maxBatchSamples) {
+    const int samplesPerPixel = cfg.antialiasSamples;
+    if (samplesPerPixel < 1 || samplesPerPixel > Antialias::MAX_SAMPLES) {
+        throw std::runtime_error("Anti-aliasing needs 1.." + std::to_string(Antialias::MAX_SAMPLES) +
+                                 " samples per edge pixel");
+    }
+
+    Stats stats;
+    const std::vector<uint32_t> edges = findEdges(counts, cfg.width, cfg.height, cfg.threads);
+    stats.edgePixels = edges.size();
+
+    const size_t batchPixels = std::max<size_t>(1, maxBatchSamples / static_cast<size_t>(samplesPerPixel));
+    std::vector<float> samples;
+    std::vector<int> results;
+    const unsigned divisor = static_cast<unsigned>(samplesPerPixel) + 1;
+
+    for (size_t first = 0; first < edges.size(); first += batchPixels) {
+        const size_t pixels = std::min(batchPixels, edges.size() - first);
+        const size_t sampleCount = pixels * static_cast<size_t>(samplesPerPixel);
+        samples.resize(sampleCount * 2);
+        results.resize(sampleCount);
+        samplePositions(edges.data() + first, pixels, cfg.width, samplesPerPixel, samples.data());
+        evaluate(samples.data(), sampleCount, results.data());
+
+        for (size_t p = 0; p < pixels; ++p) {
+            const uint32_t index = edges[first + p];
+            unsigned char c[3];
+            lut.color(counts[index], c);
+            unsigned sum[3] = {c[0], c[1], c[2]};
+            const int* sampleCounts = results.data() + p * static_cast<size_t>(samplesPerPixel);
+            for (int k = 0; k < samplesPerPixel; ++k) {
+                lut.color(sampleCounts[k], c);
+                sum[0] += c[0];
+                sum[1] += c[1];
+                sum[2] += c[2];
+            }
+            unsigned char* out = rgb + static_cast<size_t>(index) * 3;
+            for (int ch = 0; ch < 3; ++ch) {
+                out[ch] = static_cast<unsigned char>((sum[ch] + divisor / 2) / divisor);
+            }
+        }
+        stats.samples += sampleCount;
+        ++stats.batches;
+    }
+    return stats;
+}
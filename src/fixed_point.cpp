@@ -0,0 +1,216 @@
+// FixedPoint implementation - schoolbook limb arithmetic.
+
+#include "fixed_point.h"
+
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+FixedPoint::FixedPoint(int fracLimbs)
+    : fracLimbs_(fracLimbs)
+    , limbs_(static_cast<size_t>(fracLimbs) + 1, 0)
+{
+}
+
+bool FixedPoint::isZero() const {
+    for (uint32_t limb : limbs_) {
+        if (limb != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+FixedPoint FixedPoint::fromDouble(double v, int fracLimbs) {
+    FixedPoint r(fracLimbs);
+    r.negative_ = v < 0.0;
+    double mag = std::fabs(v);
+    if (!(mag < 4294967296.0)) {
+        throw std::runtime_error("FixedPoint value out of range");
+    }
+    // Peel off 32 bits at a time from the top; exact because each step only
+    // removes already-represented bits.
+    double intPart = std::floor(mag);
+    r.limbs_[static_cast<size_t>(fracLimbs)] = static_cast<uint32_t>(intPart);
+    mag -= intPart;
+    for (int i = fracLimbs - 1; i >= 0 && mag > 0.0; --i) {
+        mag = std::ldexp(mag, 32);
+        intPart = std::floor(mag);
+        r.limbs_[static_cast<size_t>(i)] = static_cast<uint32_t>(intPart);
+        mag -= intPart;
+    }
+    if (r.isZero()) {
+        r.negative_ = false;
+    }
+    return r;
+}
+
+FixedPoint FixedPoint::fromString(const std::string& text, int fracLimbs) {
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+        negative = text[pos] == '-';
+        ++pos;
+    }
+
+    std::string digits;
+    int pointPos = -1;
+    for (; pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.'); ++pos) {
+        if (text[pos] == '.') {
+            if (pointPos >= 0) {
+                throw std::runtime_error("Malformed number: " + text);
+            }
+            pointPos = static_cast<int>(digits.size());
+        } else {
+            digits += text[pos];
+        }
+    }
+    if (digits.empty()) {
+        throw std::runtime_error("Malformed number: " + text);
+    }
+    if (pointPos < 0) {
+        pointPos = static_cast<int>(digits.size());
+    }
+    if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+        size_t used = 0;
+        const int exponent = std::stoi(text.substr(pos + 1), &used);
+        pos += 1 + used;
+        pointPos += exponent;
+    }
+    if (pos != text.size()) {
+        throw std::runtime_error("Malformed number: " + text);
+    }
+
+    // Normalize so the decimal point sits inside (or at the edges of) digits.
+    if (pointPos < 0) {
+        digits.insert(0, static_cast<size_t>(-pointPos), '0');
+        pointPos = 0;
+    }
+    if (pointPos > static_cast<int>(digits.size())) {
+        digits.append(static_cast<size_t>(pointPos) - digits.size(), '0');
+    }
+
+    FixedPoint r(fracLimbs);
+    // Fraction: fold digits from least significant, value = (value + d) / 10.
+    for (int i = static_cast<int>(digits.size()) - 1; i >= pointPos; --i) {
+        r.limbs_[static_cast<size_t>(fracLimbs)] += static_cast<uint32_t>(digits[static_cast<size_t>(i)] - '0');
+        r.divideBy(10);
+    }
+    uint64_t intPart = 0;
+    for (int i = 0; i < pointPos; ++i) {
+        intPart = intPart * 10 + static_cast<uint64_t>(digits[static_cast<size_t>(i)] - '0');
+        if (intPart > 0xFFFFFFFFull) {
+            throw std::runtime_error("FixedPoint value out of range: " + text);
+        }
+    }
+    r.limbs_[static_cast<size_t>(fracLimbs)] = static_cast<uint32_t>(intPart);
+    r.negative_ = negative && !r.isZero();
+    return r;
+}
+
+void FixedPoint::divideBy(uint32_t d) {
+    uint64_t rem = 0;
+    for (size_t i = limbs_.size(); i-- > 0;) {
+        const uint64_t cur = (rem << 32) | limbs_[i];
+        limbs_[i] = static_cast<uint32_t>(cur / d);
+        rem = cur % d;
+    }
+}
+
+double FixedPoint::toDouble() const {
+    double v = 0.0;
+    for (size_t i = limbs_.size(); i-- > 0;) {
+        v += std::ldexp(static_cast<double>(limbs_[i]), 32 * (static_cast<int>(i) - fracLimbs_));
+    }
+    return negative_ ? -v : v;
+}
+
+int FixedPoint::compareMagnitude(const FixedPoint& o) const {
+    for (size_t i = limbs_.size(); i-- > 0;) {
+        if (limbs_[i] != o.limbs_[i]) {
+            return limbs_[i] < o.limbs_[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+std::vector<uint32_t> FixedPoint::addMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::vector<uint32_t> r(a.size());
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const uint64_t sum = static_cast<uint64_t>(a[i]) + b[i] + carry;
+        r[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    return r;
+}
+
+std::vector<uint32_t> FixedPoint::subMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    // Requires |a| >= |b|.
+    std::vector<uint32_t> r(a.size());
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        int64_t diff = static_cast<int64_t>(a[i]) - b[i] - borrow;
+        borrow = diff < 0 ? 1 : 0;
+        if (diff < 0) {
+            diff += static_cast<int64_t>(1) << 32;
+        }
+        r[i] = static_cast<uint32_t>(diff);
+    }
+    return r;
+}
+
+FixedPoint FixedPoint::addSigned(const FixedPoint& o, bool negateOther) const {
+    if (o.fracLimbs_ != fracLimbs_) {
+        throw std::runtime_error("FixedPoint precision mismatch");
+    }
+    const bool otherNegative = o.negative_ != negateOther;
+    FixedPoint r(fracLimbs_);
+    if (negative_ == otherNegative) {
+        r.limbs_ = addMagnitude(limbs_, o.limbs_);
+        r.negative_ = negative_;
+    } else if (compareMagnitude(o) >= 0) {
+        r.limbs_ = subMagnitude(limbs_, o.limbs_);
+        r.negative_ = negative_;
+    } else {
+        r.limbs_ = subMagnitude(o.limbs_, limbs_);
+        r.negative_ = otherNegative;
+    }
+    if (r.isZero()) {
+        r.negative_ = false;
+    }
+    return r;
+}
+
+FixedPoint FixedPoint::operator+(const FixedPoint& o) const {
+    return addSigned(o, false);
+}
+
+FixedPoint FixedPoint::operator-(const FixedPoint& o) const {
+    return addSigned(o, true);
+}
+
+FixedPoint FixedPoint::operator*(const FixedPoint& o) const {
+    if (o.fracLimbs_ != fracLimbs_) {
+        throw std::runtime_error("FixedPoint precision mismatch");
+    }
+    const size_t n = limbs_.size();
+    std::vector<uint64_t> product(2 * n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < n; ++j) {
+            const uint64_t cur = product[i + j] + static_cast<uint64_t>(limbs_[i]) * o.limbs_[j] + carry;
+            product[i + j] = cur & 0xFFFFFFFFull;
+            carry = cur >> 32;
+        }
+        product[i + n] += carry;
+    }
+
+    // Drop fracLimbs low limbs (truncate); bits above the integer limb overflow.
+    FixedPoint r(fracLimbs_);
+    for (size_t i = 0; i < n; ++i) {
+        r.limbs_[i] = static_cast<uint32_t>(product[i + static_cast<size_t>(fracLimbs_)]);
+    }
+    r.negative_ = (negative_ != o.negative_) && !r.isZero();
+    return r;
+}
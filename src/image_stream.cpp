@@ -0,0 +1,168 @@
+// ImageStreamWriter implementations - streaming PPM (P6) and PNG writers.
+
+#include "image_stream.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <zlib.h>
+
+namespace {
+
+constexpr int kBytesPerPixel = 3;
+constexpr size_t kIdatChunkBytes = 1 << 16;  // Deflate output per IDAT chunk.
+
+bool hasSuffix(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+class PpmStreamWriter : public ImageStreamWriter {
+public:
+    PpmStreamWriter(const std::string& path, int width, int height)
+        : out_(path, std::ios::binary)
+        , rowBytes_(static_cast<size_t>(width) * kBytesPerPixel)
+    {
+        if (!out_) {
+            throw std::runtime_error("Failed to open output image file: " + path);
+        }
+        out_ << "P6\n" << width << " " << height << "\n255\n";
+    }
+
+    void writeRows(const unsigned char* rgb, int rowCount) override {
+        out_.write(reinterpret_cast<const char*>(rgb),
+                   static_cast<std::streamsize>(rowBytes_ * static_cast<size_t>(rowCount)));
+        if (!out_) {
+            throw std::runtime_error("Failed while writing PPM image data");
+        }
+    }
+
+    void finish() override {
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error("Failed while writing PPM image data");
+        }
+    }
+
+private:
+    std::ofstream out_;
+    size_t rowBytes_;
+};
+
+// PNG writer: each row is filtered (PngEncoder::filterRow, adaptive by
+// default) and fed to deflate; IDAT chunks are emitted whenever the output
+// buffer fills.
+class PngStreamWriter : public ImageStreamWriter {
+public:
+    PngStreamWriter(const std::string& path, int width, int height, const PngOptions& png)
+        : out_(path, std::ios::binary)
+        , filter_(png.filter)
+        , rowBytes_(static_cast<size_t>(width) * kBytesPerPixel)
+        , prevRow_(rowBytes_, 0)
+        , filtered_(1 + rowBytes_)
+        , candidate_(1 + rowBytes_)
+        , zbuf_(kIdatChunkBytes)
+    {
+        if (!out_) {
+            throw std::runtime_error("Failed to open output image file: " + path);
+        }
+        if (deflateInit(&zs_, png.level) != Z_OK) {
+            throw std::runtime_error("Failed to initialize PNG deflate stream");
+        }
+        zsOpen_ = true;
+        zs_.next_out = zbuf_.data();
+        zs_.avail_out = static_cast<uInt>(zbuf_.size());
+
+        PngEncoder::appendHeader(chunk_, width, height);
+        writePending();
+    }
+
+    ~PngStreamWriter() override {
+        if (zsOpen_) {
+            deflateEnd(&zs_);
+        }
+    }
+
+    void writeRows(const unsigned char* rgb, int rowCount) override {
+        for (int r = 0; r < rowCount; ++r) {
+            const unsigned char* row = rgb + static_cast<size_t>(r) * rowBytes_;
+            PngEncoder::filterRow(filter_, row, prevRow_.data(), rowBytes_, filtered_.data(), candidate_.data());
+            deflateBytes(filtered_.data(), filtered_.size(), Z_NO_FLUSH);
+            prevRow_.assign(row, row + rowBytes_);
+        }
+    }
+
+    void finish() override {
+        deflateBytes(nullptr, 0, Z_FINISH);
+        flushIdat();
+        writeChunk("IEND", nullptr, 0);
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error("Failed while writing PNG image data");
+        }
+    }
+
+private:
+    // Chunks are framed by PngEncoder, so both PNG writers emit the same bytes.
+    void writeChunk(const char type[4], const unsigned char* data, size_t len) {
+        PngEncoder::appendChunk(chunk_, type, data, len);
+        writePending();
+    }
+
+    void writePending() {
+        out_.write(reinterpret_cast<const char*>(chunk_.data()), static_cast<std::streamsize>(chunk_.size()));
+        chunk_.clear();
+        if (!out_) {
+            throw std::runtime_error("Failed while writing PNG image data");
+        }
+    }
+
+    void flushIdat() {
+        const size_t used = zbuf_.size() - zs_.avail_out;
+        if (used > 0) {
+            writeChunk("IDAT", zbuf_.data(), used);
+        }
+        zs_.next_out = zbuf_.data();
+        zs_.avail_out = static_cast<uInt>(zbuf_.size());
+    }
+
+    void deflateBytes(unsigned char* data, size_t len, int flush) {
+        zs_.next_in = data;
+        zs_.avail_in = static_cast<uInt>(len);
+        for (;;) {
+            const int ret = deflate(&zs_, flush);
+            if (ret == Z_STREAM_ERROR) {
+                throw std::runtime_error("PNG deflate failed");
+            }
+            if (zs_.avail_out == 0) {
+                flushIdat();
+                continue;
+            }
+            if (flush == Z_FINISH ? ret == Z_STREAM_END : zs_.avail_in == 0) {
+                return;
+            }
+        }
+    }
+
+    std::ofstream out_;
+    PngFilter filter_;
+    size_t rowBytes_;
+    std::vector<unsigned char> prevRow_;
+    std::vector<unsigned char> filtered_;
+    std::vector<unsigned char> candidate_;
+    std::vector<unsigned char> zbuf_;
+    std::vector<unsigned char> chunk_;  // Framed chunk waiting to be written.
+    z_stream zs_{};
+    bool zsOpen_ = false;
+};
+
+} // namespace
+
+std::unique_ptr<ImageStreamWriter> ImageStreamWriter::open(const std::string& path, int width, int height,
+                                                           const PngOptions& png) {
+    if (hasSuffix(path, ".png")) {
+        return std::make_unique<PngStreamWriter>(path, width, height, png);
+    }
+    return std::make_unique<PpmStreamWriter>(path, width, height);
+}
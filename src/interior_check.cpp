@@ -0,0 +1,38 @@
+// InteriorCheck implementation - names and kernel flag bits.
+
+#include "interior_check.h"
+
+#include <stdexcept>
+
+#include "constants.h"
+
+std::string interiorCheckName(InteriorCheck check) {
+    switch (check) {
+        case InteriorCheck::None: return "none";
+        case InteriorCheck::Bulb: return "bulb";
+        case InteriorCheck::Periodicity: return "periodicity";
+        case InteriorCheck::All: return "all";
+    }
+    return "none";
+}
+
+InteriorCheck interiorCheckFromName(const std::string& name) {
+    for (InteriorCheck check : {InteriorCheck::None, InteriorCheck::Bulb,
+                                InteriorCheck::Periodicity, InteriorCheck::All}) {
+        if (interiorCheckName(check) == name) {
+            return check;
+        }
+    }
+    throw std::runtime_error("Unknown interior check: " + name);
+}
+
+int interiorCheckFlags(InteriorCheck check) {
+    using namespace FractalConstants;
+    switch (check) {
+        case InteriorCheck::None: return 0;
+        case InteriorCheck::Bulb: return Interior::BULB_FLAG;
+        case InteriorCheck::Periodicity: return Interior::PERIODICITY_FLAG;
+        case InteriorCheck::All: return Interior::BULB_FLAG | Interior::PERIODICITY_FLAG;
+    }
+    return 0;
+}
@@ -0,0 +1,355 @@
+// IterationField implementation - header encoding, shuffled zlib chunks and
+// the read-only mapping used by --recolor.
+
+#include "iteration_field.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#include "constants.h"
+#include "json_config.h"
+#include "parallel_for.h"
+#include "trace.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+constexpr char kMagic[8] = {'F', 'R', 'A', 'C', 'F', 'L', 'D', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kRaw = 0;
+constexpr uint32_t kZlibChunks = 1;
+// Magic and the fixed fields up to and including configBytes.
+constexpr size_t kFixedHeaderBytes = sizeof(kMagic) + 8 * 4 + 8 + 4;
+
+void putLittleEndian(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out += static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+}
+
+uint64_t readLittleEndian(const unsigned char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// The view as applyJsonConfig keys. Centers keep their decimal text when
+// they were given as such (deep zooms), otherwise round-trip as doubles.
+std::string viewJson(const RenderConfig& cfg, IterationFormat format) {
+    std::ostringstream out;
+    out << std::setprecision(17);
+    auto decimal = [](const std::string& text, double value) {
+        if (!text.empty()) {
+            return text;
+        }
+        std::ostringstream s;
+        s << std::setprecision(17) << value;
+        return s.str();
+    };
+    out << "{\"width\": " << cfg.width << ", \"height\": " << cfg.height
+        << ", \"maxIterations\": " << cfg.maxIterations
+        << ", \"fractalType\": " << jsonQuote(cfg.fractalType)
+        << ", \"centerX\": " << jsonQuote(decimal(cfg.centerXText, cfg.centerX))
+        << ", \"centerY\": " << jsonQuote(decimal(cfg.centerYText, cfg.centerY))
+        << ", \"zoom\": " << cfg.zoom << ", \"juliaReal\": " << cfg.juliaReal
+        << ", \"juliaImag\": " << cfg.juliaImag << ", \"precision\": " << jsonQuote(cfg.precision)
+        << ", \"interior\": " << jsonQuote(cfg.interior)
+        << ", \"iterationFormat\": " << jsonQuote(iterationFormatName(format))
+        << ", \"palette\": " << jsonQuote(cfg.palette) << ", \"paletteFile\": " << jsonQuote(cfg.paletteFile)
+        << ", \"coloring\": " << jsonQuote(cfg.coloring) << "}";
+    return out.str();
+}
+
+// Byte planes: out[b * count + i] = in[i * bytesPerPixel + b]. Counts change
+// slowly, so the high-byte planes become long runs zlib collapses.
+void shuffle(const unsigned char* in, size_t count, size_t bytesPerPixel, unsigned char* out) {
+    for (size_t b = 0; b < bytesPerPixel; ++b) {
+        unsigned char* plane = out + b * count;
+        for (size_t i = 0; i < count; ++i) {
+            plane[i] = in[i * bytesPerPixel + b];
+        }
+    }
+}
+
+void unshuffle(const unsigned char* in, size_t count, size_t bytesPerPixel, unsigned char* out) {
+    for (size_t b = 0; b < bytesPerPixel; ++b) {
+        const unsigned char* plane = in + b * count;
+        for (size_t i = 0; i < count; ++i) {
+            out[i * bytesPerPixel + b] = plane[i];
+        }
+    }
+}
+
+[[noreturn]] void malformed(const std::string& path, const std::string& what) {
+    throw std::runtime_error("Malformed iteration field " + path + " (" + what + ")");
+}
+
+} // namespace
+
+void IterationField::write(const std::string& path, const RenderConfig& cfg, const IterationFrame& frame,
+                           bool compress, int threadCount) {
+    Trace::Scope scope("Write field", "output");
+    const size_t bytesPerPixel = iterationFormatBytes(frame.format);
+    const size_t width = static_cast<size_t>(cfg.width);
+    const size_t height = static_cast<size_t>(cfg.height);
+    if (!frame.data || frame.pixelCount != width * height) {
+        throw std::runtime_error("Iteration field frame does not match " + std::to_string(cfg.width) + "x" +
+                                 std::to_string(cfg.height));
+    }
+    const size_t rowBytes = width * bytesPerPixel;
+    const size_t chunkRows = std::max<size_t>(1, std::min(height, Field::CHUNK_BYTES / rowBytes));
+    const int chunks = static_cast<int>((height + chunkRows - 1) / chunkRows);
+    const unsigned char* bytes = static_cast<const unsigned char*>(frame.data);
+
+    std::vector<std::vector<unsigned char>> packed;
+    uint64_t dataBytes = frame.pixelCount * bytesPerPixel;
+    if (compress) {
+        packed.resize(static_cast<size_t>(chunks));
+        std::atomic<bool> failed{false};
+        parallelForDynamic(chunks, 1, threadCount, [&](int begin, int end) {
+            std::vector<unsigned char> shuffled;
+            for (int c = begin; c < end; ++c) {
+                const size_t firstRow = static_cast<size_t>(c) * chunkRows;
+                const size_t count = std::min(chunkRows, height - firstRow) * width;
+                shuffled.resize(count * bytesPerPixel);
+                shuffle(bytes + firstRow * rowBytes, count, bytesPerPixel, shuffled.data());
+
+                std::vector<unsigned char>& out = packed[static_cast<size_t>(c)];
+                uLongf outBytes = compressBound(static_cast<uLong>(shuffled.size()));
+                out.resize(outBytes);
+                if (compress2(out.data(), &outBytes, shuffled.data(), static_cast<uLong>(shuffled.size()),
+                              Field::COMPRESS_LEVEL) != Z_OK) {
+                    failed = true;
+                }
+                out.resize(outBytes);
+            }
+        });
+        if (failed) {
+            throw std::runtime_error("Iteration field compression failed");
+        }
+        dataBytes = 0;
+        for (const auto& chunk : packed) {
+            dataBytes += chunk.size();
+        }
+    }
+
+    const std::string json = viewJson(cfg, frame.format);
+    const size_t tableBytes = compress ? packed.size() * 8 : 0;
+    const size_t dataOffset = (kFixedHeaderBytes + json.size() + tableBytes + Field::DATA_ALIGN_BYTES - 1) /
+                              Field::DATA_ALIGN_BYTES * Field::DATA_ALIGN_BYTES;
+
+    std::string header(kMagic, sizeof(kMagic));
+    putLittleEndian(header, kVersion, 4);
+    putLittleEndian(header, dataOffset, 4);
+    putLittleEndian(header, width, 4);
+    putLittleEndian(header, height, 4);
+    putLittleEndian(header, static_cast<uint32_t>(frame.format), 4);
+    putLittleEndian(header, bytesPerPixel, 4);
+    putLittleEndian(header, compress ? kZlibChunks : kRaw, 4);
+    putLittleEndian(header, chunkRows, 4);
+    putLittleEndian(header, dataBytes, 8);
+    putLittleEndian(header, json.size(), 4);
+    header += json;
+    for (const auto& chunk : packed) {
+        putLittleEndian(header, chunk.size(), 8);
+    }
+    header.resize(dataOffset, '\0');
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open iteration field file: " + path);
+    }
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    if (compress) {
+        for (const auto& chunk : packed) {
+            out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+        }
+    } else {
+        out.write(reinterpret_cast<const char*>(bytes), static_cast<std::streamsize>(dataBytes));
+    }
+    if (!out) {
+        throw std::runtime_error("Failed while writing iteration field " + path);
+    }
+}
+
+IterationField IterationField::open(const std::string& path, int threadCount) {
+    Trace::Scope scope("Load field", "output");
+    IterationField field;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open iteration field file: " + path);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kFixedHeaderBytes)) {
+        ::close(fd);
+        malformed(path, "shorter than its header");
+    }
+    field.mappingBytes_ = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, field.mappingBytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map iteration field file: " + path);
+    }
+    field.mapping_ = mapping;
+
+    const unsigned char* file = static_cast<const unsigned char*>(mapping);
+    const size_t fileBytes = field.mappingBytes_;
+    if (std::memcmp(file, kMagic, sizeof(kMagic)) != 0) {
+        malformed(path, "not an iteration field");
+    }
+    const unsigned char* p = file + sizeof(kMagic);
+    auto next = [&p](int bytes) {
+        const uint64_t v = readLittleEndian(p, bytes);
+        p += bytes;
+        return v;
+    };
+    const uint64_t version = next(4);
+    const uint64_t dataOffset = next(4);
+    const uint64_t width = next(4);
+    const uint64_t height = next(4);
+    const uint64_t formatCode = next(4);
+    const uint64_t bytesPerPixel = next(4);
+    const uint64_t compression = next(4);
+    const uint64_t chunkRows = next(4);
+    const uint64_t dataBytes = next(8);
+    const uint64_t configBytes = next(4);
+    if (version != kVersion) {
+        malformed(path, "version " + std::to_string(version));
+    }
+    if (formatCode > static_cast<uint64_t>(IterationFormat::Packed) ||
+        bytesPerPixel != iterationFormatBytes(static_cast<IterationFormat>(formatCode))) {
+        malformed(path, "unknown iteration format");
+    }
+    if (compression != kRaw && compression != kZlibChunks) {
+        malformed(path, "unknown compression");
+    }
+    if (width == 0 || height == 0 || chunkRows == 0) {
+        malformed(path, "empty frame");
+    }
+    // Width and height are 32-bit, so only the byte count can wrap.
+    const uint64_t pixelCount = width * height;
+    if (pixelCount > std::numeric_limits<size_t>::max() / bytesPerPixel) {
+        malformed(path, "frame too large");
+    }
+    const size_t chunks = static_cast<size_t>((height + chunkRows - 1) / chunkRows);
+    const uint64_t tableBytes = compression == kZlibChunks ? chunks * 8 : 0;
+    if (kFixedHeaderBytes + configBytes + tableBytes > dataOffset || dataOffset > fileBytes ||
+        dataBytes > fileBytes - dataOffset ||
+        (compression == kRaw && dataBytes != pixelCount * bytesPerPixel)) {
+        malformed(path, "truncated");
+    }
+
+    const std::string json(reinterpret_cast<const char*>(p), static_cast<size_t>(configBytes));
+    p += configBytes;
+    field.config_ = applyJsonConfig(parseJsonObject(json), RenderConfig{});
+    if (static_cast<uint64_t>(field.config_.width) != width ||
+        static_cast<uint64_t>(field.config_.height) != height) {
+        malformed(path, "view size does not match the data");
+    }
+    field.frame_.format = static_cast<IterationFormat>(formatCode);
+    field.frame_.pixelCount = static_cast<size_t>(pixelCount);
+
+    const unsigned char* data = file + dataOffset;
+    if (compression == kRaw) {
+        // Colored straight from the page cache; prefetch it for the workers.
+        madvise(const_cast<unsigned char*>(data), static_cast<size_t>(dataBytes), MADV_WILLNEED);
+        field.frame_.data = data;
+        return field;
+    }
+
+    std::vector<uint64_t> offsets(chunks + 1, 0);
+    for (size_t c = 0; c < chunks; ++c) {
+        // Checked against what is left, so a huge size cannot wrap the sum.
+        const uint64_t chunkBytes = next(8);
+        if (chunkBytes > dataBytes - offsets[c]) {
+            malformed(path, "chunk sizes do not add up");
+        }
+        offsets[c + 1] = offsets[c] + chunkBytes;
+    }
+    if (offsets[chunks] != dataBytes) {
+        malformed(path, "chunk sizes do not add up");
+    }
+    const size_t rowBytes = static_cast<size_t>(width * bytesPerPixel);
+    field.inflated_.resize(static_cast<size_t>(pixelCount * bytesPerPixel));
+    std::atomic<bool> failed{false};
+    parallelForDynamic(static_cast<int>(chunks), 1, threadCount, [&](int begin, int end) {
+        std::vector<unsigned char> shuffled;
+        for (int c = begin; c < end; ++c) {
+            const uint64_t firstRow = static_cast<uint64_t>(c) * chunkRows;
+            const size_t count = static_cast<size_t>(std::min(chunkRows, height - firstRow) * width);
+            shuffled.resize(count * bytesPerPixel);
+            uLongf outBytes = static_cast<uLongf>(shuffled.size());
+            const int ret = uncompress(shuffled.data(), &outBytes, data + offsets[c],
+                                       static_cast<uLong>(offsets[c + 1] - offsets[c]));
+            if (ret != Z_OK || outBytes != shuffled.size()) {
+                failed = true;
+                continue;
+            }
+            unshuffle(shuffled.data(), count, bytesPerPixel,
+                      field.inflated_.data() + static_cast<size_t>(firstRow) * rowBytes);
+        }
+    });
+    if (failed) {
+        malformed(path, "corrupt compressed data");
+    }
+    field.frame_.data = field.inflated_.data();
+    field.unmap();  // Everything needed has been copied out.
+    return field;
+}
+
+IterationField::IterationField(IterationField&& other) noexcept
+    : config_(std::move(other.config_))
+    , frame_(other.frame_)
+    , mapping_(std::exchange(other.mapping_, nullptr))
+    , mappingBytes_(std::exchange(other.mappingBytes_, 0))
+    , inflated_(std::move(other.inflated_)) {
+    if (!inflated_.empty()) {
+        frame_.data = inflated_.data();
+    }
+    other.frame_ = IterationFrame{};
+}
+
+IterationField& IterationField::operator=(IterationField&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        config_ = std::move(other.config_);
+        frame_ = other.frame_;
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mappingBytes_ = std::exchange(other.mappingBytes_, 0);
+        inflated_ = std::move(other.inflated_);
+        if (!inflated_.empty()) {
+            frame_.data = inflated_.data();
+        }
+        other.frame_ = IterationFrame{};
+    }
+    return *this;
+}
+
+IterationField::~IterationField() {
+    unmap();
+}
+
+void IterationField::unmap() {
+    if (mapping_) {
+        munmap(mapping_, mappingBytes_);
+        mapping_ = nullptr;
+    }
+}
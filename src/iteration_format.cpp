@@ -0,0 +1,66 @@
+// IterationFormat implementation - names, widths and automatic selection.
+
+#include "iteration_format.h"
+
+#include <limits>
+#include <stdexcept>
+
+#include "constants.h"
+
+std::string iterationFormatName(IterationFormat format) {
+    switch (format) {
+        case IterationFormat::U8: return "u8";
+        case IterationFormat::U16: return "u16";
+        case IterationFormat::U32: return "u32";
+        case IterationFormat::Packed: return "packed";
+    }
+    return "u32";
+}
+
+IterationFormat iterationFormatFromName(const std::string& name) {
+    for (IterationFormat format : {IterationFormat::U8, IterationFormat::U16,
+                                   IterationFormat::U32, IterationFormat::Packed}) {
+        if (iterationFormatName(format) == name) {
+            return format;
+        }
+    }
+    throw std::runtime_error("Unknown iteration format: " + name);
+}
+
+size_t iterationFormatBytes(IterationFormat format) {
+    switch (format) {
+        case IterationFormat::U8: return 1;
+        case IterationFormat::U16: return 2;
+        case IterationFormat::U32: return 4;
+        case IterationFormat::Packed: return 4;
+    }
+    return 4;
+}
+
+int iterationFormatMaxIterations(IterationFormat format) {
+    using namespace FractalConstants;
+    switch (format) {
+        case IterationFormat::U8: return IterationStorage::U8_MAX_ITERATIONS;
+        case IterationFormat::U16: return IterationStorage::U16_MAX_ITERATIONS;
+        case IterationFormat::U32: return std::numeric_limits<int>::max();
+        case IterationFormat::Packed: return IterationStorage::PACKED_MAX_ITERATIONS;
+    }
+    return std::numeric_limits<int>::max();
+}
+
+IterationFormat chooseIterationFormat(const RenderConfig& cfg) {
+    if (cfg.iterationFormat != "auto") {
+        const IterationFormat format = iterationFormatFromName(cfg.iterationFormat);
+        if (cfg.maxIterations > iterationFormatMaxIterations(format)) {
+            throw std::runtime_error("--iteration-format " + cfg.iterationFormat + " holds at most " +
+                                     std::to_string(iterationFormatMaxIterations(format)) + " iterations");
+        }
+        return format;
+    }
+    for (IterationFormat format : {IterationFormat::U8, IterationFormat::U16}) {
+        if (cfg.maxIterations <= iterationFormatMaxIterations(format)) {
+            return format;
+        }
+    }
+    return IterationFormat::U32;
+}
@@ -0,0 +1,340 @@
+// JSON helpers implementation - minimal flat-object parser for server requests.
+
+#include "json_config.h"
+
+#include <cctype>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "interior_check.h"
+#include "iteration_format.h"
+#include "palette.h"
+#include "png_encoder.h"
+#include "precision_tier.h"
+
+namespace {
+
+class FlatJsonParser {
+public:
+    explicit FlatJsonParser(const std::string& text) : s_(text) {}
+
+    JsonObject parse() {
+        JsonObject obj;
+        skipSpace();
+        expect('{');
+        skipSpace();
+        if (peek() == '}') {
+            ++pos_;
+        } else {
+            for (;;) {
+                skipSpace();
+                const std::string key = parseString();
+                skipSpace();
+                expect(':');
+                skipSpace();
+                obj[key] = parseScalar();
+                skipSpace();
+                if (peek() == ',') {
+                    ++pos_;
+                    continue;
+                }
+                expect('}');
+                break;
+            }
+        }
+        skipSpace();
+        if (pos_ != s_.size()) {
+            fail("trailing characters after object");
+        }
+        return obj;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("Malformed JSON request (" + what + " at offset " + std::to_string(pos_) + ")");
+    }
+
+    char peek() const { return pos_ < s_.size() ? s_[pos_] : '\0'; }
+
+    void expect(char c) {
+        if (peek() != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++pos_;
+    }
+
+    void skipSpace() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    JsonScalar parseScalar() {
+        JsonScalar v;
+        const char c = peek();
+        if (c == '"') {
+            v.type = JsonScalar::Type::String;
+            v.text = parseString();
+        } else if (c == '{' || c == '[') {
+            fail("nested values are not supported");
+        } else if (s_.compare(pos_, 4, "true") == 0 || s_.compare(pos_, 5, "false") == 0) {
+            v.type = JsonScalar::Type::Bool;
+            v.text = c == 't' ? "true" : "false";
+            pos_ += v.text.size();
+        } else if (s_.compare(pos_, 4, "null") == 0) {
+            pos_ += 4;
+        } else {
+            const size_t start = pos_;
+            while (pos_ < s_.size() && (std::isdigit(static_cast<unsigned char>(s_[pos_])) ||
+                                        s_[pos_] == '-' || s_[pos_] == '+' || s_[pos_] == '.' ||
+                                        s_[pos_] == 'e' || s_[pos_] == 'E')) {
+                ++pos_;
+            }
+            if (start == pos_) {
+                fail("expected a value");
+            }
+            v.type = JsonScalar::Type::Number;
+            v.text = s_.substr(start, pos_ - start);
+        }
+        return v;
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (pos_ < s_.size() && s_[pos_] != '"') {
+            char c = s_[pos_++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= s_.size()) {
+                break;
+            }
+            c = s_[pos_++];
+            switch (c) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': out += parseUnicodeEscape(); break;
+                default: out += c; break;  // \" \\ \/
+            }
+        }
+        expect('"');
+        return out;
+    }
+
+    // \uXXXX as UTF-8 (BMP only; surrogate pairs are not combined).
+    std::string parseUnicodeEscape() {
+        if (pos_ + 4 > s_.size()) {
+            fail("truncated \\u escape");
+        }
+        const unsigned code = static_cast<unsigned>(std::stoul(s_.substr(pos_, 4), nullptr, 16));
+        pos_ += 4;
+        std::string out;
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        return out;
+    }
+
+    const std::string& s_;
+    size_t pos_ = 0;
+};
+
+int asInt(const std::string& key, const JsonScalar& v) {
+    if (v.type != JsonScalar::Type::Number) {
+        throw std::runtime_error("Field '" + key + "' must be a number");
+    }
+    size_t used = 0;
+    long long n = 0;
+    try {
+        n = std::stoll(v.text, &used);
+    } catch (const std::out_of_range&) {
+        used = v.text.size();
+        n = std::numeric_limits<long long>::max();
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    // Fractions and exponents ("1.5", "1e3") are not integers.
+    if (used == 0 || used != v.text.size()) {
+        throw std::runtime_error("Field '" + key + "' must be an integer");
+    }
+    if (n < std::numeric_limits<int>::min() || n > std::numeric_limits<int>::max()) {
+        throw std::runtime_error("Field '" + key + "' is out of range");
+    }
+    return static_cast<int>(n);
+}
+
+double asDouble(const std::string& key, const JsonScalar& v) {
+    if (v.type != JsonScalar::Type::Number) {
+        throw std::runtime_error("Field '" + key + "' must be a number");
+    }
+    return std::stod(v.text);
+}
+
+// Decimal text of a number; strings are accepted too so deep-zoom centers can
+// carry more digits than a JSON number parser would keep.
+std::string asDecimal(const std::string& key, const JsonScalar& v) {
+    if (v.type != JsonScalar::Type::Number && v.type != JsonScalar::Type::String) {
+        throw std::runtime_error("Field '" + key + "' must be a number");
+    }
+    size_t used = 0;
+    try {
+        std::stod(v.text, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != v.text.size()) {
+        throw std::runtime_error("Field '" + key + "' must be a number");
+    }
+    return v.text;
+}
+
+bool asBool(const std::string& key, const JsonScalar& v) {
+    if (v.type != JsonScalar::Type::Bool) {
+        throw std::runtime_error("Field '" + key + "' must be true or false");
+    }
+    return v.text == "true";
+}
+
+std::string asString(const std::string& key, const JsonScalar& v) {
+    if (v.type != JsonScalar::Type::String) {
+        throw std::runtime_error("Field '" + key + "' must be a string");
+    }
+    return v.text;
+}
+
+} // namespace
+
+JsonObject parseJsonObject(const std::string& text) {
+    return FlatJsonParser(text).parse();
+}
+
+RenderConfig applyJsonConfig(const JsonObject& obj,
+                             RenderConfig base,
+                             const std::map<std::string, bool>& ignoredKeys) {
+    using Setter = std::function<void(RenderConfig&, const std::string&, const JsonScalar&)>;
+    static const std::map<std::string, Setter> setters = {
+        {"width", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.width = asInt(k, v); }},
+        {"height", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.height = asInt(k, v); }},
+        {"maxIterations", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.maxIterations = asInt(k, v); }},
+        {"fractalType", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.fractalType = asString(k, v); }},
+        {"centerX", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.centerXText = asDecimal(k, v); c.centerX = std::stod(c.centerXText); }},
+        {"centerY", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.centerYText = asDecimal(k, v); c.centerY = std::stod(c.centerYText); }},
+        {"zoom", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.zoom = asDouble(k, v); }},
+        {"juliaReal", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.juliaReal = asDouble(k, v); }},
+        {"juliaImag", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.juliaImag = asDouble(k, v); }},
+        {"precision", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.precision = asString(k, v); }},
+        {"interior", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.interior = asString(k, v); }},
+        {"iterationFormat", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.iterationFormat = asString(k, v); }},
+        {"specialize", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.specialize = asBool(k, v); }},
+        {"localSizeX", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.localSizeX = asInt(k, v); }},
+        {"localSizeY", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.localSizeY = asInt(k, v); }},
+        {"pixelsPerItem", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.pixelsPerItem = asInt(k, v); }},
+        {"threads", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.threads = asInt(k, v); }},
+        {"tiled", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.tiled = asBool(k, v); }},
+        {"tileMemoryMB", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.tileMemoryMB = asInt(k, v); }},
+        {"streaming", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.streaming = asBool(k, v); }},
+        {"bandRows", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.bandRows = asInt(k, v); }},
+        {"deviceColor", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.deviceColor = asBool(k, v); }},
+        {"readback", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.readback = asString(k, v); }},
+        {"subdivide", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.subdivide = asBool(k, v); }},
+        {"antialiasSamples", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.antialiasSamples = asInt(k, v); }},
+        {"palette", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.palette = asString(k, v); }},
+        {"paletteFile", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.paletteFile = asString(k, v); }},
+        {"coloring", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.coloring = asString(k, v); }},
+        {"pngLevel", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.pngLevel = asInt(k, v); }},
+        {"pngFilter", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.pngFilter = asString(k, v); }},
+        {"outputPath", [](RenderConfig& c, const std::string& k, const JsonScalar& v) { c.outputPath = asString(k, v); }},
+    };
+
+    for (const auto& entry : obj) {
+        if (ignoredKeys.count(entry.first)) {
+            continue;
+        }
+        auto it = setters.find(entry.first);
+        if (it == setters.end()) {
+            throw std::runtime_error("Unknown request field: " + entry.first);
+        }
+        it->second(base, entry.first, entry.second);
+    }
+    if (base.width <= 0 || base.height <= 0 || base.maxIterations <= 0) {
+        throw std::runtime_error("width, height and maxIterations must be positive");
+    }
+    if (base.fractalType != "mandelbrot" && base.fractalType != "julia") {
+        throw std::runtime_error("Unknown fractalType: " + base.fractalType);
+    }
+    if (base.precision != "auto") {
+        precisionTierFromName(base.precision);  // Throws on unknown names.
+    }
+    interiorCheckFromName(base.interior);
+    if (!PaletteRegistry::instance().contains(base.palette)) {
+        throw std::runtime_error("Unknown palette: " + base.palette);
+    }
+    if (base.coloring != "linear" && base.coloring != "histogram") {
+        throw std::runtime_error("Unknown coloring: " + base.coloring);
+    }
+    if (base.pngLevel < 0 || base.pngLevel > 9) {
+        throw std::runtime_error("pngLevel must be 0..9");
+    }
+    if (base.pngFilter != "auto") {
+        PngEncoder::filterFromName(base.pngFilter);
+    }
+    if (base.readback != "copy" && base.readback != "map" && base.readback != "auto") {
+        throw std::runtime_error("Unknown readback mode: " + base.readback);
+    }
+    if (base.iterationFormat != "auto") {
+        iterationFormatFromName(base.iterationFormat);
+    }
+    if (base.pixelsPerItem < 0) {
+        throw std::runtime_error("pixelsPerItem must not be negative");
+    }
+    if (base.antialiasSamples < 0 || base.antialiasSamples > FractalConstants::Antialias::MAX_SAMPLES) {
+        throw std::runtime_error("antialiasSamples must be 0.." + std::to_string(FractalConstants::Antialias::MAX_SAMPLES));
+    }
+    return base;
+}
+
+std::string jsonQuote(const std::string& s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+std::string jsonValue(const JsonScalar& v) {
+    switch (v.type) {
+        case JsonScalar::Type::String: return jsonQuote(v.text);
+        case JsonScalar::Type::Number:
+        case JsonScalar::Type::Bool: return v.text;
+        case JsonScalar::Type::Null: break;
+    }
+    return "null";
+}
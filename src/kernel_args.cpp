@@ -0,0 +1,131 @@
+// Kernel arguments implementation - clSetKernelArg sequences of the iteration
+// kernels, in the order the .cl signatures declare them.
+
+#include "kernel_args.h"
+
+#include <stdexcept>
+
+#include "constants.h"
+#include "interior_check.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+// Split a double into a float (hi, lo) pair for the double-float kernel.
+cl_float2 splitDouble(double v) {
+    cl_float2 r;
+    r.s[0] = static_cast<float>(v);
+    r.s[1] = static_cast<float>(v - static_cast<double>(r.s[0]));
+    return r;
+}
+
+} // namespace
+
+void setFractalKernelArgs(cl_kernel kernel, PrecisionTier tier, const RenderConfig& cfg, cl_mem iterationsBuf,
+                          IterationFormat format, int pixelsPerItem) {
+    const int width = cfg.width;
+    const int height = cfg.height;
+    const int maxIterations = cfg.maxIterations;
+    const int juliaMode = (cfg.fractalType == "julia") ? 1 : 0;
+    const int interior = interiorCheckFlags(interiorCheckFromName(cfg.interior));
+
+    cl_int err = CL_SUCCESS;
+    err  = clSetKernelArg(kernel, 0, sizeof(cl_mem), &iterationsBuf);
+    err |= clSetKernelArg(kernel, 1, sizeof(int), &width);
+    err |= clSetKernelArg(kernel, 2, sizeof(int), &height);
+    if (tier == PrecisionTier::Double) {
+        err |= clSetKernelArg(kernel, 3, sizeof(double), &cfg.centerX);
+        err |= clSetKernelArg(kernel, 4, sizeof(double), &cfg.centerY);
+        err |= clSetKernelArg(kernel, 5, sizeof(double), &cfg.zoom);
+        err |= clSetKernelArg(kernel, 6, sizeof(int), &maxIterations);
+        err |= clSetKernelArg(kernel, 7, sizeof(double), &cfg.juliaReal);
+        err |= clSetKernelArg(kernel, 8, sizeof(double), &cfg.juliaImag);
+        err |= clSetKernelArg(kernel, 9, sizeof(int), &juliaMode);
+    } else if (tier == PrecisionTier::DoubleFloat) {
+        const cl_float2 centerX = splitDouble(cfg.centerX);
+        const cl_float2 centerY = splitDouble(cfg.centerY);
+        const cl_float2 stepX = splitDouble(Kernel::VIEWPORT_SCALE_X / (cfg.zoom * width));
+        const cl_float2 stepY = splitDouble(Kernel::VIEWPORT_SCALE_Y / (cfg.zoom * height));
+        const cl_float2 juliaRe = splitDouble(cfg.juliaReal);
+        const cl_float2 juliaImag = splitDouble(cfg.juliaImag);
+        err |= clSetKernelArg(kernel, 3, sizeof(cl_float2), &centerX);
+        err |= clSetKernelArg(kernel, 4, sizeof(cl_float2), &centerY);
+        err |= clSetKernelArg(kernel, 5, sizeof(cl_float2), &stepX);
+        err |= clSetKernelArg(kernel, 6, sizeof(cl_float2), &stepY);
+        err |= clSetKernelArg(kernel, 7, sizeof(int), &maxIterations);
+        err |= clSetKernelArg(kernel, 8, sizeof(cl_float2), &juliaRe);
+        err |= clSetKernelArg(kernel, 9, sizeof(cl_float2), &juliaImag);
+        err |= clSetKernelArg(kernel, 10, sizeof(int), &juliaMode);
+    } else {
+        const float centerX = static_cast<float>(cfg.centerX);
+        const float centerY = static_cast<float>(cfg.centerY);
+        const float zoom = static_cast<float>(cfg.zoom);
+        const float juliaRe = static_cast<float>(cfg.juliaReal);
+        const float juliaImag = static_cast<float>(cfg.juliaImag);
+        err |= clSetKernelArg(kernel, 3, sizeof(float), &centerX);
+        err |= clSetKernelArg(kernel, 4, sizeof(float), &centerY);
+        err |= clSetKernelArg(kernel, 5, sizeof(float), &zoom);
+        err |= clSetKernelArg(kernel, 6, sizeof(int), &maxIterations);
+        err |= clSetKernelArg(kernel, 7, sizeof(float), &juliaRe);
+        err |= clSetKernelArg(kernel, 8, sizeof(float), &juliaImag);
+        err |= clSetKernelArg(kernel, 9, sizeof(int), &juliaMode);
+        err |= clSetKernelArg(kernel, 10, sizeof(int), &interior);
+        const int formatCode = static_cast<int>(format);
+        err |= clSetKernelArg(kernel, 11, sizeof(int), &formatCode);
+        err |= clSetKernelArg(kernel, 12, sizeof(int), &pixelsPerItem);
+    }
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to set Mandelbrot kernel arguments");
+    }
+}
+
+void setPerturbationKernelArgs(cl_kernel kernel, const RenderConfig& cfg, const ReferenceOrbit& orbit,
+                               cl_mem orbitBuf, cl_mem iterationsBuf) {
+    const double scaleX = Kernel::VIEWPORT_SCALE_X / cfg.zoom;
+    const double scaleY = Kernel::VIEWPORT_SCALE_Y / cfg.zoom;
+    const int juliaMode = (cfg.fractalType == "julia") ? 1 : 0;
+
+    cl_int err = CL_SUCCESS;
+    err  = clSetKernelArg(kernel, 0, sizeof(cl_mem), &iterationsBuf);
+    err |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &orbitBuf);
+    err |= clSetKernelArg(kernel, 2, sizeof(int), &orbit.length);
+    err |= clSetKernelArg(kernel, 3, sizeof(int), &cfg.width);
+    err |= clSetKernelArg(kernel, 4, sizeof(int), &cfg.height);
+    err |= clSetKernelArg(kernel, 5, sizeof(double), &scaleX);
+    err |= clSetKernelArg(kernel, 6, sizeof(double), &scaleY);
+    err |= clSetKernelArg(kernel, 7, sizeof(int), &cfg.maxIterations);
+    err |= clSetKernelArg(kernel, 8, sizeof(int), &juliaMode);
+    err |= clSetKernelArg(kernel, 9, sizeof(double), &orbit.offsetX);
+    err |= clSetKernelArg(kernel, 10, sizeof(double), &orbit.offsetY);
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to set perturbation kernel arguments");
+    }
+}
+
+void setPointsKernelArgs(cl_kernel kernel, const RenderConfig& cfg, cl_mem pointsBuf, cl_mem iterationsBuf) {
+    const float centerX = static_cast<float>(cfg.centerX);
+    const float centerY = static_cast<float>(cfg.centerY);
+    const float zoom = static_cast<float>(cfg.zoom);
+    const float juliaRe = static_cast<float>(cfg.juliaReal);
+    const float juliaImag = static_cast<float>(cfg.juliaImag);
+    const int juliaMode = (cfg.fractalType == "julia") ? 1 : 0;
+    const int interior = interiorCheckFlags(interiorCheckFromName(cfg.interior));
+
+    cl_int err = CL_SUCCESS;
+    err  = clSetKernelArg(kernel, 0, sizeof(cl_mem), &iterationsBuf);
+    err |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &pointsBuf);
+    err |= clSetKernelArg(kernel, 3, sizeof(int), &cfg.width);
+    err |= clSetKernelArg(kernel, 4, sizeof(int), &cfg.height);
+    err |= clSetKernelArg(kernel, 5, sizeof(float), &centerX);
+    err |= clSetKernelArg(kernel, 6, sizeof(float), &centerY);
+    err |= clSetKernelArg(kernel, 7, sizeof(float), &zoom);
+    err |= clSetKernelArg(kernel, 8, sizeof(int), &cfg.maxIterations);
+    err |= clSetKernelArg(kernel, 9, sizeof(float), &juliaRe);
+    err |= clSetKernelArg(kernel, 10, sizeof(float), &juliaImag);
+    err |= clSetKernelArg(kernel, 11, sizeof(int), &juliaMode);
+    err |= clSetKernelArg(kernel, 12, sizeof(int), &interior);
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to set points kernel arguments");
+    }
+}
@@ -2,13 +2,46 @@
 
 #include "kernel_manager.h"
 
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
+
+#include "constants.h"
+#include "device_manager.h"
+#include "iteration_format.h"
+#include "trace.h"
 
 namespace {
 
+using namespace FractalConstants;
+
+// OpenCL C float literal that reads back as exactly v.
+std::string floatLiteral(float v) {
+    std::ostringstream out;
+    out << std::showpoint << std::setprecision(9) << v << 'f';
+    return out.str();
+}
+
+// Program file and iteration kernel of a tier.
+struct TierSource {
+    const char* program;
+    const char* kernel;
+};
+
+TierSource tierSource(PrecisionTier tier) {
+    switch (tier) {
+        case PrecisionTier::DoubleFloat: return {"mandelbrot_df", "mandelbrot_iterations_df"};
+        case PrecisionTier::Double: return {"mandelbrot_double", "mandelbrot_iterations_double"};
+        case PrecisionTier::Perturbation: return {"perturbation", "perturbation_iterations"};
+        case PrecisionTier::Float: break;
+    }
+    return {"mandelbrot", "mandelbrot_iterations"};
+}
+
 std::string readTextFile(const std::string& path) {
     std::ifstream in(path);
     if (!in) {
@@ -21,7 +54,72 @@ std::string readTextFile(const std::string& path) {
 
 } // namespace
 
+std::string KernelVariant::buildOptions() const {
+    std::string options;
+    if (julia >= 0) {
+        options += " -DSPEC_JULIA=" + std::to_string(julia);
+    }
+    if (maxIterations > 0) {
+        options += " -DSPEC_MAX_ITERATIONS=" + std::to_string(maxIterations);
+    }
+    if (unroll > 1) {
+        options += " -DSPEC_UNROLL=" + std::to_string(unroll);
+    }
+    return options.empty() ? options : options.substr(1);
+}
+
+std::string KernelVariant::name() const {
+    return std::string(precisionTierName(tier)) + " " +
+           (julia < 0 ? "any fractal" : (julia ? "julia" : "mandelbrot")) + ", " +
+           (maxIterations > 0 ? std::to_string(maxIterations) + " iterations" : "runtime bound") +
+           ", unroll " + std::to_string(unroll);
+}
+
+bool KernelVariant::operator<(const KernelVariant& other) const {
+    return std::tie(tier, julia, maxIterations, unroll) <
+           std::tie(other.tier, other.julia, other.maxIterations, other.unroll);
+}
+
 KernelManager::~KernelManager() {
+    for (const auto& variant : variants_) {
+        if (variant.second.second) {
+            clReleaseKernel(variant.second.second);
+        }
+        if (variant.second.first) {
+            clReleaseProgram(variant.second.first);
+        }
+    }
+    if (perturbationKernel_) {
+        clReleaseKernel(perturbationKernel_);
+    }
+    if (perturbationProgram_) {
+        clReleaseProgram(perturbationProgram_);
+    }
+    if (colorizeKernel_) {
+        clReleaseKernel(colorizeKernel_);
+    }
+    if (histogramKernel_) {
+        clReleaseKernel(histogramKernel_);
+    }
+    if (colorizeProgram_) {
+        clReleaseProgram(colorizeProgram_);
+    }
+    for (cl_kernel kernel : {doubleKernel_, doubleFloatKernel_}) {
+        if (kernel) {
+            clReleaseKernel(kernel);
+        }
+    }
+    for (cl_program program : {doubleProgram_, doubleFloatProgram_}) {
+        if (program) {
+            clReleaseProgram(program);
+        }
+    }
+    if (pointsKernel_) {
+        clReleaseKernel(pointsKernel_);
+    }
+    if (samplesKernel_) {
+        clReleaseKernel(samplesKernel_);
+    }
     if (mandelbrotKernel_) {
         clReleaseKernel(mandelbrotKernel_);
     }
@@ -32,38 +130,191 @@ KernelManager::~KernelManager() {
 
 void KernelManager::initialize(const std::string& kernelsRoot,
                                cl_context context,
-                               cl_device_id device) {
+                               cl_device_id device,
+                               const std::string& cacheDirectory) {
+    Trace::Scope scope("Program build", "kernels");
     kernelsRoot_ = kernelsRoot;
+    context_ = context;
+    device_ = device;
+    cache_ = ProgramCache(cacheDirectory);
+    const auto start = std::chrono::steady_clock::now();
+
+    cl_int err = CL_SUCCESS;
+    program_ = buildProgram("mandelbrot", context, device);
+    mandelbrotKernel_ = clCreateKernel(program_, "mandelbrot_iterations", &err);
+    if (err != CL_SUCCESS || !mandelbrotKernel_) {
+        throw std::runtime_error("Failed to create mandelbrot_iterations kernel");
+    }
+    pointsKernel_ = clCreateKernel(program_, "mandelbrot_points", &err);
+    if (err != CL_SUCCESS || !pointsKernel_) {
+        throw std::runtime_error("Failed to create mandelbrot_points kernel");
+    }
+    samplesKernel_ = clCreateKernel(program_, "mandelbrot_samples", &err);
+    if (err != CL_SUCCESS || !samplesKernel_) {
+        throw std::runtime_error("Failed to create mandelbrot_samples kernel");
+    }
+
+    doubleFloatProgram_ = buildProgram("mandelbrot_df", context, device);
+    doubleFloatKernel_ = clCreateKernel(doubleFloatProgram_, "mandelbrot_iterations_df", &err);
+    if (err != CL_SUCCESS || !doubleFloatKernel_) {
+        throw std::runtime_error("Failed to create mandelbrot_iterations_df kernel");
+    }
+
+    const bool fp64 = DeviceManager::hasExtension(device, "cl_khr_fp64");
+    if (fp64) {
+        doubleProgram_ = buildProgram("mandelbrot_double", context, device);
+        doubleKernel_ = clCreateKernel(doubleProgram_, "mandelbrot_iterations_double", &err);
+        if (err != CL_SUCCESS || !doubleKernel_) {
+            throw std::runtime_error("Failed to create mandelbrot_iterations_double kernel");
+        }
+    }
+
+    cl_device_type deviceType = CL_DEVICE_TYPE_GPU;
+    clGetDeviceInfo(device, CL_DEVICE_TYPE, sizeof(deviceType), &deviceType, nullptr);
+    tiers_ = {PrecisionTier::Float};
+    if (fp64 && !(deviceType & CL_DEVICE_TYPE_GPU)) {
+        tiers_.push_back(PrecisionTier::Double);
+        tiers_.push_back(PrecisionTier::DoubleFloat);
+    } else {
+        tiers_.push_back(PrecisionTier::DoubleFloat);
+        if (fp64) {
+            tiers_.push_back(PrecisionTier::Double);
+        }
+    }
+
+    colorizeProgram_ = buildProgram("colorize", context, device);
+    colorizeKernel_ = clCreateKernel(colorizeProgram_, "colorize_rgb", &err);
+    if (err != CL_SUCCESS || !colorizeKernel_) {
+        throw std::runtime_error("Failed to create colorize_rgb kernel");
+    }
+    histogramKernel_ = clCreateKernel(colorizeProgram_, "iteration_histogram", &err);
+    if (err != CL_SUCCESS || !histogramKernel_) {
+        throw std::runtime_error("Failed to create iteration_histogram kernel");
+    }
+
+    if (fp64) {
+        perturbationProgram_ = buildProgram("perturbation", context, device);
+        perturbationKernel_ = clCreateKernel(perturbationProgram_, "perturbation_iterations", &err);
+        if (err != CL_SUCCESS || !perturbationKernel_) {
+            throw std::runtime_error("Failed to create perturbation_iterations kernel");
+        }
+    } else {
+        std::cout << "[Kernels] Device lacks cl_khr_fp64; no double tier, deep zooms iterate on the host\n";
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const char* kind = cacheHits_ == programsBuilt_ ? "warm start" : (cacheHits_ == 0 ? "cold start" : "partial warm start");
+    std::cout << "[Kernels] Programs ready in " << ms << " ms (" << kind << ", "
+              << cacheHits_ << "/" << programsBuilt_ << " from binary cache"
+              << (cache_.enabled() ? "" : ", cache disabled") << ")\n";
+}
+
+cl_program KernelManager::buildProgram(const std::string& name,
+                                       cl_context context,
+                                       cl_device_id device,
+                                       const std::string& options) {
+    const std::string path = kernelsRoot_ + "/" + name + ".cl";
+    std::string source = readTextFile(path);
+    ++programsBuilt_;
+
+    const std::string buildOptions = constantOptions() + (options.empty() ? "" : " " + options);
+    const std::string key = ProgramCache::makeKey(device, source, buildOptions);
+    if (cl_program cached = cache_.load(name, key, context, device, buildOptions)) {
+        ++cacheHits_;
+        return cached;
+    }
 
-    const std::string mandelbrotPath = kernelsRoot_ + "/mandelbrot.cl";
-    std::string source = readTextFile(mandelbrotPath);
     const char* srcPtr = source.c_str();
     const size_t srcLen = source.size();
 
     cl_int err = CL_SUCCESS;
-    program_ = clCreateProgramWithSource(context, 1, &srcPtr, &srcLen, &err);
-    if (err != CL_SUCCESS || !program_) {
-        throw std::runtime_error("Failed to create OpenCL program from mandelbrot.cl");
+    cl_program program = clCreateProgramWithSource(context, 1, &srcPtr, &srcLen, &err);
+    if (err != CL_SUCCESS || !program) {
+        throw std::runtime_error("Failed to create OpenCL program from " + name + ".cl");
     }
 
-    err = clBuildProgram(program_, 1, &device, nullptr, nullptr, nullptr);
+    err = clBuildProgram(program, 1, &device, buildOptions.c_str(), nullptr, nullptr);
     if (err != CL_SUCCESS) {
         // Try to fetch and print the build log for easier debugging.
         size_t logSize = 0;
-        clGetProgramBuildInfo(program_, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
+        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
         std::string log(logSize, '\0');
         if (logSize > 0) {
-            clGetProgramBuildInfo(program_, device, CL_PROGRAM_BUILD_LOG,
+            clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG,
                                   logSize, &log[0], nullptr);
         }
-        std::cerr << "[Kernels] Build log for mandelbrot program:\n" << log << "\n";
-        throw std::runtime_error("Failed to build OpenCL program (mandelbrot)");
+        std::cerr << "[Kernels] Build log for " << name << " program:\n" << log << "\n";
+        clReleaseProgram(program);
+        throw std::runtime_error("Failed to build OpenCL program (" + name + ")");
     }
+    cache_.store(name, key, program);
+    return program;
+}
 
-    mandelbrotKernel_ = clCreateKernel(program_, "mandelbrot_iterations", &err);
-    if (err != CL_SUCCESS || !mandelbrotKernel_) {
-        throw std::runtime_error("Failed to create mandelbrot_iterations kernel");
+cl_kernel KernelManager::iterationKernel(PrecisionTier tier) const {
+    switch (tier) {
+        case PrecisionTier::Float: return mandelbrotKernel_;
+        case PrecisionTier::DoubleFloat: return doubleFloatKernel_;
+        case PrecisionTier::Double: return doubleKernel_;
+        case PrecisionTier::Perturbation: return perturbationKernel_;
     }
+    return nullptr;
+}
+
+cl_kernel KernelManager::variantKernel(const KernelVariant& variant) {
+    const auto found = variants_.find(variant);
+    if (found != variants_.end()) {
+        return found->second.second;
+    }
+    if (variant.tier == PrecisionTier::Perturbation || !iterationKernel(variant.tier)) {
+        return nullptr;
+    }
+
+    Trace::Scope scope("Variant build", "kernels");
+    const auto start = std::chrono::steady_clock::now();
+    const int hitsBefore = cacheHits_;
+    const TierSource source = tierSource(variant.tier);
+    cl_program program = nullptr;
+    cl_kernel kernel = nullptr;
+    try {
+        program = buildProgram(source.program, context_, device_, variant.buildOptions());
+        cl_int err = CL_SUCCESS;
+        kernel = clCreateKernel(program, source.kernel, &err);
+        if (err != CL_SUCCESS || !kernel) {
+            throw std::runtime_error(std::string("Failed to create ") + source.kernel + " kernel");
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[Kernels] Variant " << variant.name() << " ready in " << ms << " ms ("
+                  << (cacheHits_ > hitsBefore ? "binary cache" : "built") << ")\n";
+    } catch (const std::exception& ex) {
+        if (program) {
+            clReleaseProgram(program);
+        }
+        program = nullptr;
+        kernel = nullptr;
+        std::cout << "[Kernels] Variant " << variant.name() << " unavailable (" << ex.what()
+                  << "); using the generic kernel\n";
+    }
+    variants_[variant] = {program, kernel};
+    return kernel;
+}
+
+std::string KernelManager::constantOptions() {
+    std::ostringstream out;
+    out << "-DVIEWPORT_SCALE_X=" << floatLiteral(Kernel::VIEWPORT_SCALE_X)
+        << " -DVIEWPORT_SCALE_Y=" << floatLiteral(Kernel::VIEWPORT_SCALE_Y)
+        << " -DPIXEL_OFFSET=" << floatLiteral(Kernel::PIXEL_OFFSET)
+        << " -DESCAPE_RADIUS_SQUARED=" << floatLiteral(Kernel::ESCAPE_RADIUS_SQUARED)
+        << " -DJULIA_MULTIPLIER=" << floatLiteral(Kernel::JULIA_MULTIPLIER)
+        << " -DBULB_FLAG=" << Interior::BULB_FLAG
+        << " -DPERIODICITY_FLAG=" << Interior::PERIODICITY_FLAG
+        << " -DPERIOD_WINDOW_START=" << Interior::PERIOD_WINDOW_START
+        << " -DFORMAT_U8=" << static_cast<int>(IterationFormat::U8)
+        << " -DFORMAT_U16=" << static_cast<int>(IterationFormat::U16)
+        << " -DFORMAT_U32=" << static_cast<int>(IterationFormat::U32)
+        << " -DFORMAT_PACKED=" << static_cast<int>(IterationFormat::Packed)
+        << " -DPACKED_FRACTION_BITS=" << IterationStorage::PACKED_FRACTION_BITS;
+    return out.str();
 }
 
 void KernelManager::printDiagnostics() const {
@@ -71,6 +322,24 @@ void KernelManager::printDiagnostics() const {
     std::cout << "[Kernels]  - mandelbrot_iterations kernel: "
               << (mandelbrotKernel_ ? "ready" : "NOT READY")
               << "\n";
+    std::cout << "[Kernels]  - mandelbrot_points kernel: "
+              << (pointsKernel_ ? "ready" : "NOT READY") << "\n";
+    std::cout << "[Kernels]  - mandelbrot_samples kernel: "
+              << (samplesKernel_ ? "ready" : "NOT READY") << "\n";
+    std::cout << "[Kernels]  - iteration tiers (cheapest first):";
+    for (PrecisionTier tier : tiers_) {
+        std::cout << " " << precisionTierName(tier);
+    }
+    std::cout << "\n";
+    std::cout << "[Kernels]  - colorize_rgb kernel: "
+              << (colorizeKernel_ ? "ready" : "NOT READY")
+              << "\n";
+    std::cout << "[Kernels]  - iteration_histogram kernel: "
+              << (histogramKernel_ ? "ready" : "NOT READY")
+              << "\n";
+    std::cout << "[Kernels]  - perturbation_iterations kernel: "
+              << (perturbationKernel_ ? "ready" : "unavailable (no fp64)")
+              << "\n";
 }
 
 
@@ -3,38 +3,119 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "animation.h"
 #include "cli_parser.h"
 #include "device_manager.h"
+#include "device_set.h"
 #include "kernel_manager.h"
 #include "memory_manager.h"
+#include "palette.h"
+#include "render_server.h"
 #include "renderer.h"
+#include "trace.h"
 #include "fractal_strategy.h"
 
 int main(int argc, char** argv) {
     try {
         RenderConfig cfg = parse_args(argc, argv);
+        // A bad gradient file fails here, not after the frame is computed.
+        if (!cfg.paletteFile.empty()) {
+            PaletteRegistry::loadGradientFile(cfg.paletteFile);
+        }
+        if (!cfg.traceFile.empty()) {
+            Trace::start(cfg.traceFile);
+        }
+
+        // In stdin server mode stdout carries only responses; logs go to stderr.
+        std::streambuf* responseBuf = std::cout.rdbuf();
+        if (cfg.serveMode == "stdin") {
+            std::cout.rdbuf(std::cerr.rdbuf());
+        }
+
         std::cout << "OpenCL Fractal Renderer scaffold.\n";
-        print_config_summary(cfg);
 
-        // Initialize core host-side managers.
+        // Initialize core host-side managers. The CPU backend needs no OpenCL
+        // objects; "auto" uses OpenCL when it comes up and falls back otherwise.
         DeviceManager deviceManager;
-        deviceManager.initialize();
-        deviceManager.printDiagnostics();
-
         KernelManager kernelManager;
-        kernelManager.initialize("kernels", deviceManager.context(), deviceManager.device());
-        kernelManager.printDiagnostics();
+
+        // Recoloring reads counts from disk: the managers stay uninitialized.
+        if (!cfg.recolorFile.empty()) {
+            MemoryManager memoryManager(deviceManager);
+            Renderer(deviceManager, kernelManager, memoryManager).recolor(cfg);
+            Trace::finish();
+            return 0;
+        }
+
+        print_config_summary(cfg);
+        if (cfg.backend != "cpu") {
+            try {
+                deviceManager.initialize(cfg.deviceType == "cpu");
+                deviceManager.printDiagnostics();
+
+                kernelManager.initialize("kernels", deviceManager.context(), deviceManager.device(),
+                                         cfg.kernelCacheDir);
+                kernelManager.printDiagnostics();
+                cfg.backend = "opencl";
+            } catch (const std::exception& ex) {
+                if (cfg.backend != "auto") {
+                    throw;
+                }
+                std::cout << "[Device] OpenCL unavailable (" << ex.what()
+                          << "); falling back to CPU backend\n";
+                cfg.backend = "cpu";
+            }
+        }
+
+        if (!cfg.serveMode.empty()) {
+            RenderServer server(deviceManager, cfg);
+            if (cfg.serveMode == "socket") {
+                server.serveSocket(cfg.socketPath);
+            } else {
+                std::ostream responses(responseBuf);
+                server.serve(std::cin, responses);
+            }
+            Trace::finish();
+            std::cout.rdbuf(responseBuf);
+            return 0;
+        }
+
+        // Extra contexts for every other device, built only when asked for;
+        // the primary device keeps the context and kernels built above.
+        DeviceSet deviceSet;
+        if (cfg.multiDevice && cfg.backend == "opencl") {
+            deviceSet.initialize("kernels", cfg.kernelCacheDir, deviceManager, kernelManager);
+            deviceSet.printDiagnostics();
+        }
 
         MemoryManager memoryManager(deviceManager);
 
         Renderer renderer(deviceManager, kernelManager, memoryManager);
+        if (deviceSet.size() > 0) {
+            renderer.setDeviceSet(&deviceSet);
+        }
         if (cfg.fractalType == "julia") {
             renderer.setStrategy(std::make_unique<JuliaStrategy>());
         } else {
             renderer.setStrategy(std::make_unique<MandelbrotStrategy>());
         }
 
-        renderer.render(cfg);
+        if (cfg.autotune) {
+            renderer.autotune(cfg);
+        } else if (cfg.benchPrecision) {
+            renderer.benchmarkTiers(cfg);
+        } else if (cfg.benchInterior) {
+            renderer.benchmarkInterior(cfg);
+        } else if (cfg.benchVariants) {
+            renderer.benchmarkVariants(cfg);
+        } else if (!cfg.animationFile.empty()) {
+            const Animation animation = Animation::loadKeyframes(cfg.animationFile, cfg);
+            renderer.renderSequence(animation.frames(cfg, cfg.frameCount));
+        } else {
+            renderer.render(cfg);
+        }
+        // Before the managers release the queues the recorded events refer to.
+        Trace::finish();
     } catch (const std::exception& ex) {
         std::cerr << "Error: " << ex.what() << "\n\n";
         print_help();
@@ -0,0 +1,184 @@
+// MarianiSilver implementation - level-synchronous rectangle subdivision.
+
+#include "mariani_silver.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "constants.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+constexpr int kUnknown = -1;
+constexpr int kQueued = -2;  // Already in this round's batch.
+
+// Inclusive pixel bounds; neighbours share their edge row/column.
+struct Rect {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+class PointBatch {
+public:
+    PointBatch(int width, int* out, const MarianiSilver::EvaluateFn& evaluate,
+               size_t maxPoints, MarianiSilver::Stats& stats)
+        : width_(width), out_(out), evaluate_(evaluate), maxPoints_(maxPoints), stats_(stats) {
+        points_.reserve(maxPoints_ * 2);
+    }
+
+    // Queue pixel (x, y) unless it is known or already queued.
+    void add(int x, int y) {
+        int& slot = out_[static_cast<size_t>(y) * width_ + x];
+        if (slot != kUnknown) {
+            return;
+        }
+        slot = kQueued;
+        points_.push_back(x);
+        points_.push_back(y);
+        if (points_.size() / 2 >= maxPoints_) {
+            flush();
+        }
+    }
+
+    void flush() {
+        const size_t count = points_.size() / 2;
+        if (count == 0) {
+            return;
+        }
+        results_.resize(count);
+        evaluate_(points_.data(), count, results_.data());
+        for (size_t i = 0; i < count; ++i) {
+            out_[static_cast<size_t>(points_[2 * i + 1]) * width_ + points_[2 * i]] = results_[i];
+        }
+        stats_.pixelsIterated += count;
+        ++stats_.batches;
+        points_.clear();
+    }
+
+private:
+    int width_;
+    int* out_;
+    const MarianiSilver::EvaluateFn& evaluate_;
+    size_t maxPoints_;
+    MarianiSilver::Stats& stats_;
+    std::vector<int> points_;
+    std::vector<int> results_;
+};
+
+void queueBorder(const Rect& r, PointBatch& batch) {
+    for (int x = r.x0; x <= r.x1; ++x) {
+        batch.add(x, r.y0);
+        batch.add(x, r.y1);
+    }
+    for (int y = r.y0 + 1; y < r.y1; ++y) {
+        batch.add(r.x0, y);
+        batch.add(r.x1, y);
+    }
+}
+
+void queueInterior(const Rect& r, PointBatch& batch) {
+    for (int y = r.y0 + 1; y < r.y1; ++y) {
+        for (int x = r.x0 + 1; x < r.x1; ++x) {
+            batch.add(x, y);
+        }
+    }
+}
+
+// The single iteration count on r's border, or kUnknown if it varies.
+int uniformBorder(const Rect& r, const int* out, int width) {
+    const int value = out[static_cast<size_t>(r.y0) * width + r.x0];
+    auto at = [&](int x, int y) { return out[static_cast<size_t>(y) * width + x]; };
+    for (int x = r.x0; x <= r.x1; ++x) {
+        if (at(x, r.y0) != value || at(x, r.y1) != value) {
+            return kUnknown;
+        }
+    }
+    for (int y = r.y0 + 1; y < r.y1; ++y) {
+        if (at(r.x0, y) != value || at(r.x1, y) != value) {
+            return kUnknown;
+        }
+    }
+    return value;
+}
+
+// Tile edges 0, T, 2T, ..., extent-1 (the last tile absorbs the remainder).
+std::vector<int> tileEdges(int extent) {
+    std::vector<int> edges;
+    for (int e = 0; e < extent - 1; e += Subdivide::TILE_SIZE) {
+        edges.push_back(e);
+    }
+    if (extent - 1 - edges.back() < Subdivide::MIN_SPLIT_SIZE && edges.size() > 1) {
+        edges.pop_back();
+    }
+    edges.push_back(extent - 1);
+    return edges;
+}
+
+} // namespace
+
+MarianiSilver::Stats MarianiSilver::render(const RenderConfig& cfg,
+                                           int* out,
+                                           const EvaluateFn& evaluate,
+                                           size_t maxBatchPoints) {
+    if (cfg.width < 2 || cfg.height < 2) {
+        throw std::runtime_error("Subdivision needs an image of at least 2x2 pixels");
+    }
+    Stats stats;
+    const int width = cfg.width;
+    std::fill(out, out + static_cast<size_t>(cfg.width) * cfg.height, kUnknown);
+    PointBatch batch(width, out, evaluate, std::max<size_t>(1, maxBatchPoints), stats);
+
+    std::vector<Rect> pending;
+    const std::vector<int> xs = tileEdges(cfg.width);
+    const std::vector<int> ys = tileEdges(cfg.height);
+    for (size_t j = 0; j + 1 < ys.size(); ++j) {
+        for (size_t i = 0; i + 1 < xs.size(); ++i) {
+            pending.push_back({xs[i], ys[j], xs[i + 1], ys[j + 1]});
+        }
+    }
+
+    // Rectangles too small to split; their interiors go into the next batch.
+    std::vector<Rect> leaves;
+    std::vector<Rect> next;
+    while (!pending.empty() || !leaves.empty()) {
+        ++stats.rounds;
+        for (const Rect& r : pending) {
+            queueBorder(r, batch);
+        }
+        for (const Rect& r : leaves) {
+            queueInterior(r, batch);
+        }
+        batch.flush();
+        leaves.clear();
+
+        next.clear();
+        for (const Rect& r : pending) {
+            const int value = uniformBorder(r, out, width);
+            if (value != kUnknown) {
+                for (int y = r.y0 + 1; y < r.y1; ++y) {
+                    std::fill(out + static_cast<size_t>(y) * width + r.x0 + 1,
+                              out + static_cast<size_t>(y) * width + r.x1, value);
+                }
+                stats.pixelsFilled += static_cast<uint64_t>(std::max(0, r.x1 - r.x0 - 1)) *
+                                      static_cast<uint64_t>(std::max(0, r.y1 - r.y0 - 1));
+                ++stats.rectsFilled;
+            } else if (r.x1 - r.x0 < Subdivide::MIN_SPLIT_SIZE || r.y1 - r.y0 < Subdivide::MIN_SPLIT_SIZE) {
+                leaves.push_back(r);
+            } else {
+                const int mx = (r.x0 + r.x1) / 2;
+                const int my = (r.y0 + r.y1) / 2;
+                next.push_back({r.x0, r.y0, mx, my});
+                next.push_back({mx, r.y0, r.x1, my});
+                next.push_back({r.x0, my, mx, r.y1});
+                next.push_back({mx, my, r.x1, r.y1});
+            }
+        }
+        pending.swap(next);
+    }
+    return stats;
+}
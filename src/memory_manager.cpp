@@ -1,32 +1,214 @@
-// MemoryManager implementation - allocation for Mandelbrot iteration buffer.
+// MemoryManager implementation - pooled allocation for iteration, band and
+// RGB buffers.
 
 #include "memory_manager.h"
 
+#include <iostream>
 #include <stdexcept>
 
+#include "constants.h"
+#include "trace.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+constexpr double kBytesPerMiB = 1024.0 * 1024.0;
+
+} // namespace
+
 MemoryManager::MemoryManager(DeviceManager& deviceManager)
-    : deviceManager_(deviceManager) {}
+    : deviceManager_(deviceManager)
+    , pool_(deviceManager) {}
 
 MemoryManager::~MemoryManager() {
-    if (iterationBuffer_) {
-        clReleaseMemObject(iterationBuffer_);
+    releaseBuffers();
+}
+
+void MemoryManager::beginRender(const RenderConfig& cfg) {
+    releaseBuffers();
+
+    size_t deviceBudget = Pool::FALLBACK_BUDGET_BYTES;
+    size_t hostBudget = Pool::FALLBACK_BUDGET_BYTES;
+    if (cfg.poolMemoryMB > 0) {
+        deviceBudget = hostBudget = static_cast<size_t>(cfg.poolMemoryMB) << 20;
+    } else if (deviceManager_.globalMemSize() > 0) {
+        deviceBudget = static_cast<size_t>(deviceManager_.globalMemSize() / Pool::DEVICE_BUDGET_DIVISOR);
+    }
+    pool_.setBudget(deviceBudget, hostBudget);
+}
+
+void MemoryManager::releaseBuffers() {
+    unmapFrame();
+    pool_.releaseDevice(iterationBuffer_);
+    pool_.releaseDevice(orbitBuffer_);
+    pool_.releaseDevice(pointBuffer_);
+    pool_.releaseDevice(sampleBuffer_);
+    pool_.releaseDevice(sampleResultBuffer_);
+    pool_.releaseDevice(paletteLutBuffer_);
+    pool_.releaseDevice(histogramBuffer_);
+    pool_.releaseDevice(rgbBuffer_);
+    iterationBuffer_ = nullptr;
+    orbitBuffer_ = nullptr;
+    pointBuffer_ = nullptr;
+    sampleBuffer_ = nullptr;
+    sampleResultBuffer_ = nullptr;
+    paletteLutBuffer_ = nullptr;
+    histogramBuffer_ = nullptr;
+    rgbBuffer_ = nullptr;
+    for (cl_mem buf : bandBuffers_) {
+        pool_.releaseDevice(buf);
+    }
+    bandBuffers_.clear();
+
+    pool_.releaseInts(std::move(hostIterations_));
+    pool_.releaseBytes(std::move(hostIterationBytes_));
+    pool_.releaseBytes(std::move(hostRgb_));
+    for (auto& band : hostBands_) {
+        pool_.releaseInts(std::move(band));
     }
+    hostIterations_.clear();
+    hostIterationBytes_.clear();
+    hostFormat_ = IterationFormat::U32;
+    hostRgb_.clear();
+    hostBands_.clear();
 }
 
-void MemoryManager::initialize(const RenderConfig& cfg) {
+void MemoryManager::initializeHostFrame(const RenderConfig& cfg, IterationFormat format) {
+    beginRender(cfg);
     const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
-    hostIterations_.assign(pixelCount, 0);
+    if (format == IterationFormat::U32) {
+        hostIterations_ = pool_.acquireInts(pixelCount);
+    } else {
+        hostIterationBytes_ = pool_.acquireBytes(pixelCount * iterationFormatBytes(format));
+    }
+    hostFormat_ = format;
+}
+
+IterationFrame MemoryManager::hostFrame() const {
+    IterationFrame frame;
+    frame.format = hostFormat_;
+    if (mappedFrame_) {
+        frame.data = mappedFrame_;
+        frame.pixelCount = mappedPixels_;
+    } else if (hostFormat_ == IterationFormat::U32) {
+        frame.data = hostIterations_.data();
+        frame.pixelCount = hostIterations_.size();
+    } else {
+        frame.data = hostIterationBytes_.data();
+        frame.pixelCount = hostIterationBytes_.size() / iterationFormatBytes(hostFormat_);
+    }
+    return frame;
+}
+
+void* MemoryManager::hostFrameData() {
+    if (mappedFrame_) {
+        return mappedFrame_;
+    }
+    if (hostFormat_ == IterationFormat::U32) {
+        return hostIterations_.data();
+    }
+    return hostIterationBytes_.data();
+}
+
+void MemoryManager::initializeHost(const RenderConfig& cfg) {
+    initializeHostFrame(cfg, IterationFormat::U32);
+}
 
+void MemoryManager::initialize(const RenderConfig& cfg, IterationFormat format) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    initializeHostFrame(cfg, format);
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    iterationBuffer_ = pool_.acquireDevice(pixelCount * iterationFormatBytes(format), CL_MEM_READ_WRITE);
+}
+
+void MemoryManager::initializeMapped(const RenderConfig& cfg, IterationFormat format) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    beginRender(cfg);
+    mappedPixels_ = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    hostFormat_ = format;
+    // The pool keys buffers by flags, so mapped and plain buffers never mix.
+    iterationBuffer_ = pool_.acquireDevice(mappedPixels_ * iterationFormatBytes(format),
+                                           CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR);
+}
+
+void MemoryManager::mapFrame(cl_event* evt) {
     cl_int err = CL_SUCCESS;
-    const size_t bytes = pixelCount * sizeof(int);
-    iterationBuffer_ = clCreateBuffer(deviceManager_.context(),
-                                      CL_MEM_WRITE_ONLY,
-                                      bytes,
-                                      nullptr,
-                                      &err);
-    if (err != CL_SUCCESS || !iterationBuffer_) {
-        throw std::runtime_error("Failed to create OpenCL iteration buffer");
+    void* mapped = clEnqueueMapBuffer(deviceManager_.commandQueue(), iterationBuffer_, CL_TRUE, CL_MAP_READ, 0,
+                                      mappedPixels_ * iterationFormatBytes(hostFormat_), 0, nullptr,
+                                      Trace::Command("Iteration map", evt).event(), &err);
+    if (err != CL_SUCCESS || !mapped) {
+        throw std::runtime_error("Failed to map iteration buffer");
+    }
+    mappedFrame_ = mapped;
+}
+
+void MemoryManager::unmapFrame() {
+    if (!mappedFrame_) {
+        return;
     }
+    // Finish the unmap before the buffer can go back to the pool and be
+    // written by the next render.
+    cl_command_queue queue = deviceManager_.commandQueue();
+    clEnqueueUnmapMemObject(queue, iterationBuffer_, mappedFrame_, 0, nullptr,
+                            Trace::Command("Iteration unmap").event());
+    clFinish(queue);
+    mappedFrame_ = nullptr;
+}
+
+void MemoryManager::initializeTiled(const RenderConfig& cfg, size_t tilePixels, IterationFormat format) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    initializeHostFrame(cfg, format);
+    iterationBuffer_ = pool_.acquireDevice(tilePixels * iterationFormatBytes(format), CL_MEM_READ_WRITE);
 }
 
+void MemoryManager::initializePointBatches(const RenderConfig& cfg, size_t maxPoints) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    initializeTiled(cfg, maxPoints);
+    pointBuffer_ = pool_.acquireDevice(maxPoints * 2 * sizeof(int), CL_MEM_READ_ONLY);
+}
 
+void MemoryManager::initializeSampleBatches(size_t maxSamples) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    pool_.releaseDevice(sampleBuffer_);
+    pool_.releaseDevice(sampleResultBuffer_);
+    sampleBuffer_ = pool_.acquireDevice(maxSamples * 2 * sizeof(float), CL_MEM_READ_ONLY);
+    sampleResultBuffer_ = pool_.acquireDevice(maxSamples * sizeof(int), CL_MEM_WRITE_ONLY);
+}
+
+void MemoryManager::initializePerturbation(const RenderConfig& cfg, size_t orbitBytes) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    initialize(cfg);
+    orbitBuffer_ = pool_.acquireDevice(orbitBytes, CL_MEM_READ_ONLY);
+}
+
+void MemoryManager::initializeDeviceColor(const RenderConfig& cfg, size_t lutBytes, size_t histogramBytes) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    beginRender(cfg);
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    hostRgb_ = pool_.acquireBytes(pixelCount * 3);
+    iterationBuffer_ = pool_.acquireDevice(pixelCount * sizeof(int), CL_MEM_READ_WRITE);
+    paletteLutBuffer_ = pool_.acquireDevice(lutBytes, CL_MEM_READ_ONLY);
+    rgbBuffer_ = pool_.acquireDevice(hostRgb_.size(), CL_MEM_WRITE_ONLY);
+    if (histogramBytes > 0) {
+        histogramBuffer_ = pool_.acquireDevice(histogramBytes, CL_MEM_READ_WRITE);
+    }
+}
+
+void MemoryManager::initializeBands(const RenderConfig& cfg, size_t bandPixels, int slotCount) {
+    Trace::Scope scope("Buffer allocation", "memory");
+    beginRender(cfg);
+    for (int slot = 0; slot < slotCount; ++slot) {
+        bandBuffers_.push_back(pool_.acquireDevice(bandPixels * sizeof(int), CL_MEM_WRITE_ONLY));
+        hostBands_.push_back(pool_.acquireInts(bandPixels));
+    }
+}
+
+void MemoryManager::printPoolStats() const {
+    const BufferPool::Stats& s = pool_.stats();
+    std::cout << "[Pool] device " << s.deviceHits << " hits / " << s.deviceMisses << " misses ("
+              << static_cast<double>(s.deviceBytes) / kBytesPerMiB << " MiB held), host "
+              << s.hostHits << " hits / " << s.hostMisses << " misses ("
+              << static_cast<double>(s.hostBytes) / kBytesPerMiB << " MiB held), "
+              << s.evictions << " evictions\n";
+}
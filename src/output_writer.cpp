@@ -1,160 +1,331 @@
 // OutputWriter - writes PPM/PNG images from iteration data.
-// Uses stb_image_write.h for cross-platform PNG support.
 
 #include "output_writer.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "color_histogram.h"
 #include "constants.h"
+#include "palette.h"
+#include "parallel_for.h"
+#include "trace.h"
 
-// Include stb_image_write implementation.
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "../vendor/stb_image_write.h"
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FRACTAL_COLORIZE_X86 1
+#include <immintrin.h>
+#else
+#define FRACTAL_COLORIZE_X86 0
+#endif
 
 namespace {
 
-// Simple palettes mapped from iterations.
-static void defaultPalette(float t, unsigned char& r,
-                           unsigned char& g, unsigned char& b) {
-    // Blueish gradient.
-    using namespace FractalConstants;
-    constexpr float minVal = 20.0f;
-    constexpr float maxVal = 255.0f;
-    r = static_cast<unsigned char>(minVal + (maxVal - minVal) * t);
-    g = static_cast<unsigned char>(minVal + (maxVal - minVal) * t);
-    b = static_cast<unsigned char>(80.0f + 175.0f * t);
-}
-
-static void sunsetPalette(float t, unsigned char& r,
-                          unsigned char& g, unsigned char& b) {
-    // Deep purple -> orange -> yellow.
-    using namespace FractalConstants;
-    r = static_cast<unsigned char>(Color::MAX_RGB_F * t);
-    g = static_cast<unsigned char>(80.0f + 150.0f * t);
-    b = static_cast<unsigned char>(40.0f + 60.0f * (1.0f - t));
-}
-
-static void neonPalette(float t, unsigned char& r,
-                        unsigned char& g, unsigned char& b) {
-    // Neon cyan/magenta mix.
-    using namespace FractalConstants;
-    r = static_cast<unsigned char>(Color::MAX_RGB_F * t);
-    g = static_cast<unsigned char>(Color::MAX_RGB_F * (0.5f + 0.5f * t));
-    b = static_cast<unsigned char>(Color::MAX_RGB_F * (0.2f + 0.8f * (1.0f - t)));
-}
-
-static void iterationToRGB(int iter, int maxIter, const std::string& palette,
-                           unsigned char& r, unsigned char& g, unsigned char& b) {
-    if (iter >= maxIter) {
-        // Inside the set: black.
-        r = g = b = 0;
-        return;
+bool hasSuffix(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void checkIterationCount(const RenderConfig& cfg, size_t count) {
+    if (count != static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height)) {
+        throw std::runtime_error("Iteration buffer size does not match image dimensions");
     }
+}
 
-    const float t = static_cast<float>(iter) / static_cast<float>(maxIter);
-    if (palette == "sunset") {
-        sunsetPalette(t, r, g, b);
-    } else if (palette == "neon") {
-        neonPalette(t, r, g, b);
-    } else {
-        defaultPalette(t, r, g, b);
+// Gather + pack one span of counts (int, uint16_t or uint8_t). Each entry is
+// loaded as 4 bytes from the packed table and the low 3 stored.
+template <typename Count>
+void colorizeSpanScalar(const PaletteLut& lut, const Count* iterations, size_t count, unsigned char* rgb) {
+    const uint32_t* table = lut.packed.data();
+    const int maxIter = lut.maxIterations;
+    for (size_t i = 0; i < count; ++i) {
+        const int iter = std::min(std::max(static_cast<int>(iterations[i]), 0), maxIter);
+        const uint32_t px = table[iter];
+        rgb[i * 3 + 0] = static_cast<unsigned char>(px);
+        rgb[i * 3 + 1] = static_cast<unsigned char>(px >> 8);
+        rgb[i * 3 + 2] = static_cast<unsigned char>(px >> 16);
+    }
+}
+
+// Direct LUT (no table): every pixel goes through the palette.
+template <typename Count>
+void colorizeSpanDirect(const PaletteLut& lut, const Count* iterations, size_t count, unsigned char* rgb) {
+    for (size_t i = 0; i < count; ++i) {
+        lut.color(static_cast<int>(iterations[i]), rgb + i * 3);
+    }
+}
+
+#if FRACTAL_COLORIZE_X86
+
+// Eight counts widened to 32-bit lanes.
+__attribute__((target("avx2")))
+inline __m256i loadCounts(const int* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+__attribute__((target("avx2")))
+inline __m256i loadCounts(const uint16_t* p) {
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+__attribute__((target("avx2")))
+inline __m256i loadCounts(const uint8_t* p) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+
+// 8 pixels per step: clamp, gather 8 packed entries, shuffle each 128-bit
+// half from RGBX to 12 bytes of RGB and store both halves (24 bytes). The
+// second store spills 4 bytes past the group, so the vector loop stops early
+// enough to stay inside this span.
+template <typename Count>
+__attribute__((target("avx2")))
+void colorizeSpanAvx2(const PaletteLut& lut, const Count* iterations, size_t count, unsigned char* rgb) {
+    const int* table = reinterpret_cast<const int*>(lut.packed.data());
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i maxV = _mm256_set1_epi32(lut.maxIterations);
+    const __m256i packRgb = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 11 <= count; i += 8) {
+        __m256i it = loadCounts(iterations + i);
+        it = _mm256_min_epi32(_mm256_max_epi32(it, zero), maxV);
+        const __m256i px = _mm256_shuffle_epi8(_mm256_i32gather_epi32(table, it, 4), packRgb);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + i * 3), _mm256_castsi256_si128(px));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgb + i * 3 + 12), _mm256_extracti128_si256(px, 1));
+    }
+    colorizeSpanScalar(lut, iterations + i, count - i, rgb + i * 3);
+}
+
+#endif // FRACTAL_COLORIZE_X86
+
+template <typename Count>
+using ColorizeSpanFn = void (*)(const PaletteLut&, const Count*, size_t, unsigned char*);
+
+template <typename Count>
+ColorizeSpanFn<Count> colorizeSpanFunction() {
+#if FRACTAL_COLORIZE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return colorizeSpanAvx2<Count>;
+    }
+#endif
+    return colorizeSpanScalar<Count>;
+}
+
+// Packed words: blend count n's entry with n + 1's by the fraction byte
+// (continuous count n + fraction). In-set pixels and the last escaping count
+// keep their own entry, so the in-set color never bleeds outward.
+void colorizeSpanPacked(const PaletteLut& lut, const uint32_t* words, size_t count, unsigned char* rgb) {
+    constexpr int bits = FractalConstants::IterationStorage::PACKED_FRACTION_BITS;
+    constexpr uint32_t scale = 1u << bits;
+    const int maxIter = lut.maxIterations;
+    for (size_t i = 0; i < count; ++i) {
+        const int iter = static_cast<int>(std::min<uint32_t>(words[i] >> bits, static_cast<uint32_t>(maxIter)));
+        const uint32_t f = words[i] & (scale - 1);
+        unsigned char* out = rgb + i * 3;
+        lut.color(iter, out);
+        if (f == 0 || iter + 1 >= maxIter) {
+            continue;
+        }
+        const unsigned char a[3] = {out[0], out[1], out[2]};
+        unsigned char b[3];
+        lut.color(iter + 1, b);
+        for (int c = 0; c < 3; ++c) {
+            out[c] = static_cast<unsigned char>((a[c] * (scale - f) + b[c] * f + scale / 2) >> bits);
+        }
     }
 }
 
+// Fixed-size chunks handed out to workers; each chunk writes only its own
+// slice of rgb.
+template <typename Count, typename SpanFn>
+void colorizeChunks(SpanFn colorizeSpan, const PaletteLut& lut, const Count* counts, size_t pixelCount,
+                    unsigned char* rgb, int threadCount) {
+    const size_t chunk = FractalConstants::Color::COLORIZE_CHUNK_PIXELS;
+    const int chunkCount = static_cast<int>((pixelCount + chunk - 1) / chunk);
+    parallelForDynamic(chunkCount, 1, threadCount, [&](int begin, int end) {
+        for (int c = begin; c < end; ++c) {
+            const size_t first = static_cast<size_t>(c) * chunk;
+            const size_t count = std::min(chunk, pixelCount - first);
+            colorizeSpan(lut, counts + first, count, rgb + first * 3);
+        }
+    });
+}
+
+template <typename Count>
+void colorizeCounts(const PaletteLut& lut, const Count* counts, size_t pixelCount,
+                    unsigned char* rgb, int threadCount) {
+    static const ColorizeSpanFn<Count> colorizeSpan = colorizeSpanFunction<Count>();
+    if (lut.direct()) {
+        colorizeChunks(colorizeSpanDirect<Count>, lut, counts, pixelCount, rgb, threadCount);
+        return;
+    }
+    colorizeChunks(colorizeSpan, lut, counts, pixelCount, rgb, threadCount);
+}
+
 } // namespace
 
 void OutputWriter::writeImage(const RenderConfig& cfg,
                               const std::vector<int>& iterations,
                               const std::string& path) const {
-    // Very simple extension check.
-    auto hasSuffix = [](const std::string& s, const std::string& suffix) {
-        return s.size() >= suffix.size() &&
-               s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
-    };
+    writeImage(cfg, IterationFrame{IterationFormat::U32, iterations.data(), iterations.size()}, path);
+}
+
+void OutputWriter::writeImage(const RenderConfig& cfg,
+                              const IterationFrame& frame,
+                              const std::string& path) const {
+    checkIterationCount(cfg, frame.pixelCount);
 
+    // Row-major RGB interleaved, 3 bytes per pixel (what PNG and PPM both
+    // expect).
+    std::vector<unsigned char> rgbData(frame.pixelCount * 3);
+    colorize(paletteLut(cfg, frame, cfg.threads), frame, rgbData.data(), cfg.threads);
     if (hasSuffix(path, ".png")) {
-        writePNG(cfg, iterations, path);
+        writeRGBPNG(cfg, rgbData, path);
     } else {
         // Default to PPM.
-        writePPM(cfg, iterations, path);
+        writeRGBPPM(cfg, rgbData, path);
     }
 }
 
 void OutputWriter::writePPM(const RenderConfig& cfg,
                             const std::vector<int>& iterations,
                             const std::string& path) const {
-    const int width = cfg.width;
-    const int height = cfg.height;
-    const int maxIter = std::max(1, cfg.maxIterations);
+    checkIterationCount(cfg, iterations.size());
 
-    if (static_cast<int>(iterations.size()) != width * height) {
-        throw std::runtime_error("Iteration buffer size does not match image dimensions");
+    const IterationFrame frame{IterationFormat::U32, iterations.data(), iterations.size()};
+    std::vector<unsigned char> rgbData(iterations.size() * 3);
+    colorize(paletteLut(cfg, frame, cfg.threads), frame, rgbData.data(), cfg.threads);
+    writeRGBPPM(cfg, rgbData, path);
+}
+
+void OutputWriter::writeRGBImage(const RenderConfig& cfg,
+                                 const std::vector<unsigned char>& rgb,
+                                 const std::string& path) const {
+    if (rgb.size() != static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height) * 3) {
+        throw std::runtime_error("RGB buffer size does not match image dimensions");
+    }
+
+    if (hasSuffix(path, ".png")) {
+        writeRGBPNG(cfg, rgb, path);
+    } else {
+        writeRGBPPM(cfg, rgb, path);
     }
+}
 
+void OutputWriter::writeRGBPPM(const RenderConfig& cfg,
+                               const std::vector<unsigned char>& rgb,
+                               const std::string& path) const {
+    Trace::Scope scope("Write PPM", "output");
     std::ofstream out(path, std::ios::binary);
     if (!out) {
         throw std::runtime_error("Failed to open output image file: " + path);
     }
 
-    // PPM header (P6).
-    out << "P6\n" << width << " " << height << "\n255\n";
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const int idx = y * width + x;
-            unsigned char r = 0, g = 0, b = 0;
-            iterationToRGB(iterations[idx], maxIter, cfg.palette, r, g, b);
-            out.write(reinterpret_cast<const char*>(&r), 1);
-            out.write(reinterpret_cast<const char*>(&g), 1);
-            out.write(reinterpret_cast<const char*>(&b), 1);
-        }
-    }
+    // PPM header (P6), then the whole frame in one write.
+    out << "P6\n" << cfg.width << " " << cfg.height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
 
     if (!out) {
         throw std::runtime_error("Failed while writing PPM image data");
     }
 }
 
-void OutputWriter::writePNG(const RenderConfig& cfg,
-                            const std::vector<int>& iterations,
-                            const std::string& path) const {
-    const int width = cfg.width;
-    const int height = cfg.height;
-    const int maxIter = std::max(1, cfg.maxIterations);
+void OutputWriter::writeRGBPNG(const RenderConfig& cfg,
+                               const std::vector<unsigned char>& rgb,
+                               const std::string& path) const {
+    Trace::Scope scope("Encode PNG", "output");
+    PngEncoder::write(path, rgb.data(), cfg.width, cfg.height, pngOptions(cfg));
+}
 
-    if (static_cast<int>(iterations.size()) != width * height) {
-        throw std::runtime_error("Iteration buffer size does not match image dimensions");
+std::vector<unsigned char> OutputWriter::encodeRGBImage(const RenderConfig& cfg,
+                                                       const std::vector<unsigned char>& rgb,
+                                                       const std::string& path) const {
+    Trace::Scope scope("Encode image", "output");
+    if (rgb.size() != static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height) * 3) {
+        throw std::runtime_error("RGB buffer size does not match image dimensions");
     }
 
-    // Allocate RGB buffer (row-major order, 3 bytes per pixel).
-    std::vector<unsigned char> rgbData(width * height * 3);
-
-    // Convert iterations to RGB using palette.
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const int idx = y * width + x;
-            unsigned char r = 0, g = 0, b = 0;
-            iterationToRGB(iterations[idx], maxIter, cfg.palette, r, g, b);
-            
-            // stb_image_write expects row-major, RGB interleaved.
-            const int pixelIdx = (y * width + x) * 3;
-            rgbData[pixelIdx + 0] = r;
-            rgbData[pixelIdx + 1] = g;
-            rgbData[pixelIdx + 2] = b;
-        }
+    if (hasSuffix(path, ".png")) {
+        return PngEncoder::encode(rgb.data(), cfg.width, cfg.height, pngOptions(cfg));
     }
+    const std::string header = "P6\n" + std::to_string(cfg.width) + " " + std::to_string(cfg.height) + "\n255\n";
+    std::vector<unsigned char> encoded;
+    encoded.reserve(header.size() + rgb.size());
+    encoded.insert(encoded.end(), header.begin(), header.end());
+    encoded.insert(encoded.end(), rgb.begin(), rgb.end());
+    return encoded;
+}
 
-    // Write PNG using stb_image_write.
-    const int stride = width * 3;  // Bytes per row.
-    const int result = stbi_write_png(path.c_str(), width, height, 3,
-                                      rgbData.data(), stride);
-    if (result == 0) {
-        throw std::runtime_error("Failed to write PNG image: " + path);
+PngOptions OutputWriter::pngOptions(const RenderConfig& cfg) {
+    PngOptions options;
+    options.level = cfg.pngLevel;
+    options.threads = cfg.threads;
+    if (cfg.pngFilter != "auto") {
+        options.filter = PngEncoder::filterFromName(cfg.pngFilter);
+    } else {
+        options.filter = cfg.pngLevel == 0 ? PngFilter::None : PngFilter::Adaptive;
     }
+    return options;
 }
 
+PaletteLut OutputWriter::paletteLut(const RenderConfig& cfg) const {
+    return PaletteRegistry::instance().lutFor(cfg);
+}
 
+PaletteLut OutputWriter::paletteLut(const RenderConfig& cfg, const IterationFrame& frame, int threadCount) const {
+    Trace::Scope scope("Palette LUT", "output");
+    if (cfg.coloring != "histogram") {
+        return paletteLut(cfg);
+    }
+    if (ColorHistogram::sortsCounts(frame.pixelCount, cfg.maxIterations)) {
+        auto sorted = std::make_shared<const std::vector<int>>(
+            ColorHistogram::sortedEscapes(frame, cfg.maxIterations, threadCount));
+        return PaletteRegistry::instance().lutFor(cfg, [sorted](int iter) {
+            return ColorHistogram::sortedPosition(*sorted, iter);
+        });
+    }
+    return equalizedLut(cfg, ColorHistogram::build(frame, cfg.maxIterations, threadCount), threadCount);
+}
+
+PaletteLut OutputWriter::equalizedLut(const RenderConfig& cfg, const std::vector<uint32_t>& histogram,
+                                      int threadCount) const {
+    return PaletteRegistry::instance().lutFor(cfg, ColorHistogram::equalizedPositions(histogram, threadCount));
+}
+
+void OutputWriter::colorize(const PaletteLut& lut,
+                            const int* iterations,
+                            size_t pixelCount,
+                            unsigned char* rgb,
+                            int threadCount) const {
+    Trace::Scope scope("Colorize", "output");
+    colorizeCounts(lut, iterations, pixelCount, rgb, threadCount);
+}
+
+void OutputWriter::colorize(const PaletteLut& lut,
+                            const IterationFrame& frame,
+                            unsigned char* rgb,
+                            int threadCount) const {
+    Trace::Scope scope("Colorize", "output");
+    switch (frame.format) {
+        case IterationFormat::U8:
+            colorizeCounts(lut, static_cast<const uint8_t*>(frame.data), frame.pixelCount, rgb, threadCount);
+            break;
+        case IterationFormat::U16:
+            colorizeCounts(lut, static_cast<const uint16_t*>(frame.data), frame.pixelCount, rgb, threadCount);
+            break;
+        case IterationFormat::U32:
+            colorizeCounts(lut, static_cast<const int*>(frame.data), frame.pixelCount, rgb, threadCount);
+            break;
+        case IterationFormat::Packed:
+            colorizeChunks(colorizeSpanPacked, lut, static_cast<const uint32_t*>(frame.data), frame.pixelCount,
+                           rgb, threadCount);
+            break;
+    }
+}
@@ -0,0 +1,302 @@
+// Palette implementation - built-in palettes, gradient files and LUT building.
+
+#include "palette.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "constants.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+// Blueish gradient.
+void defaultPalette(float t, unsigned char& r, unsigned char& g, unsigned char& b) {
+    constexpr float minVal = 20.0f;
+    constexpr float maxVal = 255.0f;
+    r = static_cast<unsigned char>(minVal + (maxVal - minVal) * t);
+    g = static_cast<unsigned char>(minVal + (maxVal - minVal) * t);
+    b = static_cast<unsigned char>(80.0f + 175.0f * t);
+}
+
+// Deep purple -> orange -> yellow.
+void sunsetPalette(float t, unsigned char& r, unsigned char& g, unsigned char& b) {
+    r = static_cast<unsigned char>(Color::MAX_RGB_F * t);
+    g = static_cast<unsigned char>(80.0f + 150.0f * t);
+    b = static_cast<unsigned char>(40.0f + 60.0f * (1.0f - t));
+}
+
+// Neon cyan/magenta mix.
+void neonPalette(float t, unsigned char& r, unsigned char& g, unsigned char& b) {
+    r = static_cast<unsigned char>(Color::MAX_RGB_F * t);
+    g = static_cast<unsigned char>(Color::MAX_RGB_F * (0.5f + 0.5f * t));
+    b = static_cast<unsigned char>(Color::MAX_RGB_F * (0.2f + 0.8f * (1.0f - t)));
+}
+
+// "<path> line <n>" for gradient file errors.
+std::string where(const std::string& path, int lineNo) {
+    return path + " line " + std::to_string(lineNo);
+}
+
+unsigned char parseChannel(const std::string& token, const std::string& path, int lineNo) {
+    size_t used = 0;
+    int v = -1;
+    try {
+        v = std::stoi(token, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != token.size()) {
+        throw std::runtime_error("Color channel '" + token + "' is not an integer in gradient file " +
+                                 where(path, lineNo));
+    }
+    if (v < 0 || v > Color::MAX_RGB) {
+        throw std::runtime_error("Color channel out of range in gradient file " + where(path, lineNo));
+    }
+    return static_cast<unsigned char>(v);
+}
+
+float parsePosition(const std::string& token, const std::string& path, int lineNo) {
+    size_t used = 0;
+    float position = -1.0f;
+    try {
+        position = std::stof(token, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != token.size()) {
+        throw std::runtime_error("Gradient stop position '" + token + "' is not a number in " +
+                                 where(path, lineNo));
+    }
+    if (!(position >= 0.0f && position <= 1.0f)) {
+        throw std::runtime_error("Gradient stop position out of [0, 1] in " + where(path, lineNo));
+    }
+    return position;
+}
+
+std::string fileStem(const std::string& path) {
+    const size_t slash = path.find_last_of("/\\");
+    std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+    const size_t dot = base.find_last_of('.');
+    return dot == std::string::npos ? base : base.substr(0, dot);
+}
+
+} // namespace
+
+Palette::Palette(std::string name, ColorFn fn)
+    : name_(std::move(name))
+    , fn_(std::move(fn))
+{
+}
+
+Palette::Palette(std::string name, std::vector<Stop> stops)
+    : name_(std::move(name))
+{
+    if (stops.empty()) {
+        throw std::runtime_error("Palette '" + name_ + "' has no gradient stops");
+    }
+    std::sort(stops.begin(), stops.end(),
+              [](const Stop& a, const Stop& b) { return a.position < b.position; });
+
+    fn_ = [stops](float t, unsigned char& r, unsigned char& g, unsigned char& b) {
+        auto hi = std::upper_bound(stops.begin(), stops.end(), t,
+                                   [](float v, const Stop& s) { return v < s.position; });
+        if (hi == stops.begin() || hi == stops.end()) {
+            const Stop& s = hi == stops.begin() ? stops.front() : stops.back();
+            r = s.r;
+            g = s.g;
+            b = s.b;
+            return;
+        }
+        const Stop& lo = *(hi - 1);
+        const float span = hi->position - lo.position;
+        const float f = span > 0.0f ? (t - lo.position) / span : 0.0f;
+        auto mix = [f](unsigned char a, unsigned char c) {
+            return static_cast<unsigned char>(std::lround(a + (c - a) * f));
+        };
+        r = mix(lo.r, hi->r);
+        g = mix(lo.g, hi->g);
+        b = mix(lo.b, hi->b);
+    };
+}
+
+void Palette::setInsideColor(unsigned char r, unsigned char g, unsigned char b) {
+    inside_[0] = r;
+    inside_[1] = g;
+    inside_[2] = b;
+}
+
+bool PaletteLut::tabulates(int maxIterations) {
+    return maxIterations < Color::MAX_LUT_ENTRIES;
+}
+
+void PaletteLut::color(int iter, unsigned char* out) const {
+    if (!direct()) {
+        const unsigned char* e = entry(iter);
+        std::copy(e, e + 3, out);
+        return;
+    }
+    if (iter >= maxIterations) {
+        std::copy(palette->insideColor(), palette->insideColor() + 3, out);
+        return;
+    }
+    palette->color(position(std::max(iter, 0)), out);
+}
+
+PaletteLut Palette::buildLut(int maxIterations) const {
+    const int entries = std::max(1, maxIterations);
+    // t = iter / maxIter, in [0, 1) for escaped pixels.
+    return buildLut(entries, [entries](int iter) { return static_cast<float>(iter) / static_cast<float>(entries); });
+}
+
+PaletteLut Palette::buildLut(int maxIterations, std::vector<float> positions) const {
+    if (positions.empty()) {
+        throw std::runtime_error("Palette positions need at least one escape count");
+    }
+    // Counts past the last position sit above every escaped pixel of the
+    // frame: the exclusive CDF there is 1.
+    auto shared = std::make_shared<const std::vector<float>>(std::move(positions));
+    return buildLut(maxIterations, [shared](int iter) {
+        return static_cast<size_t>(iter) < shared->size() ? (*shared)[static_cast<size_t>(iter)] : 1.0f;
+    });
+}
+
+PaletteLut Palette::buildLut(int maxIterations, std::function<float(int)> position) const {
+    PaletteLut lut;
+    lut.maxIterations = std::max(1, maxIterations);
+    if (!PaletteLut::tabulates(lut.maxIterations)) {
+        lut.palette = std::make_shared<const Palette>(*this);
+        lut.position = std::move(position);
+        return lut;
+    }
+    lut.rgb.resize(static_cast<size_t>(lut.maxIterations + 1) * 3);
+
+    for (int iter = 0; iter < lut.maxIterations; ++iter) {
+        unsigned char* e = lut.rgb.data() + static_cast<size_t>(iter) * 3;
+        fn_(position(iter), e[0], e[1], e[2]);
+    }
+    unsigned char* inside = lut.rgb.data() + static_cast<size_t>(lut.maxIterations) * 3;
+    std::copy(inside_, inside_ + 3, inside);
+
+    lut.packed.resize(static_cast<size_t>(lut.maxIterations + 1));
+    for (size_t i = 0; i < lut.packed.size(); ++i) {
+        const unsigned char* e = lut.rgb.data() + i * 3;
+        lut.packed[i] = static_cast<uint32_t>(e[0]) |
+                        (static_cast<uint32_t>(e[1]) << 8) |
+                        (static_cast<uint32_t>(e[2]) << 16);
+    }
+    return lut;
+}
+
+PaletteRegistry& PaletteRegistry::instance() {
+    static PaletteRegistry registry;
+    return registry;
+}
+
+PaletteRegistry::PaletteRegistry() {
+    add(Palette("default", defaultPalette));
+    add(Palette("sunset", sunsetPalette));
+    add(Palette("neon", neonPalette));
+}
+
+Palette PaletteRegistry::get(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = palettes_.find(name);
+    if (it == palettes_.end()) {
+        throw std::runtime_error("Unknown palette: " + name);
+    }
+    return it->second;
+}
+
+void PaletteRegistry::add(const Palette& palette) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    palettes_.insert_or_assign(palette.name(), palette);
+}
+
+Palette PaletteRegistry::loadGradientFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open gradient file: " + path);
+    }
+
+    std::string name = fileStem(path);
+    std::vector<Palette::Stop> stops;
+    unsigned char inside[3] = {0, 0, 0};
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos) {
+            line.erase(hash);
+        }
+        std::istringstream ss(line);
+        std::string first;
+        if (!(ss >> first)) {
+            continue;
+        }
+
+        std::string r, g, b;
+        if (first == "name") {
+            if (!(ss >> name)) {
+                throw std::runtime_error("Missing palette name in gradient file " + where(path, lineNo));
+            }
+        } else if (first == "inside") {
+            if (!(ss >> r >> g >> b)) {
+                throw std::runtime_error("Malformed inside color in gradient file " + where(path, lineNo));
+            }
+            inside[0] = parseChannel(r, path, lineNo);
+            inside[1] = parseChannel(g, path, lineNo);
+            inside[2] = parseChannel(b, path, lineNo);
+        } else {
+            if (!(ss >> r >> g >> b)) {
+                throw std::runtime_error("Malformed gradient stop in gradient file " + where(path, lineNo));
+            }
+            const float position = parsePosition(first, path, lineNo);
+            stops.push_back({position, parseChannel(r, path, lineNo), parseChannel(g, path, lineNo),
+                             parseChannel(b, path, lineNo)});
+        }
+    }
+
+    Palette palette(name, std::move(stops));
+    palette.setInsideColor(inside[0], inside[1], inside[2]);
+    return palette;
+}
+
+std::vector<std::string> PaletteRegistry::names() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> result;
+    for (const auto& entry : palettes_) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+bool PaletteRegistry::contains(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return palettes_.count(name) > 0;
+}
+
+PaletteLut PaletteRegistry::lutFor(const RenderConfig& cfg) {
+    return paletteFor(cfg).buildLut(cfg.maxIterations);
+}
+
+PaletteLut PaletteRegistry::lutFor(const RenderConfig& cfg, std::vector<float> positions) {
+    return paletteFor(cfg).buildLut(cfg.maxIterations, std::move(positions));
+}
+
+PaletteLut PaletteRegistry::lutFor(const RenderConfig& cfg, std::function<float(int)> position) {
+    return paletteFor(cfg).buildLut(cfg.maxIterations, std::move(position));
+}
+
+Palette PaletteRegistry::paletteFor(const RenderConfig& cfg) {
+    if (!cfg.paletteFile.empty()) {
+        return loadGradientFile(cfg.paletteFile);
+    }
+    return get(cfg.palette);  // The CLI and JSON parsers reject unknown names.
+}
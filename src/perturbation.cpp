@@ -0,0 +1,183 @@
+// Perturbation implementation - FixedPoint reference orbit and the CPU delta
+// loop. The delta loop matches perturbation_iterations in
+// kernels/perturbation.cl.
+
+#include "perturbation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+#include "fixed_point.h"
+#include "parallel_for.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+// Shortest decimal that round-trips the double (used when no exact center
+// text was given).
+std::string exactDecimal(double v) {
+    std::ostringstream ss;
+    ss.precision(std::numeric_limits<double>::max_digits10);
+    ss << v;
+    return ss.str();
+}
+
+// Fraction limbs needed to resolve one pixel at this zoom, plus guard bits.
+int fracLimbsFor(const RenderConfig& cfg) {
+    const double pixelsAcross = static_cast<double>(std::max(cfg.width, cfg.height));
+    const double depthBits = std::log2(std::max(1.0, cfg.zoom * pixelsAcross));
+    const int bits = static_cast<int>(std::ceil(depthBits)) + DeepZoom::GUARD_BITS;
+    return std::max(DeepZoom::MIN_FRAC_LIMBS, (bits + 31) / 32);
+}
+
+} // namespace
+
+ReferenceOrbit Perturbation::referenceOrbit(const RenderConfig& cfg, double offsetX, double offsetY) {
+    ReferenceOrbit orbit;
+    const int limbs = fracLimbsFor(cfg);
+    orbit.precisionBits = limbs * 32;
+    orbit.offsetX = offsetX;
+    orbit.offsetY = offsetY;
+
+    const FixedPoint centerRe = FixedPoint::fromString(
+        cfg.centerXText.empty() ? exactDecimal(cfg.centerX) : cfg.centerXText, limbs) +
+        FixedPoint::fromDouble(offsetX, limbs);
+    const FixedPoint centerIm = FixedPoint::fromString(
+        cfg.centerYText.empty() ? exactDecimal(cfg.centerY) : cfg.centerYText, limbs) +
+        FixedPoint::fromDouble(offsetY, limbs);
+
+    const bool juliaMode = cfg.fractalType == "julia";
+    FixedPoint zr = juliaMode ? centerRe : FixedPoint(limbs);
+    FixedPoint zi = juliaMode ? centerIm : FixedPoint(limbs);
+    const FixedPoint cr = juliaMode ? FixedPoint::fromDouble(cfg.juliaReal, limbs) : centerRe;
+    const FixedPoint ci = juliaMode ? FixedPoint::fromDouble(cfg.juliaImag, limbs) : centerIm;
+
+    orbit.points.reserve(static_cast<size_t>(cfg.maxIterations + 1) * 2);
+    orbit.points.push_back(zr.toDouble());
+    orbit.points.push_back(zi.toDouble());
+
+    // Always store at least Z_1, so the delta loop can index one step ahead
+    // even when the reference escapes immediately.
+    for (int n = 0; n < cfg.maxIterations; ++n) {
+        const FixedPoint zr2 = zr * zr;
+        const FixedPoint zi2 = zi * zi;
+        const FixedPoint zri = zr * zi;
+        zr = zr2 - zi2 + cr;
+        zi = zri + zri + ci;
+
+        const double re = zr.toDouble();
+        const double im = zi.toDouble();
+        orbit.points.push_back(re);
+        orbit.points.push_back(im);
+        if (re * re + im * im > Kernel::ESCAPE_RADIUS_SQUARED) {
+            break;
+        }
+    }
+    orbit.length = static_cast<int>(orbit.points.size() / 2);
+    return orbit;
+}
+
+ReferenceOrbit Perturbation::chooseReference(const RenderConfig& cfg, int threadCount) {
+    ReferenceOrbit best = referenceOrbit(cfg);
+    if (best.length - 1 >= cfg.maxIterations) {
+        return best;
+    }
+
+    // The probe covers the same view; its pixel positions map to the frame's.
+    RenderConfig probe = cfg;
+    probe.width = std::min(cfg.width, DeepZoom::PROBE_WIDTH);
+    probe.height = std::max(1, static_cast<int>(static_cast<int64_t>(cfg.height) * probe.width / cfg.width));
+    std::vector<int> counts(static_cast<size_t>(probe.width) * static_cast<size_t>(probe.height));
+    const double scaleX = Kernel::VIEWPORT_SCALE_X / cfg.zoom;
+    const double scaleY = Kernel::VIEWPORT_SCALE_Y / cfg.zoom;
+
+    // A longer orbit does not always rebase less (a reference near a minibrot
+    // nucleus passes close to zero every period), so a move is kept only when
+    // it cuts the probe's rebases.
+    uint64_t bestRebases = computeIterations(probe, best, threadCount, counts.data());
+    for (int retry = 0; retry < DeepZoom::REFERENCE_RETRIES && best.length - 1 < cfg.maxIterations; ++retry) {
+        const size_t longest = static_cast<size_t>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+        if (counts[longest] <= best.length - 1) {
+            break;  // No probe pixel outlives the current reference.
+        }
+        const double offsetX = (static_cast<double>(longest % probe.width) / probe.width - Kernel::PIXEL_OFFSET) * scaleX;
+        const double offsetY = (static_cast<double>(longest / probe.width) / probe.height - Kernel::PIXEL_OFFSET) * scaleY;
+        ReferenceOrbit candidate = referenceOrbit(cfg, offsetX, offsetY);
+        if (candidate.length <= best.length) {
+            break;
+        }
+        const uint64_t rebases = computeIterations(probe, candidate, threadCount, counts.data());
+        if (rebases >= bestRebases) {
+            break;
+        }
+        best = std::move(candidate);
+        bestRebases = rebases;
+    }
+    return best;
+}
+
+uint64_t Perturbation::computeIterations(const RenderConfig& cfg,
+                                         const ReferenceOrbit& orbit,
+                                         int threadCount,
+                                         int* out) {
+    const bool juliaMode = cfg.fractalType == "julia";
+    const double scaleX = Kernel::VIEWPORT_SCALE_X / cfg.zoom;
+    const double scaleY = Kernel::VIEWPORT_SCALE_Y / cfg.zoom;
+    const double offsetX = orbit.offsetX;
+    const double offsetY = orbit.offsetY;
+    const double* ref = orbit.points.data();
+    const int last = orbit.length - 1;
+    const double z0r = ref[0];
+    const double z0i = ref[1];
+
+    std::atomic<uint64_t> rebases{0};
+    parallelForDynamic(cfg.height, Cpu::ROWS_PER_TASK, threadCount, [&](int rowBegin, int rowEnd) {
+        uint64_t localRebases = 0;
+        for (int gy = rowBegin; gy < rowEnd; ++gy) {
+            // Pixel offsets are taken from the reference point, not the center.
+            const double dcy = (static_cast<double>(gy) / cfg.height - Kernel::PIXEL_OFFSET) * scaleY - offsetY;
+            int* row = out + static_cast<size_t>(gy) * static_cast<size_t>(cfg.width);
+            for (int gx = 0; gx < cfg.width; ++gx) {
+                const double dcx = (static_cast<double>(gx) / cfg.width - Kernel::PIXEL_OFFSET) * scaleX - offsetX;
+                // Mandelbrot: delta_0 = 0, dc added each step. Julia: delta_0 = dc.
+                double dr = juliaMode ? dcx : 0.0;
+                double di = juliaMode ? dcy : 0.0;
+                const double ar = juliaMode ? 0.0 : dcx;
+                const double ai = juliaMode ? 0.0 : dcy;
+
+                int m = 0;
+                int iter = 0;
+                double zr = z0r + dr;
+                double zi = z0i + di;
+                while (zr * zr + zi * zi <= Kernel::ESCAPE_RADIUS_SQUARED && iter < cfg.maxIterations) {
+                    const double tr = 2.0 * ref[2 * m] + dr;
+                    const double ti = 2.0 * ref[2 * m + 1] + di;
+                    const double nr = tr * dr - ti * di + ar;
+                    di = tr * di + ti * dr + ai;
+                    dr = nr;
+                    ++m;
+                    ++iter;
+
+                    zr = ref[2 * m] + dr;
+                    zi = ref[2 * m + 1] + di;
+                    if (zr * zr + zi * zi < dr * dr + di * di || m == last) {
+                        dr = zr - z0r;
+                        di = zi - z0i;
+                        m = 0;
+                        ++localRebases;
+                    }
+                }
+                row[gx] = iter;
+            }
+        }
+        rebases.fetch_add(localRebases, std::memory_order_relaxed);
+    });
+    return rebases.load();
+}
@@ -0,0 +1,308 @@
+// PngEncoder implementation - row filters, chunked deflate and PNG framing.
+
+#include "png_encoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include <zlib.h>
+
+#include "constants.h"
+#include "parallel_for.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+constexpr size_t kBytesPerPixel = 3;
+constexpr int kFilterRowGrain = 16;  // Rows per dynamically scheduled filter job.
+
+struct FilterName {
+    PngFilter filter;
+    const char* name;
+};
+
+const FilterName kFilterNames[] = {
+    {PngFilter::None, "none"},       {PngFilter::Sub, "sub"},     {PngFilter::Up, "up"},
+    {PngFilter::Average, "average"}, {PngFilter::Paeth, "paeth"}, {PngFilter::Adaptive, "adaptive"},
+};
+
+int paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Filter row into dst (without the type byte) and return the adaptive cost:
+// the sum of the filtered bytes read as signed magnitudes.
+template <int Type>
+unsigned filterInto(const unsigned char* row, const unsigned char* prev, size_t n, unsigned char* dst) {
+    unsigned cost = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const int a = i >= kBytesPerPixel ? row[i - kBytesPerPixel] : 0;
+        const int b = prev ? prev[i] : 0;
+        const int c = (prev && i >= kBytesPerPixel) ? prev[i - kBytesPerPixel] : 0;
+        int predictor = 0;
+        if (Type == 1) {
+            predictor = a;
+        } else if (Type == 2) {
+            predictor = b;
+        } else if (Type == 3) {
+            predictor = (a + b) >> 1;
+        } else if (Type == 4) {
+            predictor = paeth(a, b, c);
+        }
+        const unsigned char v = static_cast<unsigned char>(row[i] - predictor);
+        dst[i] = v;
+        cost += static_cast<unsigned>(std::abs(static_cast<signed char>(v)));
+    }
+    return cost;
+}
+
+unsigned filterAs(int type, const unsigned char* row, const unsigned char* prev, size_t n, unsigned char* out) {
+    out[0] = static_cast<unsigned char>(type);
+    switch (type) {
+        case 1: return filterInto<1>(row, prev, n, out + 1);
+        case 2: return filterInto<2>(row, prev, n, out + 1);
+        case 3: return filterInto<3>(row, prev, n, out + 1);
+        case 4: return filterInto<4>(row, prev, n, out + 1);
+        default: return filterInto<0>(row, prev, n, out + 1);
+    }
+}
+
+// zlib stream header (RFC 1950): deflate with a 32 KiB window, FLEVEL as
+// zlib itself would set it for level, FCHECK making it a multiple of 31.
+void zlibHeader(int level, unsigned char* out) {
+    const unsigned flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    unsigned header = (0x78u << 8) | (flevel << 6);
+    header += 31 - header % 31;
+    out[0] = static_cast<unsigned char>(header >> 8);
+    out[1] = static_cast<unsigned char>(header);
+}
+
+// One deflated chunk of the filtered image, ready to become an IDAT.
+struct Segment {
+    std::vector<unsigned char> data;
+    uLong adler = 0;  // Adler-32 of the chunk's uncompressed bytes.
+    uLong crc = 0;    // CRC of "IDAT" + data.
+};
+
+// Raw-deflate filtered[begin, end) into segment. Chunks other than the last
+// end with a sync flush (byte aligned, no final block); the first one starts
+// with the zlib header.
+void deflateChunk(const std::vector<unsigned char>& filtered, size_t begin, size_t end, bool last,
+                  const PngOptions& options, Segment& segment) {
+    z_stream zs{};
+    // Z_FILTERED suits filtered rows (small values, few long matches).
+    const int strategy = options.filter == PngFilter::None ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    if (deflateInit2(&zs, options.level, Z_DEFLATED, -MAX_WBITS, Png::MEM_LEVEL, strategy) != Z_OK) {
+        throw std::runtime_error("Failed to initialize PNG deflate stream");
+    }
+    if (begin > 0 && options.level > 0) {
+        const size_t window = std::min(begin, Png::WINDOW_BYTES);
+        deflateSetDictionary(&zs, filtered.data() + begin - window, static_cast<uInt>(window));
+    }
+
+    const size_t headerBytes = begin == 0 ? 2 : 0;
+    const size_t length = end - begin;
+    std::vector<unsigned char>& out = segment.data;
+    out.resize(headerBytes + deflateBound(&zs, static_cast<uLong>(length)) + Png::FLUSH_SLACK_BYTES);
+    if (headerBytes > 0) {
+        zlibHeader(options.level, out.data());
+    }
+
+    zs.next_in = const_cast<Bytef*>(filtered.data() + begin);
+    zs.avail_in = static_cast<uInt>(length);
+    size_t produced = headerBytes;
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    for (;;) {
+        zs.next_out = out.data() + produced;
+        zs.avail_out = static_cast<uInt>(out.size() - produced);
+        const int ret = deflate(&zs, flush);
+        produced = out.size() - zs.avail_out;
+        if (ret == Z_STREAM_ERROR) {
+            deflateEnd(&zs);
+            throw std::runtime_error("PNG deflate failed");
+        }
+        const bool done = last ? ret == Z_STREAM_END : (zs.avail_in == 0 && zs.avail_out > 0);
+        if (done) {
+            break;
+        }
+        out.resize(out.size() * 2);
+    }
+    deflateEnd(&zs);
+    out.resize(produced);
+
+    segment.adler = adler32(adler32(0L, Z_NULL, 0), filtered.data() + begin, static_cast<uInt>(length));
+    segment.crc = crc32(crc32(0L, reinterpret_cast<const Bytef*>("IDAT"), 4), out.data(),
+                        static_cast<uInt>(out.size()));
+}
+
+} // namespace
+
+void PngEncoder::putBigEndian(unsigned char* p, uint32_t v) {
+    p[0] = static_cast<unsigned char>(v >> 24);
+    p[1] = static_cast<unsigned char>(v >> 16);
+    p[2] = static_cast<unsigned char>(v >> 8);
+    p[3] = static_cast<unsigned char>(v);
+}
+
+void PngEncoder::appendHeader(std::vector<unsigned char>& png, int width, int height) {
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    png.insert(png.end(), signature, signature + sizeof(signature));
+
+    unsigned char ihdr[13];
+    putBigEndian(ihdr, static_cast<uint32_t>(width));
+    putBigEndian(ihdr + 4, static_cast<uint32_t>(height));
+    ihdr[8] = 8;   // Bit depth.
+    ihdr[9] = 2;   // Color type: RGB.
+    ihdr[10] = 0;  // Deflate.
+    ihdr[11] = 0;  // Adaptive filtering.
+    ihdr[12] = 0;  // No interlace.
+    appendChunk(png, "IHDR", ihdr, sizeof(ihdr));
+}
+
+void PngEncoder::appendChunk(std::vector<unsigned char>& png, const char type[4], const unsigned char* data,
+                             size_t len, unsigned long crc) {
+    unsigned char header[8];
+    putBigEndian(header, static_cast<uint32_t>(len));
+    std::copy(type, type + 4, header + 4);
+    png.insert(png.end(), header, header + sizeof(header));
+    if (len > 0) {
+        png.insert(png.end(), data, data + len);
+    }
+    unsigned char crcBytes[4];
+    putBigEndian(crcBytes, static_cast<uint32_t>(crc));
+    png.insert(png.end(), crcBytes, crcBytes + sizeof(crcBytes));
+}
+
+void PngEncoder::appendChunk(std::vector<unsigned char>& png, const char type[4], const unsigned char* data,
+                             size_t len) {
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(type), 4);
+    if (len > 0) {
+        crc = crc32(crc, data, static_cast<uInt>(len));
+    }
+    appendChunk(png, type, data, len, crc);
+}
+
+void PngEncoder::filterRow(PngFilter filter, const unsigned char* row, const unsigned char* prev, size_t rowBytes,
+                           unsigned char* out, unsigned char* scratch) {
+    if (filter != PngFilter::Adaptive) {
+        filterAs(static_cast<int>(filter), row, prev, rowBytes, out);
+        return;
+    }
+    // Each candidate goes into whichever buffer does not hold the best so far.
+    unsigned char* best = out;
+    unsigned char* candidate = scratch;
+    unsigned bestCost = filterAs(0, row, prev, rowBytes, best);
+    for (int type = 1; type <= 4; ++type) {
+        const unsigned cost = filterAs(type, row, prev, rowBytes, candidate);
+        if (cost < bestCost) {
+            bestCost = cost;
+            std::swap(best, candidate);
+        }
+    }
+    if (best != out) {
+        std::copy(best, best + 1 + rowBytes, out);
+    }
+}
+
+std::vector<unsigned char> PngEncoder::encode(const unsigned char* rgb, int width, int height,
+                                              const PngOptions& options) {
+    if (width <= 0 || height <= 0) {
+        throw std::runtime_error("PNG dimensions must be positive");
+    }
+    if (options.level < 0 || options.level > 9) {
+        throw std::runtime_error("PNG compression level must be 0..9");
+    }
+    const size_t rowBytes = static_cast<size_t>(width) * kBytesPerPixel;
+    const size_t filteredRowBytes = 1 + rowBytes;
+
+    // Rows only read the source image, so they filter independently.
+    std::vector<unsigned char> filtered(static_cast<size_t>(height) * filteredRowBytes);
+    parallelForDynamic(height, kFilterRowGrain, options.threads, [&](int begin, int end) {
+        std::vector<unsigned char> scratch(options.filter == PngFilter::Adaptive ? filteredRowBytes : 0);
+        for (int y = begin; y < end; ++y) {
+            const unsigned char* row = rgb + static_cast<size_t>(y) * rowBytes;
+            filterRow(options.filter, row, y > 0 ? row - rowBytes : nullptr, rowBytes,
+                      filtered.data() + static_cast<size_t>(y) * filteredRowBytes, scratch.data());
+        }
+    });
+
+    const size_t chunkCount = (filtered.size() + Png::CHUNK_BYTES - 1) / Png::CHUNK_BYTES;
+    std::vector<Segment> segments(chunkCount);
+    parallelForDynamic(static_cast<int>(chunkCount), 1, options.threads, [&](int begin, int end) {
+        for (int c = begin; c < end; ++c) {
+            const size_t from = static_cast<size_t>(c) * Png::CHUNK_BYTES;
+            const size_t to = std::min(filtered.size(), from + Png::CHUNK_BYTES);
+            deflateChunk(filtered, from, to, static_cast<size_t>(c) + 1 == chunkCount, options,
+                         segments[static_cast<size_t>(c)]);
+        }
+    });
+
+    // The zlib trailer is the Adler-32 of the whole filtered image; it ends
+    // the last IDAT, whose CRC simply continues over it.
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        const size_t length = std::min(filtered.size() - c * Png::CHUNK_BYTES, Png::CHUNK_BYTES);
+        adler = adler32_combine(adler, segments[c].adler, static_cast<z_off_t>(length));
+    }
+    unsigned char trailer[4];
+    putBigEndian(trailer, static_cast<uint32_t>(adler));
+    Segment& last = segments.back();
+    last.data.insert(last.data.end(), trailer, trailer + sizeof(trailer));
+    last.crc = crc32(last.crc, trailer, sizeof(trailer));
+
+    size_t total = 8 + 25 + 12;  // Signature, IHDR and IEND.
+    for (const Segment& segment : segments) {
+        total += 12 + segment.data.size();
+    }
+    std::vector<unsigned char> png;
+    png.reserve(total);
+    appendHeader(png, width, height);
+    for (const Segment& segment : segments) {
+        appendChunk(png, "IDAT", segment.data.data(), segment.data.size(), segment.crc);
+    }
+    appendChunk(png, "IEND", nullptr, 0);
+    return png;
+}
+
+void PngEncoder::write(const std::string& path, const unsigned char* rgb, int width, int height,
+                       const PngOptions& options) {
+    const std::vector<unsigned char> png = encode(rgb, width, height, options);
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open output image file: " + path);
+    }
+    out.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    if (!out) {
+        throw std::runtime_error("Failed while writing PNG image data");
+    }
+}
+
+PngFilter PngEncoder::filterFromName(const std::string& name) {
+    for (const FilterName& entry : kFilterNames) {
+        if (name == entry.name) {
+            return entry.filter;
+        }
+    }
+    throw std::runtime_error("Unknown PNG filter: " + name);
+}
+
+const char* PngEncoder::filterName(PngFilter filter) {
+    for (const FilterName& entry : kFilterNames) {
+        if (filter == entry.filter) {
+            return entry.name;
+        }
+    }
+    return "adaptive";
+}
@@ -0,0 +1,69 @@
+// PrecisionTier implementation - tier names and depth-based selection.
+
+#include "precision_tier.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+
+#include "constants.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+} // namespace
+
+std::string precisionTierName(PrecisionTier tier) {
+    switch (tier) {
+        case PrecisionTier::Float: return "float";
+        case PrecisionTier::DoubleFloat: return "double-float";
+        case PrecisionTier::Double: return "double";
+        case PrecisionTier::Perturbation: return "perturbation";
+    }
+    return "float";
+}
+
+PrecisionTier precisionTierFromName(const std::string& name) {
+    for (PrecisionTier tier : {PrecisionTier::Float, PrecisionTier::DoubleFloat,
+                               PrecisionTier::Double, PrecisionTier::Perturbation}) {
+        if (precisionTierName(tier) == name) {
+            return tier;
+        }
+    }
+    throw std::runtime_error("Unknown precision: " + name);
+}
+
+int precisionTierBits(PrecisionTier tier) {
+    switch (tier) {
+        case PrecisionTier::Float: return Precision::FLOAT_MANTISSA_BITS;
+        case PrecisionTier::DoubleFloat: return Precision::DOUBLE_FLOAT_MANTISSA_BITS;
+        case PrecisionTier::Double: return Precision::DOUBLE_MANTISSA_BITS;
+        case PrecisionTier::Perturbation: return INT_MAX;
+    }
+    return 0;
+}
+
+int requiredPrecisionBits(const RenderConfig& cfg) {
+    const double spacing = std::min(Kernel::VIEWPORT_SCALE_X / (cfg.zoom * cfg.width),
+                                    Kernel::VIEWPORT_SCALE_Y / (cfg.zoom * cfg.height));
+    // Orbit values near the boundary are O(1) whatever the center, so that is
+    // the smallest magnitude whose ulp matters.
+    const double magnitude = std::max({std::fabs(cfg.centerX), std::fabs(cfg.centerY), Precision::MIN_ORBIT_MAGNITUDE});
+    const double bits = std::log2(magnitude / spacing * Precision::MIN_ULPS_PER_PIXEL);
+    return std::max(1, static_cast<int>(std::ceil(bits)));
+}
+
+PrecisionTier choosePrecisionTier(const RenderConfig& cfg, const std::vector<PrecisionTier>& candidates) {
+    if (cfg.precision != "auto") {
+        return precisionTierFromName(cfg.precision);
+    }
+    const int bits = requiredPrecisionBits(cfg);
+    for (PrecisionTier tier : candidates) {
+        if (precisionTierBits(tier) >= bits) {
+            return tier;
+        }
+    }
+    return PrecisionTier::Perturbation;
+}
@@ -0,0 +1,187 @@
+// ProgramCache implementation - binary cache files under a cache directory.
+//
+// File layout: magic, key length + key text, binary length + binary bytes.
+// The full key is stored and compared on load, so a hash collision in the
+// file name can only cost a rebuild, never a wrong binary.
+
+#include "program_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+#include "constants.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+constexpr char kMagic[8] = {'F', 'R', 'C', 'L', 'B', 'I', 'N', '1'};
+
+uint64_t fnv1a(const std::string& data) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string hex(uint64_t v) {
+    std::ostringstream ss;
+    ss << std::hex << v;
+    return ss.str();
+}
+
+std::string deviceString(cl_device_id device, cl_device_info param) {
+    size_t size = 0;
+    if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0) {
+        return "";
+    }
+    std::string value(size, '\0');
+    clGetDeviceInfo(device, param, size, &value[0], nullptr);
+    value.resize(value.find('\0') == std::string::npos ? value.size() : value.find('\0'));
+    return value;
+}
+
+bool readU64(std::istream& in, uint64_t& v) {
+    unsigned char b[8];
+    if (!in.read(reinterpret_cast<char*>(b), sizeof(b))) {
+        return false;
+    }
+    v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | b[i];
+    }
+    return true;
+}
+
+void writeU64(std::ostream& out, uint64_t v) {
+    unsigned char b[8];
+    for (int i = 0; i < 8; ++i) {
+        b[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+    out.write(reinterpret_cast<const char*>(b), sizeof(b));
+}
+
+} // namespace
+
+ProgramCache::ProgramCache(std::string directory)
+    : directory_(std::move(directory)) {}
+
+std::string ProgramCache::makeKey(cl_device_id device,
+                                  const std::string& source,
+                                  const std::string& options) {
+    std::ostringstream key;
+    key << "device=" << deviceString(device, CL_DEVICE_NAME) << "\n"
+        << "vendor=" << deviceString(device, CL_DEVICE_VENDOR) << "\n"
+        << "driver=" << deviceString(device, CL_DRIVER_VERSION) << "\n"
+        << "options=" << options << "\n"
+        << "source=" << hex(fnv1a(source)) << ":" << source.size() << "\n";
+    return key.str();
+}
+
+std::string ProgramCache::entryPath(const std::string& name, const std::string& key) const {
+    return directory_ + "/" + name + "-" + hex(fnv1a(key)) + ".bin";
+}
+
+cl_program ProgramCache::load(const std::string& name,
+                              const std::string& key,
+                              cl_context context,
+                              cl_device_id device,
+                              const std::string& options) const {
+    if (!enabled()) {
+        return nullptr;
+    }
+    std::ifstream in(entryPath(name, key), std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+
+    char magic[sizeof(kMagic)];
+    uint64_t keyLen = 0;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic) ||
+        !readU64(in, keyLen) || keyLen != key.size()) {
+        return nullptr;
+    }
+    std::string storedKey(keyLen, '\0');
+    uint64_t binLen = 0;
+    if (!in.read(&storedKey[0], static_cast<std::streamsize>(keyLen)) || storedKey != key ||
+        !readU64(in, binLen) || binLen == 0 || binLen > KernelCache::MAX_BINARY_BYTES) {
+        return nullptr;
+    }
+    std::vector<unsigned char> binary(binLen);
+    if (!in.read(reinterpret_cast<char*>(binary.data()), static_cast<std::streamsize>(binLen))) {
+        return nullptr;
+    }
+
+    const unsigned char* binPtr = binary.data();
+    const size_t binSize = binary.size();
+    cl_int binStatus = CL_SUCCESS;
+    cl_int err = CL_SUCCESS;
+    cl_program program = clCreateProgramWithBinary(context, 1, &device, &binSize, &binPtr, &binStatus, &err);
+    if (err != CL_SUCCESS || binStatus != CL_SUCCESS || !program) {
+        if (program) {
+            clReleaseProgram(program);
+        }
+        return nullptr;
+    }
+    // Binaries still need a build step (it links/finalizes, and is fast).
+    if (clBuildProgram(program, 1, &device, options.c_str(), nullptr, nullptr) != CL_SUCCESS) {
+        clReleaseProgram(program);
+        return nullptr;
+    }
+    return program;
+}
+
+void ProgramCache::store(const std::string& name, const std::string& key, cl_program program) const {
+    if (!enabled()) {
+        return;
+    }
+
+    size_t binSize = 0;
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(binSize), &binSize, nullptr) != CL_SUCCESS ||
+        binSize == 0) {
+        std::cout << "[Kernels] " << name << ": driver returned no program binary; not cached\n";
+        return;
+    }
+    std::vector<unsigned char> binary(binSize);
+    unsigned char* binPtr = binary.data();
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binPtr), &binPtr, nullptr) != CL_SUCCESS) {
+        std::cout << "[Kernels] " << name << ": failed to read program binary; not cached\n";
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    const std::string path = entryPath(name, key);
+    // Write a temporary file and rename it into place so concurrent runs
+    // never see a partial entry.
+    const uint64_t unique = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+                            static_cast<uint64_t>(reinterpret_cast<uintptr_t>(program));
+    const std::string tmpPath = path + ".tmp" + hex(unique);
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        out.write(kMagic, sizeof(kMagic));
+        writeU64(out, key.size());
+        out.write(key.data(), static_cast<std::streamsize>(key.size()));
+        writeU64(out, binary.size());
+        out.write(reinterpret_cast<const char*>(binary.data()), static_cast<std::streamsize>(binary.size()));
+        if (!out) {
+            std::cout << "[Kernels] " << name << ": failed to write cache entry " << tmpPath << "\n";
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::cout << "[Kernels] " << name << ": failed to install cache entry " << path << "\n";
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
@@ -0,0 +1,367 @@
+// RenderServer implementation - request queue, job contexts and transports
+// (line streams and Unix domain sockets).
+
+#include "render_server.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include "constants.h"
+#include "fractal_strategy.h"
+#include "json_config.h"
+#include "palette.h"
+#include "parallel_for.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FRACTAL_HAS_UNIX_SOCKETS 1
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#else
+#define FRACTAL_HAS_UNIX_SOCKETS 0
+#endif
+
+namespace {
+
+using namespace FractalConstants;
+
+std::string base64Encode(const std::vector<unsigned char>& data) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        const uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += alphabet[(v >> 18) & 63];
+        out += alphabet[(v >> 12) & 63];
+        out += alphabet[(v >> 6) & 63];
+        out += alphabet[v & 63];
+    }
+    if (i < data.size()) {
+        const uint32_t v = (data[i] << 16) | (i + 1 < data.size() ? data[i + 1] << 8 : 0);
+        out += alphabet[(v >> 18) & 63];
+        out += alphabet[(v >> 12) & 63];
+        out += i + 1 < data.size() ? alphabet[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+std::string formatOf(const std::string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0 ? "png" : "ppm";
+}
+
+// Fields a request may carry that are not RenderConfig fields.
+const std::map<std::string, bool>& protocolKeys() {
+    static const std::map<std::string, bool> keys = {{"id", true}, {"response", true}};
+    return keys;
+}
+
+// Request-supplied paths must stay below the daemon's working directory:
+// relative, with no ".." component.
+void checkRequestPath(const JsonObject& request, const std::string& key) {
+    auto it = request.find(key);
+    if (it == request.end()) {
+        return;
+    }
+    const std::string& path = it->second.text;
+    bool contained = !path.empty() && path[0] != '/' && path[0] != '\\' && path.find(':') == std::string::npos;
+    size_t start = 0;
+    while (contained && start <= path.size()) {
+        const size_t end = std::min(path.find_first_of("/\\", start), path.size());
+        contained = path.compare(start, end - start, "..") != 0;
+        start = end + 1;
+    }
+    if (!contained) {
+        throw std::runtime_error("Field '" + key + "' must be a relative path inside the server directory");
+    }
+}
+
+std::atomic<bool> stopRequested{false};
+
+void requestStop(int) {
+    stopRequested = true;
+}
+
+} // namespace
+
+RenderServer::JobContext::JobContext(DeviceManager& deviceManager)
+    : memory(deviceManager)
+    , renderer(deviceManager, kernels, memory)
+{
+}
+
+RenderServer::RenderServer(DeviceManager& deviceManager, const RenderConfig& defaults)
+    : deviceManager_(deviceManager)
+    , defaults_(defaults)
+{
+    const bool useDevice = defaults_.backend != "cpu";
+    int jobs = defaults_.serverJobs;
+    if (jobs <= 0) {
+        // The CPU backend already uses every core per job; on OpenCL a second
+        // job lets one request's host color/encode overlap another's kernel.
+        jobs = useDevice ? Server::OPENCL_JOBS : 1;
+    }
+
+    for (int i = 0; i < jobs; ++i) {
+        auto context = std::make_unique<JobContext>(deviceManager_);
+        if (useDevice) {
+            // Kernel objects hold per-job arguments, so every job builds its
+            // own (served from the binary cache after the first).
+            context->kernels.initialize("kernels", deviceManager_.context(), deviceManager_.device(),
+                                        defaults_.kernelCacheDir);
+        }
+        idleContexts_.push_back(context.get());
+        contexts_.push_back(std::move(context));
+    }
+    const size_t depth = defaults_.queueDepth > 0 ? static_cast<size_t>(defaults_.queueDepth)
+                                                  : Server::QUEUE_DEPTH;
+    workers_ = std::make_unique<WorkerPool>(jobs, depth);
+    std::cout << "[Server] Ready: " << jobs << " concurrent job(s), queue depth " << depth
+              << ", backend " << defaults_.backend << "\n";
+}
+
+RenderServer::JobContext* RenderServer::checkout() {
+    // Workers and contexts are equal in number, so one is always idle here.
+    std::lock_guard<std::mutex> lock(contextMutex_);
+    JobContext* context = idleContexts_.back();
+    idleContexts_.pop_back();
+    return context;
+}
+
+void RenderServer::checkin(JobContext* context) {
+    std::lock_guard<std::mutex> lock(contextMutex_);
+    idleContexts_.push_back(context);
+}
+
+void RenderServer::submit(const std::string& line, Responder respond) {
+    workers_->submit([this, line, respond] { respond(handle(line)); });
+}
+
+std::string RenderServer::handle(const std::string& line) {
+    std::string id = "null";
+    try {
+        const JsonObject request = parseJsonObject(line);
+        auto idIt = request.find("id");
+        if (idIt != request.end()) {
+            id = jsonValue(idIt->second);
+        }
+        bool returnBytes = false;
+        auto respIt = request.find("response");
+        if (respIt != request.end()) {
+            if (respIt->second.text != "path" && respIt->second.text != "bytes") {
+                throw std::runtime_error("response must be \"path\" or \"bytes\"");
+            }
+            returnBytes = respIt->second.text == "bytes";
+        }
+        RenderConfig cfg = applyJsonConfig(request, defaults_, protocolKeys());
+        checkRequestPath(request, "outputPath");
+        checkRequestPath(request, "paletteFile");
+        if (static_cast<int64_t>(cfg.width) * cfg.height > int64_t{defaults_.serverMaxMegapixels} * 1000000) {
+            throw std::runtime_error("width x height exceeds the server limit of " +
+                                     std::to_string(defaults_.serverMaxMegapixels) + " megapixels");
+        }
+        if (cfg.maxIterations > defaults_.serverMaxIterations) {
+            throw std::runtime_error("maxIterations exceeds the server limit of " +
+                                     std::to_string(defaults_.serverMaxIterations));
+        }
+        // threads only sizes worker pools; more than the cores buys nothing.
+        cfg.threads = std::min(cfg.threads, resolveThreadCount(0));
+        if (!cfg.paletteFile.empty()) {
+            PaletteRegistry::loadGradientFile(cfg.paletteFile);  // Reject before taking a job.
+        }
+
+        JobContext* context = checkout();
+        std::string body;
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            if (cfg.fractalType == "julia") {
+                context->renderer.setStrategy(std::make_unique<JuliaStrategy>());
+            } else {
+                context->renderer.setStrategy(std::make_unique<MandelbrotStrategy>());
+            }
+            if (returnBytes) {
+                const std::vector<unsigned char> image = context->renderer.renderEncoded(cfg);
+                body = "\"format\":" + jsonQuote(formatOf(cfg.outputPath)) +
+                       ",\"size\":" + std::to_string(image.size()) +
+                       ",\"data\":\"" + base64Encode(image) + "\"";
+            } else {
+                context->renderer.render(cfg);
+                body = "\"path\":" + jsonQuote(resolveOutputPath(cfg));
+            }
+        } catch (...) {
+            checkin(context);
+            throw;
+        }
+        checkin(context);
+
+        const double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "[Server] Request " << id << " done in " << ms << " ms\n";
+        return "{\"id\":" + id + ",\"status\":\"ok\"," + body + ",\"ms\":" + std::to_string(ms) + "}";
+    } catch (const std::exception& ex) {
+        std::cout << "[Server] Request " << id << " failed: " << ex.what() << "\n";
+        return "{\"id\":" + id + ",\"status\":\"error\",\"error\":" + jsonQuote(ex.what()) + "}";
+    }
+}
+
+void RenderServer::serve(std::istream& in, std::ostream& out) {
+    std::mutex outMutex;
+    auto respond = [&out, &outMutex](const std::string& response) {
+        std::lock_guard<std::mutex> lock(outMutex);
+        out << response << "\n";
+        out.flush();
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        submit(line, respond);
+    }
+    workers_->wait();
+}
+
+#if FRACTAL_HAS_UNIX_SOCKETS
+
+namespace {
+
+// One client connection; the fd closes when the reader and every in-flight
+// response are done with it.
+struct Connection {
+    explicit Connection(int socketFd) : fd(socketFd) {}
+    ~Connection() { close(fd); }
+
+    void send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size()) {
+#ifdef MSG_NOSIGNAL
+            const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#else
+            const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, 0);
+#endif
+            if (n <= 0) {
+                return;  // Client went away; drop the response.
+            }
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    int fd;
+    std::mutex mutex;
+};
+
+// Wait until fd is readable or a stop was requested; false on stop.
+bool waitReadable(int fd) {
+    while (!stopRequested) {
+        pollfd p{fd, POLLIN, 0};
+        const int ready = poll(&p, 1, Server::POLL_INTERVAL_MS);
+        if (ready > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void RenderServer::serveSocket(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        throw std::runtime_error("Failed to create Unix socket");
+    }
+    unlink(path.c_str());  // Remove a stale socket from a previous run.
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd, Server::SOCKET_BACKLOG) != 0) {
+        close(listenFd);
+        throw std::runtime_error("Failed to listen on Unix socket: " + path);
+    }
+
+    stopRequested = false;
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::cout << "[Server] Listening on " << path << "\n";
+
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::vector<Reader> readers;
+    while (waitReadable(listenFd)) {
+        const int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+        // Join readers whose clients have disconnected.
+        for (auto it = readers.begin(); it != readers.end();) {
+            if (*it->done) {
+                it->thread.join();
+                it = readers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        auto connection = std::make_shared<Connection>(clientFd);
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        readers.push_back({std::thread([this, connection, done] {
+            Responder respond = [connection](const std::string& response) { connection->send(response); };
+            std::string pending;
+            char chunk[Server::READ_CHUNK_BYTES];
+            while (waitReadable(connection->fd)) {
+                const ssize_t n = recv(connection->fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    break;
+                }
+                pending.append(chunk, static_cast<size_t>(n));
+                size_t newline = 0;
+                while ((newline = pending.find('\n')) != std::string::npos) {
+                    const std::string line = pending.substr(0, newline);
+                    pending.erase(0, newline + 1);
+                    if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                        submit(line, respond);
+                    }
+                }
+                if (pending.size() > Server::MAX_REQUEST_BYTES) {
+                    respond("{\"id\":null,\"status\":\"error\",\"error\":\"request line too long\"}");
+                    break;
+                }
+            }
+            *done = true;
+        }), done});
+    }
+
+    for (auto& reader : readers) {
+        reader.thread.join();
+    }
+    workers_->wait();
+    close(listenFd);
+    unlink(path.c_str());
+    std::cout << "[Server] Stopped\n";
+}
+
+#else
+
+void RenderServer::serveSocket(const std::string& path) {
+    throw std::runtime_error("Unix domain sockets are not available on this platform: " + path);
+}
+
+#endif // FRACTAL_HAS_UNIX_SOCKETS
@@ -2,11 +2,34 @@
 
 #include "renderer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
+#include "color_histogram.h"
+#include "constants.h"
+#include "cpu_renderer.h"
+#include "device_set.h"
+#include "edge_antialias.h"
+#include "image_stream.h"
+#include "interior_check.h"
+#include "iteration_field.h"
+#include "kernel_args.h"
+#include "mariani_silver.h"
 #include "output_writer.h"
+#include "parallel_for.h"
+#include "perturbation.h"
+#include "trace.h"
+#include "work_group_tuning.h"
+#include "worker_pool.h"
 
 Renderer::Renderer(DeviceManager& deviceManager,
                    KernelManager& kernelManager,
@@ -21,25 +44,162 @@ void Renderer::setStrategy(std::unique_ptr<FractalStrategy> strategy) {
     strategy_ = std::move(strategy);
 }
 
+void Renderer::setDeviceSet(DeviceSet* devices) {
+    deviceSet_ = devices;
+}
+
 namespace {
 
-void printKernelTimeMs(const char* label, cl_event evt) {
-    if (!evt) {
-        return;
-    }
+using namespace FractalConstants;
+
+void printTimeMs(const char* label, double ms, size_t pixelCount, const std::string& detail = "") {
+    const double mpixPerSec = ms > 0.0 ? static_cast<double>(pixelCount) / (ms * 1e3) : 0.0;
+    std::cout << "[" << label << "] " << ms << " ms (" << mpixPerSec << " Mpixel/s"
+              << (detail.empty() ? "" : ", " + detail) << ")\n";
+}
+
+double eventTimeMs(cl_event evt) {
     cl_ulong startNs = 0;
     cl_ulong endNs = 0;
     clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_START,
                             sizeof(startNs), &startNs, nullptr);
     clGetEventProfilingInfo(evt, CL_PROFILING_COMMAND_END,
                             sizeof(endNs), &endNs, nullptr);
-    const double ms = static_cast<double>(endNs - startNs) * 1e-6;
-    std::cout << "[" << label << "] " << ms << " ms\n";
+    return static_cast<double>(endNs - startNs) * 1e-6;
+}
+
+void printKernelTimeMs(const char* label, cl_event evt, size_t pixelCount) {
+    if (!evt) {
+        return;
+    }
+    printTimeMs(label, eventTimeMs(evt), pixelCount);
+}
+
+// Storage format for tier's iteration kernel: compact formats come from the
+// float kernel only.
+IterationFormat iterationFormatFor(const RenderConfig& cfg, PrecisionTier tier) {
+    const IterationFormat format = chooseIterationFormat(cfg);
+    if (format == IterationFormat::U32) {
+        return format;
+    }
+    if (cfg.antialiasSamples > 0) {
+        // Edge detection and the color resolve read plain counts.
+        if (cfg.iterationFormat != "auto") {
+            std::cout << "[Renderer] --antialias reads u32 counts; ignoring --iteration-format\n";
+        }
+        return IterationFormat::U32;
+    }
+    if (tier == PrecisionTier::Float) {
+        return format;
+    }
+    if (cfg.iterationFormat != "auto") {
+        std::cout << "[Renderer] --iteration-format applies to the float tier; storing u32\n";
+    }
+    return IterationFormat::U32;
+}
+
+// Best wall or event time of repeats runs of run() (which returns ms).
+template <typename Fn>
+double bestOfMs(int repeats, Fn&& run) {
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < repeats; ++i) {
+        best = std::min(best, run());
+    }
+    return best;
+}
+
+// Returns the local size to pass to clEnqueueNDRangeKernel (nullptr = let
+// OpenCL choose), filling storage when the user set an override.
+const size_t* localSizeFor(const RenderConfig& cfg, size_t storage[2]) {
+    if (cfg.localSizeX > 0 && cfg.localSizeY > 0) {
+        storage[0] = static_cast<size_t>(cfg.localSizeX);
+        storage[1] = static_cast<size_t>(cfg.localSizeY);
+        return storage;
+    }
+    return nullptr;
+}
+
+// Pixels per work item for a launch dispatchWidth pixels wide: cfg's factor on
+// the float tier when it divides the launch (and the narrower launch still
+// divides into work groups), otherwise 1.
+int pixelsPerItemFor(const RenderConfig& cfg, PrecisionTier tier, int dispatchWidth) {
+    const int pixels = cfg.pixelsPerItem;
+    if (pixels <= 1 || tier != PrecisionTier::Float || dispatchWidth % pixels != 0) {
+        return 1;
+    }
+    if (cfg.localSizeX > 0 && cfg.localSizeY > 0 && (dispatchWidth / pixels) % cfg.localSizeX != 0) {
+        return 1;
+    }
+    return pixels;
+}
+
+std::string launchShapeName(const WorkGroupTuning::Entry& e) {
+    std::string name = e.localX > 0 ? std::to_string(e.localX) + "x" + std::to_string(e.localY) : "auto";
+    if (e.pixelsPerItem > 1) {
+        name += ", " + std::to_string(e.pixelsPerItem) + " px/item";
+    }
+    return name;
+}
+
+struct TileLayout {
+    int tileWidth;
+    int tileHeight;
+};
+
+// Largest tile that fits the byte budget: full-width row bands when a row fits,
+// otherwise a partial row. Tiles stay a multiple of an explicit work-group size.
+TileLayout chooseTileLayout(const RenderConfig& cfg, size_t budgetBytes, size_t bytesPerPixel) {
+    const size_t maxPixels = std::max<size_t>(1, budgetBytes / bytesPerPixel);
+    const size_t width = static_cast<size_t>(cfg.width);
+
+    TileLayout layout{};
+    if (maxPixels >= width) {
+        layout.tileWidth = cfg.width;
+        layout.tileHeight = static_cast<int>(std::min<size_t>(cfg.height, maxPixels / width));
+    } else {
+        layout.tileWidth = static_cast<int>(maxPixels);
+        layout.tileHeight = 1;
+    }
+
+    if (cfg.localSizeX > 0 && cfg.localSizeY > 0) {
+        layout.tileWidth = std::max(cfg.localSizeX, layout.tileWidth - layout.tileWidth % cfg.localSizeX);
+        layout.tileHeight = std::max(cfg.localSizeY, layout.tileHeight - layout.tileHeight % cfg.localSizeY);
+    }
+    return layout;
+}
+
+// Rows per streaming band: ~TARGET_BAND_PIXELS per band, bounded by the
+// per-buffer device budget and kept a multiple of an explicit work-group height.
+int chooseBandRows(const RenderConfig& cfg, size_t budgetBytes) {
+    const size_t rowBytes = static_cast<size_t>(cfg.width) * sizeof(int);
+    size_t rows = cfg.bandRows > 0
+        ? static_cast<size_t>(cfg.bandRows)
+        : std::max<size_t>(1, Streaming::TARGET_BAND_PIXELS / static_cast<size_t>(cfg.width));
+    rows = std::min(rows, std::max<size_t>(1, budgetBytes / rowBytes));
+    rows = std::min(rows, static_cast<size_t>(cfg.height));
+
+    int bandRows = static_cast<int>(rows);
+    if (cfg.localSizeY > 0) {
+        bandRows = std::max(cfg.localSizeY, bandRows - bandRows % cfg.localSizeY);
+    }
+    return bandRows;
 }
 
 } // namespace
 
-void Renderer::render(const RenderConfig& cfg) {
+std::string resolveOutputPath(const RenderConfig& cfg) {
+    std::string outputPath = cfg.outputPath;
+    if (!outputPath.empty() &&
+        outputPath.find('/') == std::string::npos &&
+        outputPath.find('\\') == std::string::npos &&
+        outputPath[0] != '/') {
+        outputPath = "images/" + outputPath;
+    }
+    return outputPath;
+}
+
+void Renderer::render(const RenderConfig& requested) {
+    Trace::Scope scope("Render", "render");
     if (!strategy_) {
         std::cerr << "[Renderer] No strategy set; cannot render.\n";
         return;
@@ -47,104 +207,1619 @@ void Renderer::render(const RenderConfig& cfg) {
 
     std::cout << "[Renderer] Starting render using strategy: "
               << strategy_->name() << "\n";
-    strategy_->configure(cfg);
+    strategy_->configure(requested);
+
+    const PrecisionTier tier = selectTier(requested);
+    std::cout << "[Renderer] Precision: " << precisionTierName(tier) << " (view needs "
+              << requiredPrecisionBits(requested) << " mantissa bits)\n";
+    if (requested.backend == "cpu" && tier == PrecisionTier::Perturbation && requested.precision != "auto" &&
+        requested.precision != precisionTierName(PrecisionTier::Perturbation)) {
+        std::cout << "[Renderer] --precision " << requested.precision
+                  << " applies to the opencl backend; iterating with perturbation\n";
+    }
+    const RenderConfig cfg = applyTuning(requested, tier);
+
+    // Deep zooms need the perturbation path, which renders whole frames.
+    const bool deepZoom = tier == PrecisionTier::Perturbation;
+    // Subdivision evaluates scattered pixels with the float kernel only.
+    const bool subdivide = cfg.subdivide && tier == PrecisionTier::Float;
+    if (cfg.subdivide && !subdivide) {
+        std::cout << "[Renderer] --subdivide applies to the float tier; iterating every pixel\n";
+    }
+    // Multi-device splits plain iteration into row chunks across devices.
+    const bool multiDevice = cfg.multiDevice && deviceSet_ && cfg.backend != "cpu" && !deepZoom && !subdivide;
+    // Edge anti-aliasing blends subsamples into the host-colored frame.
+    const bool antialias = cfg.antialiasSamples > 0 && tier == PrecisionTier::Float;
+    if (cfg.antialiasSamples > 0 && !antialias) {
+        std::cout << "[Renderer] --antialias applies to the float tier; rendering without it\n";
+    }
+    // The CPU backend's float loop takes the shortcuts too; perturbation does not.
+    if (cfg.interior != "none" && tier != PrecisionTier::Float) {
+        std::cout << "[Renderer] --interior applies to the float tier; iterating every step\n";
+    }
+    // Compact counts come from the OpenCL float kernel's full-frame and tiled
+    // paths only (iterationFormatFor notes the other tiers there).
+    if ((cfg.backend == "cpu" || deepZoom || subdivide || multiDevice) && cfg.iterationFormat != "auto" &&
+        chooseIterationFormat(cfg) != IterationFormat::U32) {
+        std::cout << "[Renderer] --iteration-format applies to the OpenCL float kernel; storing u32\n";
+    }
+    // Variants exist for the OpenCL iteration tiers; subdivision batches
+    // scattered points through the generic points kernel.
+    if (cfg.specialize && (cfg.backend == "cpu" || deepZoom || subdivide)) {
+        std::cout << "[Renderer] --specialize applies to the OpenCL full-frame kernels; using the generic loop\n";
+    }
+    // Both need the whole frame's counts on the host before coloring.
+    const bool hostColor = antialias || cfg.coloring == "histogram";
+    // So does saving them as an iteration field.
+    const bool saveField = !cfg.fieldPath.empty();
+
+    if (subdivide) {
+        if (cfg.streaming || cfg.deviceColor) {
+            std::cout << "[Renderer] Subdivision fills the full frame and colors on the host\n";
+        }
+        renderSubdivided(cfg);
+        writeOutput(cfg, memoryManager_.hostFrame());
+    } else if (multiDevice) {
+        if (cfg.streaming || cfg.deviceColor) {
+            std::cout << "[Renderer] Multi-device fills the full frame and colors on the host\n";
+        }
+        renderMultiDevice(cfg);
+        writeOutput(cfg, memoryManager_.hostFrame());
+    } else if (cfg.streaming && cfg.backend != "cpu" && !deepZoom && !hostColor && !saveField) {
+        renderStreaming(cfg);
+    } else if (cfg.deviceColor && cfg.backend != "cpu" && !deepZoom && !antialias && !saveField &&
+               deviceColorFits(cfg)) {
+        renderDeviceColor(cfg);
+    } else {
+        if (deepZoom && (cfg.streaming || cfg.deviceColor)) {
+            std::cout << "[Renderer] Deep zoom renders the full frame and colors on the host\n";
+        } else if (cfg.streaming && cfg.backend != "cpu") {
+            std::cout << "[Renderer] "
+                      << (antialias ? "Anti-aliasing" : hostColor ? "Histogram coloring" : "--save-field")
+                      << " needs the whole frame; rendering it before coloring\n";
+        } else if (antialias && cfg.deviceColor && cfg.backend != "cpu") {
+            std::cout << "[Renderer] Anti-aliasing colors on the host\n";
+        } else if (saveField && cfg.deviceColor && cfg.backend != "cpu") {
+            std::cout << "[Renderer] --save-field reads the counts back; coloring on the host\n";
+        } else if (cfg.streaming) {
+            std::cout << "[Renderer] --stream applies to the OpenCL backend; rendering the full frame\n";
+        } else if (cfg.deviceColor && cfg.backend != "cpu" && !PaletteLut::tabulates(cfg.maxIterations)) {
+            std::cout << "[Renderer] Iteration limit exceeds the palette table; coloring on the host\n";
+        } else if (cfg.deviceColor && cfg.backend != "cpu") {
+            std::cout << "[Renderer] Frame exceeds one device allocation; coloring on the host\n";
+        }
+
+        if (deepZoom) {
+            renderPerturbation(cfg);
+        } else if (cfg.backend == "cpu") {
+            renderCpu(cfg);
+        } else {
+            renderOpenCL(cfg);
+        }
+
+        const IterationFrame frame = memoryManager_.hostFrame();
+        std::cout << "[Renderer] Mandelbrot/Julia iterations computed. ("
+                  << frame.pixelCount << " pixels, " << iterationFormatName(frame.format) << ")\n";
+
+        writeOutput(cfg, frame);
+    }
+
+    memoryManager_.printPoolStats();
+}
+
+std::vector<unsigned char> Renderer::renderEncoded(const RenderConfig& cfg) {
+    RenderConfig memoryCfg = cfg;
+    memoryCfg.streaming = false;  // The band pipeline encodes straight to a file.
+    memoryCfg.fieldPath.clear();  // Requests get the image only.
+
+    std::vector<unsigned char> encoded;
+    encoded_ = &encoded;
+    try {
+        render(memoryCfg);
+    } catch (...) {
+        encoded_ = nullptr;
+        throw;
+    }
+    encoded_ = nullptr;
+    return encoded;
+}
+
+PrecisionTier Renderer::selectTier(const RenderConfig& cfg) const {
+    // The CPU backend iterates in float (SIMD) or perturbation only; explicit
+    // wider tiers fall through to perturbation there (render() notes it).
+    const std::vector<PrecisionTier> cpuTiers = {PrecisionTier::Float};
+    const std::vector<PrecisionTier>& candidates = cfg.backend == "cpu" ? cpuTiers : kernelManager_.availableTiers();
+    const PrecisionTier tier = choosePrecisionTier(cfg, candidates);
+    if (tier == PrecisionTier::Perturbation ||
+        std::find(candidates.begin(), candidates.end(), tier) != candidates.end()) {
+        return tier;
+    }
+    if (cfg.backend == "cpu") {
+        return PrecisionTier::Perturbation;
+    }
+    throw std::runtime_error("--precision " + cfg.precision + " is not available on this device");
+}
+
+RenderConfig Renderer::applyTuning(const RenderConfig& cfg, PrecisionTier tier) const {
+    const bool tuneLocal = cfg.localSizeX <= 0 || cfg.localSizeY <= 0;
+    const bool tunePixels = cfg.pixelsPerItem == 0;
+    if (cfg.backend == "cpu" || cfg.tuningFile.empty() || (cfg.multiDevice && deviceSet_) ||
+        tier == PrecisionTier::Perturbation || (!tuneLocal && !tunePixels)) {
+        return cfg;
+    }
+
+    WorkGroupTuning tuning(cfg.tuningFile);
+    tuning.load();
+    const WorkGroupTuning::Entry* entry =
+        tuning.find(WorkGroupTuning::deviceKey(deviceManager_.device()), precisionTierName(tier));
+    if (!entry) {
+        return cfg;
+    }
+
+    RenderConfig tuned = cfg;
+    if (tunePixels) {
+        tuned.pixelsPerItem = entry->pixelsPerItem;
+    }
+    if (tuneLocal && entry->localX > 0) {
+        // Launches span the whole frame, so the tuned shape must tile it.
+        if (cfg.width % entry->localX == 0 && cfg.height % entry->localY == 0) {
+            tuned.localSizeX = entry->localX;
+            tuned.localSizeY = entry->localY;
+        } else {
+            std::cout << "[Autotune] Tuned " << entry->localX << "x" << entry->localY
+                      << " work groups do not divide " << cfg.width << "x" << cfg.height
+                      << "; letting OpenCL choose\n";
+        }
+    }
+    WorkGroupTuning::Entry applied;
+    applied.localX = tuned.localSizeX > 0 && tuned.localSizeY > 0 ? tuned.localSizeX : 0;
+    applied.localY = applied.localX > 0 ? tuned.localSizeY : 0;
+    applied.pixelsPerItem = pixelsPerItemFor(tuned, tier, cfg.width);
+    std::cout << "[Autotune] " << precisionTierName(tier) << " launch from " << cfg.tuningFile << ": "
+              << launchShapeName(applied) << "\n";
+    return tuned;
+}
+
+cl_kernel Renderer::iterationKernelFor(const RenderConfig& cfg, PrecisionTier tier) {
+    return iterationKernelFor(kernelManager_, cfg, tier);
+}
+
+cl_kernel Renderer::iterationKernelFor(KernelManager& kernels, const RenderConfig& cfg, PrecisionTier tier) {
+    if (cfg.specialize && tier != PrecisionTier::Perturbation) {
+        const KernelVariant variant{tier, cfg.fractalType == "julia" ? 1 : 0, cfg.maxIterations,
+                                    Specialize::DEFAULT_UNROLL};
+        if (cl_kernel kernel = kernels.variantKernel(variant)) {
+            return kernel;
+        }
+    }
+    return kernels.iterationKernel(tier);
+}
+
+bool Renderer::deviceColorFits(const RenderConfig& cfg) const {
+    const size_t frameBytes = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height) * sizeof(int);
+    return !cfg.tiled && frameBytes <= tileBudgetBytes(cfg) && PaletteLut::tabulates(cfg.maxIterations);
+}
+
+bool Renderer::mappedReadback(const RenderConfig& cfg) const {
+    return cfg.readback == "map" || (cfg.readback == "auto" && deviceManager_.hostUnifiedMemory());
+}
+
+void Renderer::renderCpu(const RenderConfig& cfg) {
+    memoryManager_.initializeHost(cfg);
+    auto& hostIters = memoryManager_.hostIterationBuffer();
+
+    CpuRenderer cpu(cfg.threads);
+    const auto start = std::chrono::steady_clock::now();
+    cpu.computeIterations(cfg, hostIters.data());
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printTimeMs("CPU kernel", ms, hostIters.size(),
+                CpuRenderer::isaName(cpu.isa()) + " x " + std::to_string(cpu.threadCount()) + " threads");
+}
+
+void Renderer::renderSubdivided(const RenderConfig& cfg) {
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    const auto start = std::chrono::steady_clock::now();
+    MarianiSilver::Stats stats;
+    std::string detail;
+
+    if (cfg.backend == "cpu") {
+        memoryManager_.initializeHost(cfg);
+        CpuRenderer cpu(cfg.threads);
+        stats = MarianiSilver::render(cfg, memoryManager_.hostIterationBuffer().data(),
+            [&](const int* points, size_t count, int* results) {
+                cpu.computePoints(cfg, points, count, results);
+            },
+            Subdivide::MAX_BATCH_POINTS);
+        detail = std::to_string(cpu.threadCount()) + " threads";
+    } else {
+        cl_kernel kernel = kernelManager_.pointsKernel();
+        if (!kernel) {
+            throw std::runtime_error("Points kernel not initialized");
+        }
+        // Each batch needs a point buffer (two ints per pixel) and a result
+        // buffer, both within one device allocation.
+        const size_t maxPoints = std::max<size_t>(1, std::min({Subdivide::MAX_BATCH_POINTS, pixelCount,
+                                                                tileBudgetBytes(cfg) / (2 * sizeof(int))}));
+        memoryManager_.initializePointBatches(cfg, maxPoints);
+        cl_command_queue queue = deviceManager_.commandQueue();
+        cl_mem pointsBuf = memoryManager_.pointBuffer();
+        cl_mem iterationsBuf = memoryManager_.iterationBuffer();
+        setPointsKernelArgs(kernel, cfg, pointsBuf, iterationsBuf);
+
+        double kernelMs = 0.0;
+        stats = MarianiSilver::render(cfg, memoryManager_.hostIterationBuffer().data(),
+            [&](const int* points, size_t count, int* results) {
+                // In-order queue: upload, iterate, blocking read-back.
+                const int pointCount = static_cast<int>(count);
+                cl_int err = clEnqueueWriteBuffer(queue, pointsBuf, CL_FALSE, 0, count * 2 * sizeof(int),
+                                                  points, 0, nullptr, Trace::Command("Point upload").event());
+                err |= clSetKernelArg(kernel, 2, sizeof(int), &pointCount);
+                cl_event evt = nullptr;
+                err |= clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &count, nullptr, 0, nullptr,
+                                              Trace::Command("Points kernel", &evt).event());
+                if (err != CL_SUCCESS) {
+                    throw std::runtime_error("Failed to enqueue points kernel");
+                }
+                err = clEnqueueReadBuffer(queue, iterationsBuf, CL_TRUE, 0, count * sizeof(int),
+                                          results, 0, nullptr, Trace::Command("Point readback").event());
+                if (evt) {
+                    kernelMs += eventTimeMs(evt);
+                    clReleaseEvent(evt);
+                }
+                if (err != CL_SUCCESS) {
+                    throw std::runtime_error("Failed to read points result buffer");
+                }
+            },
+            maxPoints);
+        detail = std::to_string(kernelMs) + " ms in kernel";
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Subdivision] " << 100.0 * static_cast<double>(stats.pixelsIterated) / static_cast<double>(pixelCount)
+              << "% of pixels iterated, " << stats.rectsFilled << " rects filled, " << stats.rounds
+              << " rounds, " << stats.batches << " batches\n";
+    printTimeMs("Subdivision", ms, pixelCount, detail);
+}
+
+void Renderer::antialiasEdges(const RenderConfig& cfg, const int* counts, const PaletteLut& lut, unsigned char* rgb) {
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    const auto start = std::chrono::steady_clock::now();
+    EdgeAntialias::Stats stats;
+    std::string detail;
+
+    if (cfg.backend == "cpu") {
+        CpuRenderer cpu(cfg.threads);
+        stats = EdgeAntialias::apply(cfg, counts, lut, rgb,
+            [&](const float* samples, size_t count, int* results) {
+                cpu.computeSamples(cfg, samples, count, results);
+            },
+            Antialias::MAX_BATCH_SAMPLES);
+        detail = std::to_string(cpu.threadCount()) + " threads";
+    } else {
+        cl_kernel kernel = kernelManager_.samplesKernel();
+        if (!kernel) {
+            throw std::runtime_error("Samples kernel not initialized");
+        }
+        // Positions (two floats per sample) and counts of one batch, each
+        // within one device allocation.
+        const size_t maxSamples = std::max<size_t>(1, std::min(Antialias::MAX_BATCH_SAMPLES,
+                                                               tileBudgetBytes(cfg) / (2 * sizeof(float))));
+        memoryManager_.initializeSampleBatches(maxSamples);
+        cl_command_queue queue = deviceManager_.commandQueue();
+        cl_mem samplesBuf = memoryManager_.sampleBuffer();
+        cl_mem resultsBuf = memoryManager_.sampleResultBuffer();
+        setPointsKernelArgs(kernel, cfg, samplesBuf, resultsBuf);
+
+        double kernelMs = 0.0;
+        stats = EdgeAntialias::apply(cfg, counts, lut, rgb,
+            [&](const float* samples, size_t count, int* results) {
+                // In-order queue: upload, iterate, blocking read-back.
+                const int sampleCount = static_cast<int>(count);
+                cl_int err = clEnqueueWriteBuffer(queue, samplesBuf, CL_FALSE, 0, count * 2 * sizeof(float),
+                                                  samples, 0, nullptr, Trace::Command("Sample upload").event());
+                err |= clSetKernelArg(kernel, 2, sizeof(int), &sampleCount);
+                cl_event evt = nullptr;
+                err |= clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &count, nullptr, 0, nullptr,
+                                              Trace::Command("Samples kernel", &evt).event());
+                if (err != CL_SUCCESS) {
+                    throw std::runtime_error("Failed to enqueue samples kernel");
+                }
+                err = clEnqueueReadBuffer(queue, resultsBuf, CL_TRUE, 0, count * sizeof(int),
+                                          results, 0, nullptr, Trace::Command("Sample readback").event());
+                if (evt) {
+                    kernelMs += eventTimeMs(evt);
+                    clReleaseEvent(evt);
+                }
+                if (err != CL_SUCCESS) {
+                    throw std::runtime_error("Failed to read samples result buffer");
+                }
+            },
+            maxSamples);
+        detail = std::to_string(kernelMs) + " ms in kernel";
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Antialias] " << 100.0 * static_cast<double>(stats.edgePixels) / static_cast<double>(pixelCount)
+              << "% of pixels on edges, " << stats.samples << " subsamples ("
+              << static_cast<double>(stats.samples) / static_cast<double>(pixelCount)
+              << " per pixel), " << stats.batches << " batches\n";
+    printTimeMs("Antialias", ms, pixelCount, detail);
+}
+
+void Renderer::benchmarkTiers(const RenderConfig& cfg) {
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    std::cout << "[Precision bench] " << cfg.width << "x" << cfg.height << ", " << cfg.maxIterations
+              << " iterations, view needs " << requiredPrecisionBits(cfg) << " mantissa bits, best of "
+              << Precision::BENCH_REPEATS << "\n";
+
+    auto report = [&](PrecisionTier tier, double ms, const std::string& detail) {
+        const double mpixPerSec = ms > 0.0 ? static_cast<double>(pixelCount) / (ms * 1e3) : 0.0;
+        std::cout << "[Precision bench] " << precisionTierName(tier) << ": " << ms << " ms ("
+                  << mpixPerSec << " Mpixel/s, "
+                  << (tier == PrecisionTier::Perturbation ? std::string("any depth")
+                                                          : std::to_string(precisionTierBits(tier)) + " bits")
+                  << (detail.empty() ? "" : ", " + detail) << ")\n";
+    };
+    auto bestOf = [](auto&& run) { return bestOfMs(Precision::BENCH_REPEATS, run); };
+
+    RenderConfig deepCfg = cfg;
+    deepCfg.precision = precisionTierName(PrecisionTier::Perturbation);
+    const ReferenceOrbit orbit = Perturbation::chooseReference(deepCfg, cfg.threads);
+
+    if (cfg.backend == "cpu") {
+        memoryManager_.initializeHost(cfg);
+        int* out = memoryManager_.hostIterationBuffer().data();
+        CpuRenderer cpu(cfg.threads);
+        report(PrecisionTier::Float, bestOf([&] {
+            const auto start = std::chrono::steady_clock::now();
+            cpu.computeIterations(cfg, out);
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }), CpuRenderer::isaName(cpu.isa()));
+        report(PrecisionTier::Perturbation, bestOf([&] {
+            const auto start = std::chrono::steady_clock::now();
+            Perturbation::computeIterations(deepCfg, orbit, cfg.threads, out);
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }), "host deltas");
+        return;
+    }
+
+    if (pixelCount * sizeof(int) > tileBudgetBytes(cfg)) {
+        throw std::runtime_error("--bench-precision needs the frame to fit one device allocation");
+    }
+    const size_t orbitBytes = orbit.points.size() * sizeof(double);
+    memoryManager_.initializePerturbation(cfg, orbitBytes);
+    cl_command_queue queue = deviceManager_.commandQueue();
+    cl_mem iterationsBuf = memoryManager_.iterationBuffer();
+    cl_mem orbitBuf = memoryManager_.orbitBuffer();
+    const size_t globalSize[2] = {static_cast<size_t>(cfg.width), static_cast<size_t>(cfg.height)};
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
+
+    auto timeKernel = [&](cl_kernel kernel) {
+        cl_event evt = nullptr;
+        if (clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalSize, localSizePtr, 0, nullptr,
+                                   Trace::Command("Bench kernel", &evt).event()) != CL_SUCCESS) {
+            throw std::runtime_error("Failed to enqueue benchmark kernel");
+        }
+        clFinish(queue);
+        const double ms = eventTimeMs(evt);
+        clReleaseEvent(evt);
+        return ms;
+    };
+
+    for (PrecisionTier tier : kernelManager_.availableTiers()) {
+        cl_kernel kernel = kernelManager_.iterationKernel(tier);
+        setFractalKernelArgs(kernel, tier, cfg, iterationsBuf);
+        timeKernel(kernel);  // Warm-up (first launch pays driver setup).
+        report(tier, bestOf([&] { return timeKernel(kernel); }), "");
+    }
+
+    cl_kernel deltaKernel = kernelManager_.perturbationKernel();
+    if (!deltaKernel) {
+        std::cout << "[Precision bench] perturbation: skipped: device lacks cl_khr_fp64\n";
+        return;
+    }
+    if (clEnqueueWriteBuffer(queue, orbitBuf, CL_TRUE, 0, orbitBytes, orbit.points.data(),
+                             0, nullptr, Trace::Command("Orbit upload").event()) != CL_SUCCESS) {
+        throw std::runtime_error("Failed to upload reference orbit");
+    }
+    setPerturbationKernelArgs(deltaKernel, cfg, orbit, orbitBuf, iterationsBuf);
+    timeKernel(deltaKernel);
+    report(PrecisionTier::Perturbation, bestOf([&] { return timeKernel(deltaKernel); }), "excluding reference orbit");
+}
+
+void Renderer::autotune(const RenderConfig& cfg) {
+    if (cfg.backend == "cpu") {
+        throw std::runtime_error("--autotune tunes the OpenCL kernels; it needs the opencl backend");
+    }
+
+    // A fixed frame every candidate divides, at the requested view and depth.
+    RenderConfig tuneCfg = cfg;
+    tuneCfg.width = Autotune::FRAME_WIDTH;
+    tuneCfg.height = Autotune::FRAME_HEIGHT;
+    tuneCfg.localSizeX = 0;
+    tuneCfg.localSizeY = 0;
+    const size_t pixelCount = static_cast<size_t>(tuneCfg.width) * static_cast<size_t>(tuneCfg.height);
+
+    cl_device_id device = deviceManager_.device();
+    const std::string deviceKey = WorkGroupTuning::deviceKey(device);
+    WorkGroupTuning tuning(cfg.tuningFile);
+    tuning.load();
+
+    size_t deviceMaxGroup = 0;
+    size_t itemSizes[3] = {0, 0, 0};
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(deviceMaxGroup), &deviceMaxGroup, nullptr);
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(itemSizes), itemSizes, nullptr);
+
+    std::cout << "[Autotune] " << deviceManager_.deviceName() << ": " << tuneCfg.width << "x" << tuneCfg.height
+              << ", " << tuneCfg.maxIterations << " iterations, best of " << Autotune::REPEATS
+              << " per candidate\n";
+
+    memoryManager_.initialize(tuneCfg);
+    cl_command_queue queue = deviceManager_.commandQueue();
+    cl_mem iterationsBuf = memoryManager_.iterationBuffer();
+
+    for (PrecisionTier tier : kernelManager_.availableTiers()) {
+        cl_kernel kernel = kernelManager_.iterationKernel(tier);
+        const std::string kernelName = precisionTierName(tier);
+
+        size_t kernelMaxGroup = 0;
+        size_t multiple = 1;
+        clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelMaxGroup),
+                                 &kernelMaxGroup, nullptr);
+        clGetKernelWorkGroupInfo(kernel, device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(multiple),
+                                 &multiple, nullptr);
+        WorkGroupTuning::Limits limits;
+        limits.maxWorkGroupSize = kernelMaxGroup > 0 ? std::min(deviceMaxGroup, kernelMaxGroup) : deviceMaxGroup;
+        limits.preferredMultiple = multiple;
+        limits.maxItemsX = itemSizes[0];
+        limits.maxItemsY = itemSizes[1];
+
+        // The driver's own choice first, as the baseline every shape is
+        // compared against.
+        std::vector<WorkGroupTuning::Entry> shapes(1);
+        const std::vector<WorkGroupTuning::Entry> legal =
+            WorkGroupTuning::candidates(limits, tuneCfg.width, tuneCfg.height, tier == PrecisionTier::Float);
+        shapes.insert(shapes.end(), legal.begin(), legal.end());
+        std::cout << "[Autotune] " << kernelName << ": " << legal.size() << " shapes (max work group "
+                  << limits.maxWorkGroupSize << ", preferred multiple " << multiple << ")\n";
+
+        // Event time of one launch, or a negative value if the driver rejects it.
+        auto launch = [&](const WorkGroupTuning::Entry& shape) {
+            const size_t globalSize[2] = {static_cast<size_t>(tuneCfg.width / shape.pixelsPerItem),
+                                          static_cast<size_t>(tuneCfg.height)};
+            const size_t localSize[2] = {static_cast<size_t>(shape.localX), static_cast<size_t>(shape.localY)};
+            cl_event evt = nullptr;
+            if (clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalSize, shape.localX > 0 ? localSize : nullptr,
+                                       0, nullptr, Trace::Command("Autotune kernel", &evt).event()) != CL_SUCCESS) {
+                return -1.0;
+            }
+            clFinish(queue);
+            const double ms = eventTimeMs(evt);
+            clReleaseEvent(evt);
+            return ms;
+        };
+
+        std::vector<WorkGroupTuning::Entry> timed;
+        size_t rejected = 0;
+        double baselineMs = 0.0;
+        for (WorkGroupTuning::Entry shape : shapes) {
+            setFractalKernelArgs(kernel, tier, tuneCfg, iterationsBuf, IterationFormat::U32, shape.pixelsPerItem);
+            // Warm-up, which also catches shapes the driver rejects (e.g. out
+            // of registers for that group size).
+            if (launch(shape) < 0.0) {
+                ++rejected;
+                continue;
+            }
+            shape.ms = bestOfMs(Autotune::REPEATS, [&] {
+                const double ms = launch(shape);
+                return ms < 0.0 ? std::numeric_limits<double>::max() : ms;
+            });
+            if (shape.localX == 0) {
+                baselineMs = shape.ms;
+            }
+            timed.push_back(shape);
+        }
+        if (timed.empty()) {
+            std::cout << "[Autotune] " << kernelName << ": every launch failed; nothing saved\n";
+            continue;
+        }
+
+        std::stable_sort(timed.begin(), timed.end(),
+                         [](const WorkGroupTuning::Entry& a, const WorkGroupTuning::Entry& b) { return a.ms < b.ms; });
+        const size_t shown = std::min(timed.size(), static_cast<size_t>(Autotune::REPORT_TOP));
+        for (size_t i = 0; i < shown; ++i) {
+            const WorkGroupTuning::Entry& shape = timed[i];
+            std::cout << "[Autotune]   " << launchShapeName(shape) << ": " << shape.ms << " ms ("
+                      << static_cast<double>(pixelCount) / (shape.ms * 1e3) << " Mpixel/s";
+            if (baselineMs > 0.0) {
+                std::cout << ", " << baselineMs / shape.ms << "x vs auto";
+            }
+            std::cout << ")\n";
+        }
+        if (rejected > 0) {
+            std::cout << "[Autotune]   " << rejected << " shapes rejected by the driver\n";
+        }
+        tuning.set(deviceKey, kernelName, timed.front());
+    }
+
+    if (tuning.enabled()) {
+        tuning.save();
+        std::cout << "[Autotune] Results saved to " << tuning.path()
+                  << "; renders without --local-size-x/y use them\n";
+    } else {
+        std::cout << "[Autotune] No tuning file; results not saved\n";
+    }
+}
+
+void Renderer::benchmarkInterior(const RenderConfig& cfg) {
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    const bool useDevice = cfg.backend != "cpu";
+    if (useDevice && pixelCount * sizeof(int) > tileBudgetBytes(cfg)) {
+        throw std::runtime_error("--bench-interior needs the frame to fit one device allocation");
+    }
+    std::cout << "[Interior bench] " << cfg.width << "x" << cfg.height << ", float tier on "
+              << (useDevice ? "OpenCL" : "CPU") << ", best of " << Interior::BENCH_REPEATS << "\n";
+
+    // The shortcuts live in the float loop, so every variant runs float.
+    RenderConfig benchCfg = cfg;
+    benchCfg.precision = precisionTierName(PrecisionTier::Float);
+
+    CpuRenderer cpu(cfg.threads);
+    cl_command_queue queue = nullptr;
+    cl_kernel kernel = nullptr;
+    const size_t globalSize[2] = {static_cast<size_t>(cfg.width), static_cast<size_t>(cfg.height)};
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
+    if (useDevice) {
+        memoryManager_.initialize(benchCfg);
+        queue = deviceManager_.commandQueue();
+        kernel = kernelManager_.iterationKernel(PrecisionTier::Float);
+    } else {
+        memoryManager_.initializeHost(benchCfg);
+    }
+    std::vector<int>& out = memoryManager_.hostIterationBuffer();
+
+    // Time one variant and leave its iterations in out.
+    auto run = [&]() {
+        if (!useDevice) {
+            const auto start = std::chrono::steady_clock::now();
+            cpu.computeIterations(benchCfg, out.data());
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        cl_event evt = nullptr;
+        if (clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalSize, localSizePtr, 0, nullptr,
+                                   Trace::Command("Bench kernel", &evt).event()) != CL_SUCCESS ||
+            clEnqueueReadBuffer(queue, memoryManager_.iterationBuffer(), CL_TRUE, 0, out.size() * sizeof(int),
+                                out.data(), 0, nullptr, Trace::Command("Bench readback").event()) != CL_SUCCESS) {
+            throw std::runtime_error("Failed to run interior benchmark kernel");
+        }
+        const double ms = eventTimeMs(evt);
+        clReleaseEvent(evt);
+        return ms;
+    };
+
+    std::vector<int> reference;
+    for (int iterations : Interior::BENCH_ITERATIONS) {
+        benchCfg.maxIterations = iterations;
+        double baselineMs = 0.0;
+        for (InteriorCheck check : {InteriorCheck::None, InteriorCheck::Bulb,
+                                    InteriorCheck::Periodicity, InteriorCheck::All}) {
+            benchCfg.interior = interiorCheckName(check);
+            if (useDevice) {
+                setFractalKernelArgs(kernel, PrecisionTier::Float, benchCfg, memoryManager_.iterationBuffer());
+                run();  // Warm-up (first launch pays driver setup).
+            }
+            const double ms = bestOfMs(Interior::BENCH_REPEATS, run);
+
+            size_t differing = 0;
+            if (check == InteriorCheck::None) {
+                baselineMs = ms;
+                reference = out;
+            } else {
+                for (size_t i = 0; i < pixelCount; ++i) {
+                    differing += out[i] != reference[i] ? 1 : 0;
+                }
+            }
+            const double mpixPerSec = ms > 0.0 ? static_cast<double>(pixelCount) / (ms * 1e3) : 0.0;
+            std::cout << "[Interior bench] " << iterations << " iterations, " << benchCfg.interior << ": "
+                      << ms << " ms (" << mpixPerSec << " Mpixel/s, " << baselineMs / ms << "x vs none, "
+                      << differing << " pixels differ)\n";
+        }
+    }
+}
+
+void Renderer::benchmarkVariants(const RenderConfig& cfg) {
+    if (cfg.backend == "cpu") {
+        throw std::runtime_error("--bench-variants times OpenCL kernels; it needs the OpenCL backend");
+    }
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    if (pixelCount * sizeof(int) > tileBudgetBytes(cfg)) {
+        throw std::runtime_error("--bench-variants needs the frame to fit one device allocation");
+    }
+    const int julia = cfg.fractalType == "julia" ? 1 : 0;
+    std::cout << "[Variant bench] " << cfg.width << "x" << cfg.height << " " << cfg.fractalType << ", "
+              << cfg.maxIterations << " iterations, best of " << Specialize::BENCH_REPEATS << "\n";
 
     memoryManager_.initialize(cfg);
+    cl_command_queue queue = deviceManager_.commandQueue();
+    cl_mem iterationsBuf = memoryManager_.iterationBuffer();
+    std::vector<int>& out = memoryManager_.hostIterationBuffer();
+    const size_t globalSize[2] = {static_cast<size_t>(cfg.width), static_cast<size_t>(cfg.height)};
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
 
-    cl_kernel kernel = kernelManager_.mandelbrotKernel();
-    if (!kernel) {
-        throw std::runtime_error("Mandelbrot kernel not initialized");
+    // Time one kernel and leave its iterations in out.
+    auto run = [&](cl_kernel kernel) {
+        cl_event evt = nullptr;
+        if (clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalSize, localSizePtr, 0, nullptr,
+                                   Trace::Command("Bench kernel", &evt).event()) != CL_SUCCESS ||
+            clEnqueueReadBuffer(queue, iterationsBuf, CL_TRUE, 0, out.size() * sizeof(int), out.data(), 0,
+                                nullptr, Trace::Command("Bench readback").event()) != CL_SUCCESS) {
+            throw std::runtime_error("Failed to run variant benchmark kernel");
+        }
+        const double ms = eventTimeMs(evt);
+        clReleaseEvent(evt);
+        return ms;
+    };
+
+    std::vector<int> reference;
+    for (PrecisionTier tier : kernelManager_.availableTiers()) {
+        std::vector<KernelVariant> variants = {
+            {tier, julia, 0, 1},
+            {tier, julia, cfg.maxIterations, 1},
+        };
+        for (int unroll : Specialize::BENCH_UNROLLS) {
+            variants.push_back({tier, julia, cfg.maxIterations, unroll});
+        }
+
+        cl_kernel generic = kernelManager_.iterationKernel(tier);
+        setFractalKernelArgs(generic, tier, cfg, iterationsBuf);
+        run(generic);  // Warm-up (first launch pays driver setup).
+        const double genericMs = bestOfMs(Specialize::BENCH_REPEATS, [&] { return run(generic); });
+        reference = out;
+        std::cout << "[Variant bench] " << precisionTierName(tier) << " generic: " << genericMs << " ms ("
+                  << static_cast<double>(pixelCount) / (genericMs * 1e3) << " Mpixel/s)\n";
+
+        for (const KernelVariant& variant : variants) {
+            const auto buildStart = std::chrono::steady_clock::now();
+            cl_kernel kernel = kernelManager_.variantKernel(variant);
+            const double buildMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - buildStart).count();
+            if (!kernel) {
+                std::cout << "[Variant bench] " << variant.name() << ": skipped (does not build)\n";
+                continue;
+            }
+            setFractalKernelArgs(kernel, tier, cfg, iterationsBuf);
+            run(kernel);
+            const double ms = bestOfMs(Specialize::BENCH_REPEATS, [&] { return run(kernel); });
+            size_t differing = 0;
+            for (size_t i = 0; i < pixelCount; ++i) {
+                differing += out[i] != reference[i] ? 1 : 0;
+            }
+            std::cout << "[Variant bench] " << variant.name() << ": " << ms << " ms ("
+                      << static_cast<double>(pixelCount) / (ms * 1e3) << " Mpixel/s, " << genericMs / ms
+                      << "x vs generic, build " << buildMs << " ms, " << differing << " pixels differ)\n";
+        }
     }
+}
 
-    cl_int err = CL_SUCCESS;
-    const int width = cfg.width;
-    const int height = cfg.height;
-    const float centerX = static_cast<float>(cfg.centerX);
-    const float centerY = static_cast<float>(cfg.centerY);
-    const float zoom = static_cast<float>(cfg.zoom);
-    const int maxIterations = cfg.maxIterations;
-    const float juliaRe = static_cast<float>(cfg.juliaReal);
-    const float juliaImag = static_cast<float>(cfg.juliaImag);
-    const int juliaMode = (cfg.fractalType == "julia") ? 1 : 0;
+void Renderer::renderPerturbation(const RenderConfig& cfg) {
+    const auto orbitStart = std::chrono::steady_clock::now();
+    const ReferenceOrbit orbit = Perturbation::chooseReference(cfg, cfg.threads);
+    const double orbitMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - orbitStart).count();
+    std::cout << "[Perturbation] Reference orbit: " << orbit.length - 1 << " iterations at "
+              << orbit.precisionBits << " fraction bits in " << orbitMs << " ms\n";
+    if (orbit.offsetX != 0.0 || orbit.offsetY != 0.0) {
+        std::cout << "[Perturbation] Center orbit escapes early; reference moved by (" << orbit.offsetX << ", "
+                  << orbit.offsetY << ")\n";
+    }
+
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    cl_kernel kernel = cfg.backend != "cpu" ? kernelManager_.perturbationKernel() : nullptr;
+    const bool fits = !cfg.tiled && pixelCount * sizeof(int) <= tileBudgetBytes(cfg);
+    if (!kernel || !fits) {
+        if (cfg.backend != "cpu") {
+            std::cout << "[Perturbation] " << (kernel ? "Frame exceeds one device allocation" : "No fp64 kernel")
+                      << "; iterating deltas on the host\n";
+        }
+        memoryManager_.initializeHost(cfg);
+        auto& hostIters = memoryManager_.hostIterationBuffer();
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t rebases = Perturbation::computeIterations(cfg, orbit, cfg.threads, hostIters.data());
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printTimeMs("Perturbation CPU", ms, pixelCount,
+                    std::to_string(resolveThreadCount(cfg.threads)) + " threads, " +
+                    std::to_string(rebases) + " rebases");
+        return;
+    }
 
+    const size_t orbitBytes = orbit.points.size() * sizeof(double);
+    memoryManager_.initializePerturbation(cfg, orbitBytes);
+    cl_command_queue queue = deviceManager_.commandQueue();
     cl_mem iterationsBuf = memoryManager_.iterationBuffer();
+    cl_mem orbitBuf = memoryManager_.orbitBuffer();
 
-    err  = clSetKernelArg(kernel, 0, sizeof(cl_mem), &iterationsBuf);
-    err |= clSetKernelArg(kernel, 1, sizeof(int), &width);
-    err |= clSetKernelArg(kernel, 2, sizeof(int), &height);
-    err |= clSetKernelArg(kernel, 3, sizeof(float), &centerX);
-    err |= clSetKernelArg(kernel, 4, sizeof(float), &centerY);
-    err |= clSetKernelArg(kernel, 5, sizeof(float), &zoom);
-    err |= clSetKernelArg(kernel, 6, sizeof(int), &maxIterations);
-    err |= clSetKernelArg(kernel, 7, sizeof(float), &juliaRe);
-    err |= clSetKernelArg(kernel, 8, sizeof(float), &juliaImag);
-    err |= clSetKernelArg(kernel, 9, sizeof(int), &juliaMode);
+    // In-order queue: the orbit upload completes before the kernel reads it.
+    cl_int err = clEnqueueWriteBuffer(queue, orbitBuf, CL_FALSE, 0, orbitBytes, orbit.points.data(),
+                                      0, nullptr, Trace::Command("Orbit upload").event());
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to upload reference orbit");
+    }
+
+    setPerturbationKernelArgs(kernel, cfg, orbit, orbitBuf, iterationsBuf);
+
+    const size_t globalSize[2] = {static_cast<size_t>(cfg.width), static_cast<size_t>(cfg.height)};
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
+    cl_event evt = nullptr;
+    err = clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalSize, localSizePtr, 0, nullptr,
+                                 Trace::Command("Perturbation kernel", &evt).event());
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to enqueue perturbation kernel");
+    }
+
+    auto& hostIters = memoryManager_.hostIterationBuffer();
+    err = clEnqueueReadBuffer(queue, iterationsBuf, CL_TRUE, 0, hostIters.size() * sizeof(int),
+                              hostIters.data(), 0, nullptr, Trace::Command("Perturbation readback").event());
     if (err != CL_SUCCESS) {
-        throw std::runtime_error("Failed to set Mandelbrot kernel arguments");
+        throw std::runtime_error("Failed to read perturbation iteration buffer");
+    }
+    printKernelTimeMs("Perturbation kernel", evt, pixelCount);
+    if (evt) {
+        clReleaseEvent(evt);
+    }
+}
+
+void Renderer::renderOpenCL(const RenderConfig& cfg) {
+    const PrecisionTier tier = selectTier(cfg);
+    const IterationFormat format = iterationFormatFor(cfg, tier);
+    const size_t bytesPerPixel = iterationFormatBytes(format);
+    const size_t frameBytes = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height) * bytesPerPixel;
+    const size_t budgetBytes = tileBudgetBytes(cfg);
+    if (cfg.tiled || frameBytes > budgetBytes) {
+        renderTiled(cfg, budgetBytes);
+        return;
+    }
+
+    // Mapping hands the writer the device buffer itself; on host-unified
+    // devices that removes the frame-sized copy.
+    const bool mapped = mappedReadback(cfg);
+    if (mapped) {
+        memoryManager_.initializeMapped(cfg, format);
+    } else {
+        memoryManager_.initialize(cfg, format);
     }
 
+    cl_kernel kernel = iterationKernelFor(cfg, tier);
+    if (!kernel) {
+        throw std::runtime_error("Mandelbrot kernel not initialized");
+    }
+
+    cl_mem iterationsBuf = memoryManager_.iterationBuffer();
+    const int pixelsPerItem = pixelsPerItemFor(cfg, tier, cfg.width);
+    setFractalKernelArgs(kernel, tier, cfg, iterationsBuf, format, pixelsPerItem);
+
+    const int width = cfg.width;
+    const int height = cfg.height;
     const size_t globalSize[2] = {
-        static_cast<size_t>(width),
+        static_cast<size_t>(width / pixelsPerItem),
         static_cast<size_t>(height)
     };
 
-    const size_t* localSizePtr = nullptr;
     size_t localSize[2];
-    if (cfg.localSizeX > 0 && cfg.localSizeY > 0) {
-        localSize[0] = static_cast<size_t>(cfg.localSizeX);
-        localSize[1] = static_cast<size_t>(cfg.localSizeY);
-        localSizePtr = localSize;
-    }
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
 
     cl_event evt = nullptr;
-    err = clEnqueueNDRangeKernel(deviceManager_.commandQueue(),
-                                 kernel,
-                                 2,
-                                 nullptr,
-                                 globalSize,
-                                 localSizePtr,
-                                 0,
-                                 nullptr,
-                                 &evt);
+    cl_int err = clEnqueueNDRangeKernel(deviceManager_.commandQueue(),
+                                        kernel,
+                                        2,
+                                        nullptr,
+                                        globalSize,
+                                        localSizePtr,
+                                        0,
+                                        nullptr,
+                                        Trace::Command("Fractal kernel", &evt).event());
     if (err != CL_SUCCESS) {
         throw std::runtime_error("Failed to enqueue Mandelbrot kernel");
     }
 
     clFinish(deviceManager_.commandQueue());
-    printKernelTimeMs("Fractal kernel", evt);
+    const size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+    printKernelTimeMs("Fractal kernel", evt, pixelCount);
     if (evt) {
         clReleaseEvent(evt);
+        evt = nullptr;
     }
 
-    auto& hostIters = memoryManager_.hostIterationBuffer();
-    const size_t byteCount = hostIters.size() * sizeof(int);
-    err = clEnqueueReadBuffer(deviceManager_.commandQueue(),
-                              iterationsBuf,
-                              CL_TRUE,
-                              0,
-                              byteCount,
-                              hostIters.data(),
-                              0,
-                              nullptr,
-                              nullptr);
+    if (mapped) {
+        memoryManager_.mapFrame(&evt);
+        printKernelTimeMs("Iteration map", evt, pixelCount);
+    } else {
+        err = clEnqueueReadBuffer(deviceManager_.commandQueue(),
+                                  iterationsBuf,
+                                  CL_TRUE,
+                                  0,
+                                  frameBytes,
+                                  memoryManager_.hostFrameData(),
+                                  0,
+                                  nullptr,
+                                  Trace::Command("Iteration readback", &evt).event());
+        if (err != CL_SUCCESS) {
+            throw std::runtime_error("Failed to read Mandelbrot iteration buffer");
+        }
+        printKernelTimeMs("Iteration readback", evt, pixelCount);
+    }
+    if (evt) {
+        clReleaseEvent(evt);
+    }
+}
+
+size_t Renderer::tileBudgetBytes(const RenderConfig& cfg) const {
+    size_t budget = std::numeric_limits<size_t>::max();
+    if (deviceManager_.maxMemAllocSize() > 0) {
+        budget = static_cast<size_t>(deviceManager_.maxMemAllocSize());
+    }
+    if (cfg.tileMemoryMB > 0) {
+        budget = std::min(budget, static_cast<size_t>(cfg.tileMemoryMB) << 20);
+    }
+    return budget;
+}
+
+void Renderer::renderMultiDevice(const RenderConfig& cfg) {
+    const std::vector<PrecisionTier> common = deviceSet_->commonTiers();
+    const PrecisionTier tier = choosePrecisionTier(cfg, common);
+    if (std::find(common.begin(), common.end(), tier) == common.end()) {
+        std::cout << "[Multi-device] " << precisionTierName(selectTier(cfg))
+                  << " tier is not built on every device; rendering on the primary device\n";
+        renderOpenCL(cfg);
+        return;
+    }
+
+    const size_t deviceCount = deviceSet_->size();
+    const size_t rowBytes = static_cast<size_t>(cfg.width) * sizeof(int);
+    int chunkRows = cfg.chunkRows > 0
+        ? cfg.chunkRows
+        : std::max(MultiDevice::MIN_CHUNK_ROWS,
+                   cfg.height / static_cast<int>(deviceCount * MultiDevice::CHUNKS_PER_DEVICE));
+    // Every device must hold one chunk in a single allocation.
+    for (size_t d = 0; d < deviceCount; ++d) {
+        const cl_ulong maxAlloc = deviceSet_->member(d).device->maxMemAllocSize();
+        if (maxAlloc > 0) {
+            chunkRows = static_cast<int>(std::min<cl_ulong>(chunkRows, std::max<cl_ulong>(1, maxAlloc / rowBytes)));
+        }
+    }
+    chunkRows = std::min(chunkRows, cfg.height);
+    if (cfg.localSizeY > 0) {
+        chunkRows = std::max(cfg.localSizeY, chunkRows - chunkRows % cfg.localSizeY);
+    }
+    const int chunkCount = (cfg.height + chunkRows - 1) / chunkRows;
+
+    memoryManager_.initializeHost(cfg);
+    int* frame = memoryManager_.hostIterationBuffer().data();
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
+
+    struct DeviceStats {
+        int chunks = 0;
+        int rows = 0;
+        double kernelMs = 0.0;
+        double busyMs = 0.0;
+    };
+    std::vector<DeviceStats> stats(deviceCount);
+    std::vector<std::exception_ptr> errors(deviceCount);
+    // Variants are built here, one device after another, before the drivers
+    // start.
+    std::vector<cl_kernel> kernels(deviceCount);
+    for (size_t d = 0; d < deviceCount; ++d) {
+        kernels[d] = iterationKernelFor(*deviceSet_->member(d).kernels, cfg, tier);
+    }
+    std::atomic<int> nextChunk{0};
+
+    // One host thread per device pulls row chunks until none are left, so a
+    // slower device simply ends up with fewer of them. Chunks use a global
+    // offset, so each kernel writes chunk-relative rows into its own buffer.
+    auto drive = [&](size_t d) {
+        DeviceManager& device = *deviceSet_->member(d).device;
+        cl_kernel kernel = kernels[d];
+        cl_command_queue queue = device.commandQueue();
+        cl_int err = CL_SUCCESS;
+        cl_mem chunkBuf = clCreateBuffer(device.context(), CL_MEM_WRITE_ONLY,
+                                         static_cast<size_t>(chunkRows) * rowBytes, nullptr, &err);
+        if (err != CL_SUCCESS || !chunkBuf) {
+            throw std::runtime_error("Failed to create chunk buffer on " + device.deviceName());
+        }
+        try {
+            setFractalKernelArgs(kernel, tier, cfg, chunkBuf);
+            for (;;) {
+                const int chunk = nextChunk.fetch_add(1);
+                if (chunk >= chunkCount) {
+                    break;
+                }
+                const int row0 = chunk * chunkRows;
+                const int rows = std::min(chunkRows, cfg.height - row0);
+                const size_t globalOffset[2] = {0, static_cast<size_t>(row0)};
+                const size_t globalSize[2] = {static_cast<size_t>(cfg.width), static_cast<size_t>(rows)};
+
+                const auto chunkStart = std::chrono::steady_clock::now();
+                cl_event evt = nullptr;
+                err = clEnqueueNDRangeKernel(queue, kernel, 2, globalOffset, globalSize, localSizePtr,
+                                             0, nullptr, Trace::Command("Chunk kernel", &evt).event());
+                if (err != CL_SUCCESS) {
+                    throw std::runtime_error("Failed to enqueue chunk kernel on " + device.deviceName());
+                }
+                err = clEnqueueReadBuffer(queue, chunkBuf, CL_TRUE, 0, static_cast<size_t>(rows) * rowBytes,
+                                          frame + static_cast<size_t>(row0) * cfg.width, 0, nullptr,
+                                          Trace::Command("Chunk readback").event());
+                stats[d].kernelMs += eventTimeMs(evt);
+                clReleaseEvent(evt);
+                if (err != CL_SUCCESS) {
+                    throw std::runtime_error("Failed to read chunk from " + device.deviceName());
+                }
+                stats[d].busyMs += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - chunkStart).count();
+                ++stats[d].chunks;
+                stats[d].rows += rows;
+            }
+        } catch (...) {
+            clReleaseMemObject(chunkBuf);
+            throw;
+        }
+        clReleaseMemObject(chunkBuf);
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t d = 0; d < deviceCount; ++d) {
+        threads.emplace_back([&, d]() {
+            try {
+                drive(d);
+            } catch (...) {
+                errors[d] = std::current_exception();
+                nextChunk.store(chunkCount);  // Stop the other devices early.
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+    printTimeMs("Multi-device", ms, pixelCount,
+                std::to_string(deviceCount) + " devices, " + std::to_string(chunkCount) + " chunks of " +
+                std::to_string(chunkRows) + " rows, " + precisionTierName(tier));
+    for (size_t d = 0; d < deviceCount; ++d) {
+        const DeviceStats& s = stats[d];
+        const double pixels = static_cast<double>(s.rows) * cfg.width;
+        std::cout << "[Multi-device]  " << deviceSet_->member(d).device->deviceName() << ": " << s.chunks
+                  << " chunks, " << 100.0 * s.rows / cfg.height << "% of rows, "
+                  << (s.busyMs > 0.0 ? pixels / (s.busyMs * 1e3) : 0.0) << " Mpixel/s ("
+                  << s.kernelMs << " ms in kernel, " << s.busyMs << " ms busy)\n";
+    }
+}
+
+void Renderer::renderTiled(const RenderConfig& cfg, size_t budgetBytes) {
+    const PrecisionTier tier = selectTier(cfg);
+    const IterationFormat format = iterationFormatFor(cfg, tier);
+    const size_t bytesPerPixel = iterationFormatBytes(format);
+    const TileLayout layout = chooseTileLayout(cfg, budgetBytes, bytesPerPixel);
+    const size_t tilePixels = static_cast<size_t>(layout.tileWidth) * static_cast<size_t>(layout.tileHeight);
+    memoryManager_.initializeTiled(cfg, tilePixels, format);
+
+    cl_kernel kernel = iterationKernelFor(cfg, tier);
+    if (!kernel) {
+        throw std::runtime_error("Mandelbrot kernel not initialized");
+    }
+
+    // One fixed-size device buffer is reused by every tile; the kernel indexes
+    // it relative to the global offset.
+    cl_mem tileBuf = memoryManager_.iterationBuffer();
+    setFractalKernelArgs(kernel, tier, cfg, tileBuf, format);
+
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
+
+    cl_command_queue queue = deviceManager_.commandQueue();
+    void* hostFrame = memoryManager_.hostFrameData();
+    const size_t hostRowPitch = static_cast<size_t>(cfg.width) * bytesPerPixel;
+
+    std::vector<cl_event> kernelEvents;
+    for (int ty = 0; ty < cfg.height; ty += layout.tileHeight) {
+        for (int tx = 0; tx < cfg.width; tx += layout.tileWidth) {
+            const size_t tw = static_cast<size_t>(std::min(layout.tileWidth, cfg.width - tx));
+            const size_t th = static_cast<size_t>(std::min(layout.tileHeight, cfg.height - ty));
+            const size_t globalOffset[2] = {static_cast<size_t>(tx), static_cast<size_t>(ty)};
+            const size_t globalSize[2] = {tw, th};
+
+            cl_event evt = nullptr;
+            cl_int err = clEnqueueNDRangeKernel(queue, kernel, 2, globalOffset, globalSize,
+                                                localSizePtr, 0, nullptr, Trace::Command("Tile kernel", &evt).event());
+            if (err != CL_SUCCESS) {
+                throw std::runtime_error("Failed to enqueue Mandelbrot kernel for tile");
+            }
+            kernelEvents.push_back(evt);
+
+            // The queue is in-order, so the next tile's kernel cannot overwrite
+            // the buffer before this read has drained it.
+            const size_t bufferOrigin[3] = {0, 0, 0};
+            const size_t hostOrigin[3] = {static_cast<size_t>(tx) * bytesPerPixel, static_cast<size_t>(ty), 0};
+            const size_t region[3] = {tw * bytesPerPixel, th, 1};
+            err = clEnqueueReadBufferRect(queue, tileBuf, CL_FALSE,
+                                          bufferOrigin, hostOrigin, region,
+                                          tw * bytesPerPixel, 0,
+                                          hostRowPitch, 0,
+                                          hostFrame, 0, nullptr, Trace::Command("Tile readback").event());
+            if (err != CL_SUCCESS) {
+                throw std::runtime_error("Failed to read Mandelbrot tile");
+            }
+        }
+    }
+    clFinish(queue);
+
+    double kernelMs = 0.0;
+    for (cl_event evt : kernelEvents) {
+        kernelMs += eventTimeMs(evt);
+        clReleaseEvent(evt);
+    }
+    printTimeMs("Fractal kernel", kernelMs, memoryManager_.hostFrame().pixelCount,
+                std::to_string(kernelEvents.size()) + " tiles of " +
+                std::to_string(layout.tileWidth) + "x" + std::to_string(layout.tileHeight));
+}
+
+void Renderer::renderDeviceColor(const RenderConfig& cfg) {
+    OutputWriter writer;
+    PaletteLut lut = writer.paletteLut(cfg);
+    const int lutMaxIterations = lut.maxIterations;
+    const bool equalize = cfg.coloring == "histogram";
+    const size_t bins = static_cast<size_t>(cfg.maxIterations) + 1;
+    memoryManager_.initializeDeviceColor(cfg, lut.rgb.size(), equalize ? bins * sizeof(cl_uint) : 0);
+
+    const PrecisionTier tier = selectTier(cfg);
+    cl_kernel fractalKernel = iterationKernelFor(cfg, tier);
+    cl_kernel colorKernel = kernelManager_.colorizeKernel();
+    cl_kernel histogramKernel = kernelManager_.histogramKernel();
+    if (!fractalKernel || !colorKernel || (equalize && !histogramKernel)) {
+        throw std::runtime_error("Fractal/colorize kernels not initialized");
+    }
+
+    cl_command_queue queue = deviceManager_.commandQueue();
+    cl_mem iterationsBuf = memoryManager_.iterationBuffer();
+    cl_mem lutBuf = memoryManager_.paletteLutBuffer();
+    cl_mem rgbBuf = memoryManager_.rgbBuffer();
+    auto& hostRgb = memoryManager_.hostRgbBuffer();
+    const size_t pixelCount = static_cast<size_t>(cfg.width) * static_cast<size_t>(cfg.height);
+
+    // The queue is in-order: LUT upload, fractal kernel, color kernel and
+    // readback run back to back without host round trips. Histogram coloring
+    // adds one round trip: the LUT depends on the frame, so the iteration
+    // histogram is read back and the equalized LUT uploaded after it.
+    cl_int err = CL_SUCCESS;
+    if (!equalize) {
+        err = clEnqueueWriteBuffer(queue, lutBuf, CL_FALSE, 0, lut.rgb.size(), lut.rgb.data(),
+                                   0, nullptr, Trace::Command("LUT upload").event());
+        if (err != CL_SUCCESS) {
+            throw std::runtime_error("Failed to upload palette LUT");
+        }
+    }
+
+    const int pixelsPerItem = pixelsPerItemFor(cfg, tier, cfg.width);
+    setFractalKernelArgs(fractalKernel, tier, cfg, iterationsBuf, IterationFormat::U32, pixelsPerItem);
+    const size_t globalSize[2] = {static_cast<size_t>(cfg.width / pixelsPerItem), static_cast<size_t>(cfg.height)};
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
+    cl_event fractalEvt = nullptr;
+    err = clEnqueueNDRangeKernel(queue, fractalKernel, 2, nullptr, globalSize, localSizePtr,
+                                 0, nullptr, Trace::Command("Fractal kernel", &fractalEvt).event());
     if (err != CL_SUCCESS) {
-        throw std::runtime_error("Failed to read Mandelbrot iteration buffer");
+        throw std::runtime_error("Failed to enqueue Mandelbrot kernel");
     }
 
-    std::cout << "[Renderer] Mandelbrot/Julia iterations computed. ("
-              << hostIters.size() << " pixels)\n";
+    if (equalize) {
+        cl_event histogramEvt = nullptr;
+        const std::vector<uint32_t> histogram = runHistogramKernel(cfg, histogramKernel, iterationsBuf,
+                                                                   pixelCount, &histogramEvt);
+        printKernelTimeMs("Histogram kernel", histogramEvt, pixelCount);
+        clReleaseEvent(histogramEvt);
 
-    // Ensure output goes to images/ directory (unless path is absolute or contains directory separators).
-    std::string outputPath = cfg.outputPath;
-    if (!outputPath.empty() &&
-        outputPath.find('/') == std::string::npos &&
-        outputPath.find('\\') == std::string::npos &&
-        outputPath[0] != '/') {
-        outputPath = "images/" + outputPath;
+        const auto start = std::chrono::steady_clock::now();
+        lut = writer.equalizedLut(cfg, histogram, cfg.threads);
+        const double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        printTimeMs("Equalized LUT", ms, pixelCount, std::to_string(bins) + " bins");
+
+        err = clEnqueueWriteBuffer(queue, lutBuf, CL_FALSE, 0, lut.rgb.size(), lut.rgb.data(),
+                                   0, nullptr, Trace::Command("LUT upload").event());
+        if (err != CL_SUCCESS) {
+            throw std::runtime_error("Failed to upload palette LUT");
+        }
+    }
+
+    const int pixelCountArg = static_cast<int>(pixelCount);
+    err  = clSetKernelArg(colorKernel, 0, sizeof(cl_mem), &iterationsBuf);
+    err |= clSetKernelArg(colorKernel, 1, sizeof(cl_mem), &lutBuf);
+    err |= clSetKernelArg(colorKernel, 2, sizeof(cl_mem), &rgbBuf);
+    err |= clSetKernelArg(colorKernel, 3, sizeof(int), &pixelCountArg);
+    err |= clSetKernelArg(colorKernel, 4, sizeof(int), &lutMaxIterations);
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to set colorize kernel arguments");
+    }
+    cl_event colorEvt = nullptr;
+    err = clEnqueueNDRangeKernel(queue, colorKernel, 1, nullptr, &pixelCount, nullptr,
+                                 0, nullptr, Trace::Command("Color kernel", &colorEvt).event());
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to enqueue colorize kernel");
+    }
+
+    cl_event readEvt = nullptr;
+    err = clEnqueueReadBuffer(queue, rgbBuf, CL_TRUE, 0, hostRgb.size(), hostRgb.data(),
+                              0, nullptr, Trace::Command("RGB readback", &readEvt).event());
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to read RGB buffer");
+    }
+
+    printKernelTimeMs("Fractal kernel", fractalEvt, pixelCount);
+    printKernelTimeMs("Color kernel", colorEvt, pixelCount);
+    printKernelTimeMs("RGB readback", readEvt, pixelCount);
+    for (cl_event evt : {fractalEvt, colorEvt, readEvt}) {
+        clReleaseEvent(evt);
+    }
+
+    std::cout << "[Renderer] Mandelbrot/Julia image colored on device. ("
+              << pixelCount << " pixels)\n";
+
+    const std::string outputPath = resolveOutputPath(cfg);
+    if (encoded_) {
+        *encoded_ = writer.encodeRGBImage(cfg, hostRgb, outputPath);
+        std::cout << "[Renderer] Encoded image in memory (" << encoded_->size() << " bytes)\n";
+        return;
+    }
+    writer.writeRGBImage(cfg, hostRgb, outputPath);
+    std::cout << "[Renderer] Wrote image to '" << outputPath << "'\n";
+}
+
+std::vector<uint32_t> Renderer::runHistogramKernel(const RenderConfig& cfg,
+                                                   cl_kernel kernel,
+                                                   cl_mem iterationsBuf,
+                                                   size_t pixelCount,
+                                                   cl_event* evt) {
+    cl_command_queue queue = deviceManager_.commandQueue();
+    cl_mem histogramBuf = memoryManager_.histogramBuffer();
+    std::vector<uint32_t> histogram(static_cast<size_t>(cfg.maxIterations) + 1, 0);
+    const size_t histogramBytes = histogram.size() * sizeof(cl_uint);
+
+    cl_int err = clEnqueueWriteBuffer(queue, histogramBuf, CL_FALSE, 0, histogramBytes, histogram.data(),
+                                      0, nullptr, Trace::Command("Histogram clear").event());
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to clear histogram buffer");
+    }
+
+    // Work-group-local bins when they fit in local memory; otherwise the
+    // kernel counts straight into the global histogram (the local argument
+    // still needs a non-zero size).
+    const int useLocal = histogramBytes <= deviceManager_.localMemSize() ? 1 : 0;
+    const size_t localBytes = useLocal ? histogramBytes : sizeof(cl_uint);
+    const int pixelCountArg = static_cast<int>(pixelCount);
+    const int maxIterations = cfg.maxIterations;
+    err  = clSetKernelArg(kernel, 0, sizeof(cl_mem), &iterationsBuf);
+    err |= clSetKernelArg(kernel, 1, sizeof(int), &pixelCountArg);
+    err |= clSetKernelArg(kernel, 2, sizeof(int), &maxIterations);
+    err |= clSetKernelArg(kernel, 3, sizeof(cl_mem), &histogramBuf);
+    err |= clSetKernelArg(kernel, 4, localBytes, nullptr);
+    err |= clSetKernelArg(kernel, 5, sizeof(int), &useLocal);
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to set histogram kernel arguments");
+    }
+
+    const size_t local = Histogram::DEVICE_LOCAL_SIZE;
+    const size_t global = local * Histogram::DEVICE_GROUPS;
+    err = clEnqueueNDRangeKernel(queue, kernel, 1, nullptr, &global, &local, 0, nullptr,
+                                 Trace::Command("Histogram kernel", evt).event());
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to enqueue histogram kernel");
+    }
+    err = clEnqueueReadBuffer(queue, histogramBuf, CL_TRUE, 0, histogramBytes, histogram.data(),
+                              0, nullptr, Trace::Command("Histogram readback").event());
+    if (err != CL_SUCCESS) {
+        throw std::runtime_error("Failed to read histogram buffer");
+    }
+    return histogram;
+}
+
+void Renderer::renderStreaming(const RenderConfig& cfg) {
+    const int bandRows = chooseBandRows(cfg, tileBudgetBytes(cfg));
+    const size_t width = static_cast<size_t>(cfg.width);
+    const size_t bandPixels = width * static_cast<size_t>(bandRows);
+    const int slots = Streaming::BAND_SLOTS;
+    memoryManager_.initializeBands(cfg, bandPixels, slots);
+
+    const PrecisionTier tier = selectTier(cfg);
+    cl_kernel kernel = iterationKernelFor(cfg, tier);
+    if (!kernel) {
+        throw std::runtime_error("Mandelbrot kernel not initialized");
+    }
+
+    const std::string outputPath = resolveOutputPath(cfg);
+    std::unique_ptr<ImageStreamWriter> sink =
+        ImageStreamWriter::open(outputPath, cfg.width, cfg.height, OutputWriter::pngOptions(cfg));
+    OutputWriter writer;
+    const PaletteLut lut = writer.paletteLut(cfg);
+    std::vector<unsigned char> rgbBand(bandPixels * 3);
+
+    cl_command_queue computeQueue = deviceManager_.commandQueue();
+    cl_command_queue transferQueue = deviceManager_.transferQueue();
+    size_t localSize[2];
+    const size_t* localSizePtr = localSizeFor(cfg, localSize);
+
+    const int bandCount = (cfg.height + bandRows - 1) / bandRows;
+    std::vector<cl_event> kernelEvents(static_cast<size_t>(slots), nullptr);
+    std::vector<cl_event> readEvents(static_cast<size_t>(slots), nullptr);
+    double kernelMs = 0.0;
+    double readMs = 0.0;
+    double encodeMs = 0.0;
+
+    auto rowsInBand = [&](int band) {
+        return std::min(bandRows, cfg.height - band * bandRows);
+    };
+
+    // Band N goes to slot N % slots: its kernel waits for the readback of band
+    // N - slots (the previous user of that device buffer), and its readback runs
+    // on the transfer queue so it overlaps the next band's kernel.
+    auto enqueueBand = [&](int band) {
+        const size_t slot = static_cast<size_t>(band % slots);
+        const size_t rows = static_cast<size_t>(rowsInBand(band));
+        cl_mem buf = memoryManager_.bandBuffer(static_cast<int>(slot));
+        setFractalKernelArgs(kernel, tier, cfg, buf);
+
+        const size_t globalOffset[2] = {0, static_cast<size_t>(band) * static_cast<size_t>(bandRows)};
+        const size_t globalSize[2] = {width, rows};
+        cl_event prevRead = readEvents[slot];
+        cl_event kernelEvt = nullptr;
+        cl_int err = clEnqueueNDRangeKernel(computeQueue, kernel, 2, globalOffset, globalSize, localSizePtr,
+                                            prevRead ? 1 : 0, prevRead ? &prevRead : nullptr,
+                                            Trace::Command("Band kernel", &kernelEvt).event());
+        if (err != CL_SUCCESS) {
+            throw std::runtime_error("Failed to enqueue Mandelbrot kernel for band");
+        }
+
+        cl_event readEvt = nullptr;
+        err = clEnqueueReadBuffer(transferQueue, buf, CL_FALSE, 0, width * rows * sizeof(int),
+                                  memoryManager_.hostBandBuffer(static_cast<int>(slot)).data(),
+                                  1, &kernelEvt, Trace::Command("Band readback", &readEvt).event());
+        if (err != CL_SUCCESS) {
+            throw std::runtime_error("Failed to enqueue Mandelbrot band readback");
+        }
+
+        if (kernelEvents[slot]) {
+            clReleaseEvent(kernelEvents[slot]);
+        }
+        if (prevRead) {
+            clReleaseEvent(prevRead);
+        }
+        kernelEvents[slot] = kernelEvt;
+        readEvents[slot] = readEvt;
+        clFlush(computeQueue);
+        clFlush(transferQueue);
+    };
+
+    auto encodeBand = [&](int band) {
+        const size_t slot = static_cast<size_t>(band % slots);
+        const int rows = rowsInBand(band);
+        if (clWaitForEvents(1, &readEvents[slot]) != CL_SUCCESS) {
+            throw std::runtime_error("Failed waiting for Mandelbrot band readback");
+        }
+        kernelMs += eventTimeMs(kernelEvents[slot]);
+        readMs += eventTimeMs(readEvents[slot]);
+
+        const auto start = std::chrono::steady_clock::now();
+        const size_t pixels = width * static_cast<size_t>(rows);
+        writer.colorize(lut, memoryManager_.hostBandBuffer(static_cast<int>(slot)).data(), pixels,
+                        rgbBand.data(), cfg.threads);
+        sink->writeRows(rgbBand.data(), rows);
+        encodeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Encode lags two bands behind: while band N-2 is colored and encoded on the
+    // host, band N-1 is read back and band N computes on the device.
+    constexpr int encodeLag = 2;
+    const auto wallStart = std::chrono::steady_clock::now();
+    for (int band = 0; band < bandCount; ++band) {
+        enqueueBand(band);
+        if (band >= encodeLag) {
+            encodeBand(band - encodeLag);
+        }
+    }
+    for (int band = std::max(0, bandCount - encodeLag); band < bandCount; ++band) {
+        encodeBand(band);
     }
+    sink->finish();
+    const double wallMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - wallStart).count();
+
+    for (size_t slot = 0; slot < kernelEvents.size(); ++slot) {
+        if (kernelEvents[slot]) {
+            clReleaseEvent(kernelEvents[slot]);
+        }
+        if (readEvents[slot]) {
+            clReleaseEvent(readEvents[slot]);
+        }
+    }
+
+    const size_t pixelCount = width * static_cast<size_t>(cfg.height);
+    printTimeMs("Fractal kernel", kernelMs, pixelCount);
+    std::cout << "[Pipeline] " << bandCount << " bands of " << bandRows << " rows: wall "
+              << wallMs << " ms (kernel " << kernelMs << " ms, readback " << readMs
+              << " ms, color+encode " << encodeMs << " ms)\n";
+    std::cout << "[Renderer] Wrote image to '" << outputPath << "'\n";
+}
+
+void Renderer::renderSequence(const std::vector<RenderConfig>& frames) {
+    Trace::Scope scope("Animation", "render");
+    if (!strategy_) {
+        std::cerr << "[Renderer] No strategy set; cannot render.\n";
+        return;
+    }
+    if (frames.empty()) {
+        return;
+    }
+
+    const RenderConfig& base = frames.front();
+    for (const RenderConfig& frame : frames) {
+        if (frame.width != base.width || frame.height != base.height ||
+            frame.maxIterations != base.maxIterations) {
+            throw std::runtime_error("Animation frames must share size and iteration count");
+        }
+    }
+    if (!base.fieldPath.empty()) {
+        std::cout << "[Animation] --save-field applies to single images; writing frames only\n";
+        std::vector<RenderConfig> imageFrames(frames);
+        for (RenderConfig& frame : imageFrames) {
+            frame.fieldPath.clear();
+        }
+        renderSequence(imageFrames);
+        return;
+    }
+
+    std::cout << "[Renderer] Starting " << frames.size() << "-frame animation using strategy: "
+              << strategy_->name() << "\n";
+    strategy_->configure(base);
+
+    const size_t pixelCount = static_cast<size_t>(base.width) * static_cast<size_t>(base.height);
+    const bool useDevice = base.backend != "cpu";
+    const bool deepZoom = std::any_of(frames.begin(), frames.end(), [this](const RenderConfig& frame) {
+        return selectTier(frame) == PrecisionTier::Perturbation;
+    });
+    const bool multiDevice = base.multiDevice && deviceSet_ && useDevice;
+    if (deepZoom || base.subdivide || multiDevice || base.antialiasSamples > 0) {
+        // Each deep frame needs its own reference orbit, subdivision and
+        // anti-aliasing run batch by batch on the host and multi-device
+        // scheduling owns whole frames: render them one by one.
+        std::cout << "[Renderer] "
+                  << (deepZoom ? "Animation reaches deep-zoom depth"
+                               : base.subdivide ? "Subdivision enabled"
+                               : multiDevice ? "Multi-device enabled" : "Anti-aliasing enabled")
+                  << "; rendering frames sequentially\n";
+        for (const RenderConfig& frame : frames) {
+            render(frame);
+        }
+        return;
+    }
+    if (useDevice && pixelCount * sizeof(int) > tileBudgetBytes(base)) {
+        // No room for a full-frame slot: render frames one by one (tiled).
+        std::cout << "[Renderer] Frame exceeds one device allocation; rendering frames sequentially\n";
+        for (const RenderConfig& frame : frames) {
+            render(frame);
+        }
+        return;
+    }
+
+    // Work-group size autotuned for the first frame's tier.
+    const RenderConfig tunedBase = useDevice ? applyTuning(base, selectTier(base)) : base;
 
     OutputWriter writer;
-    writer.writeImage(cfg, hostIters, outputPath);
+    const PaletteLut lut = writer.paletteLut(base);
+    std::mutex statsMutex;
+    double encodeMs = 0.0;
+    WorkerPool encoders(base.threads);  // Declared after what its jobs touch.
+    double kernelMs = 0.0;
+    double colorMs = 0.0;
+
+    // Color a finished frame on this thread (parallel LUT gather), then hand
+    // the RGB buffer to the encoder pool so the next frame can start.
+    auto submitFrame = [&](size_t index, const int* iterations) {
+        const RenderConfig& frame = frames[index];
+        auto rgb = std::make_shared<std::vector<unsigned char>>(pixelCount * 3);
+        const auto start = std::chrono::steady_clock::now();
+        if (frame.coloring == "histogram") {
+            // Equalization depends on each frame's own histogram.
+            const IterationFrame counts{IterationFormat::U32, iterations, pixelCount};
+            writer.colorize(writer.paletteLut(frame, counts, frame.threads), counts, rgb->data(), frame.threads);
+        } else {
+            writer.colorize(lut, iterations, pixelCount, rgb->data(), frame.threads);
+        }
+        colorMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        encoders.submit([&writer, &frame, &statsMutex, &encodeMs, rgb] {
+            const auto encodeStart = std::chrono::steady_clock::now();
+            writer.writeRGBImage(frame, *rgb, resolveOutputPath(frame));
+            const double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - encodeStart).count();
+            std::lock_guard<std::mutex> lock(statsMutex);
+            encodeMs += ms;
+        });
+    };
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    if (!useDevice) {
+        memoryManager_.initializeHost(base);
+        auto& hostIters = memoryManager_.hostIterationBuffer();
+        CpuRenderer cpu(base.threads);
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            cpu.computeIterations(frames[i], hostIters.data());
+            kernelMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            submitFrame(i, hostIters.data());
+        }
+    } else {
+        // Two full-frame slots; frame N uses slot N % 2.
+        const int slots = Sequence::FRAME_SLOTS;
+        memoryManager_.initializeBands(base, pixelCount, slots);
+
+        cl_command_queue computeQueue = deviceManager_.commandQueue();
+        cl_command_queue transferQueue = deviceManager_.transferQueue();
+        size_t localSize[2];
+        const size_t* localSizePtr = localSizeFor(tunedBase, localSize);
+        const size_t globalSize[2] = {static_cast<size_t>(base.width), static_cast<size_t>(base.height)};
+        std::vector<cl_event> kernelEvents(static_cast<size_t>(slots), nullptr);
+        std::vector<cl_event> readEvents(static_cast<size_t>(slots), nullptr);
+
+        // The slot's previous frame has already been waited for and colored
+        // (the loop finishes frame N-1 before enqueuing N+1), so no device
+        // dependency is needed beyond the kernel -> readback event.
+        auto enqueueFrame = [&](size_t index) {
+            const size_t slot = index % static_cast<size_t>(slots);
+            cl_mem buf = memoryManager_.bandBuffer(static_cast<int>(slot));
+            // Frames of a zoom can cross into a wider tier; arguments are
+            // captured at enqueue, so switching kernels per frame is safe.
+            const PrecisionTier tier = selectTier(frames[index]);
+            cl_kernel kernel = iterationKernelFor(frames[index], tier);
+            if (!kernel) {
+                throw std::runtime_error("Mandelbrot kernel not initialized");
+            }
+            setFractalKernelArgs(kernel, tier, frames[index], buf);
+
+            cl_event kernelEvt = nullptr;
+            cl_int err = clEnqueueNDRangeKernel(computeQueue, kernel, 2, nullptr, globalSize, localSizePtr,
+                                                0, nullptr, Trace::Command("Frame kernel", &kernelEvt).event());
+            if (err != CL_SUCCESS) {
+                throw std::runtime_error("Failed to enqueue Mandelbrot kernel for frame");
+            }
+            cl_event readEvt = nullptr;
+            err = clEnqueueReadBuffer(transferQueue, buf, CL_FALSE, 0, pixelCount * sizeof(int),
+                                      memoryManager_.hostBandBuffer(static_cast<int>(slot)).data(),
+                                      1, &kernelEvt, Trace::Command("Frame readback", &readEvt).event());
+            if (err != CL_SUCCESS) {
+                throw std::runtime_error("Failed to enqueue frame readback");
+            }
+            kernelEvents[slot] = kernelEvt;
+            readEvents[slot] = readEvt;
+            clFlush(computeQueue);
+            clFlush(transferQueue);
+        };
+
+        auto finishFrame = [&](size_t index) {
+            const size_t slot = index % static_cast<size_t>(slots);
+            if (clWaitForEvents(1, &readEvents[slot]) != CL_SUCCESS) {
+                throw std::runtime_error("Failed waiting for frame readback");
+            }
+            kernelMs += eventTimeMs(kernelEvents[slot]);
+            clReleaseEvent(kernelEvents[slot]);
+            clReleaseEvent(readEvents[slot]);
+            kernelEvents[slot] = nullptr;
+            readEvents[slot] = nullptr;
+            submitFrame(index, memoryManager_.hostBandBuffer(static_cast<int>(slot)).data());
+        };
+
+        enqueueFrame(0);
+        for (size_t i = 1; i < frames.size(); ++i) {
+            enqueueFrame(i);
+            finishFrame(i - 1);
+        }
+        finishFrame(frames.size() - 1);
+    }
+    encoders.wait();
+
+    const double wallMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - wallStart).count();
+    const double fps = wallMs > 0.0 ? static_cast<double>(frames.size()) * 1e3 / wallMs : 0.0;
+    std::cout << "[Animation] " << frames.size() << " frames in " << wallMs << " ms: " << fps
+              << " fps (kernel " << kernelMs << " ms, color " << colorMs << " ms, encode "
+              << encodeMs << " ms on " << encoders.workerCount() << " workers)\n";
+    memoryManager_.printPoolStats();
+}
+
+void Renderer::recolor(const RenderConfig& requested) {
+    Trace::Scope scope("Recolor", "render");
+    const auto start = std::chrono::steady_clock::now();
+    const IterationField field = IterationField::open(requested.recolorFile, requested.threads);
+    const double loadMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // The view comes from the file; how it is colored and written from the
+    // command line. Subsamples would need the kernel, so no anti-aliasing.
+    RenderConfig cfg = field.config();
+    cfg.palette = requested.palette;
+    cfg.paletteFile = requested.paletteFile;
+    cfg.coloring = requested.coloring;
+    cfg.pngLevel = requested.pngLevel;
+    cfg.pngFilter = requested.pngFilter;
+    cfg.outputPath = requested.outputPath;
+    cfg.threads = requested.threads;
+
+    const IterationFrame frame = field.frame();
+    std::cout << "[Recolor] " << requested.recolorFile << ": " << cfg.fractalType << " " << cfg.width << "x"
+              << cfg.height << ", " << cfg.maxIterations << " iterations, "
+              << iterationFormatName(frame.format) << " counts\n";
+    printTimeMs("Field load", loadMs, frame.pixelCount,
+                std::string(field.compressed() ? "inflated" : "mapped") + ", " +
+                    std::to_string(static_cast<double>(field.fileBytes()) / (1 << 20)) + " MiB file");
+    writeOutput(cfg, frame);
+}
+
+void Renderer::writeOutput(const RenderConfig& cfg, const IterationFrame& frame) {
+    Trace::Scope scope("Write output", "render");
+    const std::string outputPath = resolveOutputPath(cfg);
+
+    if (!cfg.fieldPath.empty()) {
+        const auto start = std::chrono::steady_clock::now();
+        IterationField::write(cfg.fieldPath, cfg, frame, cfg.fieldCompress, cfg.threads);
+        const double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        printTimeMs("Field write", ms, frame.pixelCount,
+                    std::string(cfg.fieldCompress ? "zlib chunks" : "raw") + " to '" + cfg.fieldPath + "'");
+    }
+
+    OutputWriter writer;
+    // Frames from deep zoom (perturbation) are never anti-aliased.
+    const bool antialias = cfg.antialiasSamples > 0 && frame.format == IterationFormat::U32 &&
+                           selectTier(cfg) == PrecisionTier::Float;
+    if (cfg.coloring == "histogram" || antialias || encoded_) {
+        PaletteLut lut;
+        if (cfg.coloring == "histogram") {
+            const auto start = std::chrono::steady_clock::now();
+            lut = writer.paletteLut(cfg, frame, cfg.threads);
+            const double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            printTimeMs("Histogram", ms, frame.pixelCount,
+                        ColorHistogram::sortsCounts(frame.pixelCount, cfg.maxIterations)
+                            ? "sorted counts, equalized LUT" : "equalized LUT");
+        } else {
+            lut = writer.paletteLut(cfg);
+        }
+
+        std::vector<unsigned char> rgb(frame.pixelCount * 3);
+        writer.colorize(lut, frame, rgb.data(), cfg.threads);
+        if (antialias) {
+            antialiasEdges(cfg, static_cast<const int*>(frame.data), lut, rgb.data());
+        }
+        if (encoded_) {
+            *encoded_ = writer.encodeRGBImage(cfg, rgb, outputPath);
+            std::cout << "[Renderer] Encoded image in memory (" << encoded_->size() << " bytes)\n";
+            return;
+        }
+        writer.writeRGBImage(cfg, rgb, outputPath);
+        std::cout << "[Renderer] Wrote image to '" << outputPath << "'\n";
+        return;
+    }
+    writer.writeImage(cfg, frame, outputPath);
     std::cout << "[Renderer] Wrote image to '" << outputPath << "'\n";
 }
 
@@ -0,0 +1,282 @@
+// Trace implementation - in-memory span lists and the trace-event writer.
+//
+// Device timestamps are on the device clock. They are placed on the host
+// timeline per device with the tightest offset the recording allows: a
+// command's QUEUED time cannot precede the host time taken just before its
+// clEnqueue* call, so offset = max(hostBeforeEnqueue - QUEUED).
+
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+std::atomic<bool> Trace::enabled_{false};
+
+namespace {
+
+struct HostSpan {
+    const char* name;
+    const char* category;
+    int thread;
+    int64_t startNs;
+    int64_t endNs;
+};
+
+struct DeviceCommand {
+    const char* name;
+    cl_event event;
+    int64_t enqueueNs;  // Host time just before the clEnqueue* call.
+};
+
+struct TraceState {
+    std::mutex mutex;
+    std::string path;
+    std::chrono::steady_clock::time_point origin;
+    std::map<std::thread::id, int> threads;
+    std::vector<HostSpan> spans;
+    std::vector<DeviceCommand> commands;
+};
+
+TraceState& state() {
+    static TraceState s;
+    return s;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - state().origin).count();
+}
+
+// Small, stable track numbers in first-seen order (caller holds the mutex).
+int threadIndex(TraceState& s) {
+    const auto inserted = s.threads.emplace(std::this_thread::get_id(), static_cast<int>(s.threads.size()) + 1);
+    return inserted.first->second;
+}
+
+std::string jsonQuote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+    }
+    return quoted + "\"";
+}
+
+std::string deviceName(cl_device_id device) {
+    char name[256] = {};
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name) - 1, name, nullptr);
+    return name[0] ? name : "OpenCL device";
+}
+
+const char* commandTypeName(cl_command_type type) {
+    switch (type) {
+    case CL_COMMAND_NDRANGE_KERNEL: return "kernel";
+    case CL_COMMAND_READ_BUFFER: return "read";
+    case CL_COMMAND_READ_BUFFER_RECT: return "read-rect";
+    case CL_COMMAND_WRITE_BUFFER: return "write";
+    case CL_COMMAND_FILL_BUFFER: return "fill";
+    case CL_COMMAND_COPY_BUFFER: return "copy";
+    case CL_COMMAND_MAP_BUFFER: return "map";
+    case CL_COMMAND_UNMAP_MEM_OBJECT: return "unmap";
+    default: return "other";
+    }
+}
+
+// Microseconds with nanosecond resolution, as trace-event "ts"/"dur" expect.
+std::string us(int64_t ns) {
+    std::ostringstream out;
+    out << ns / 1000 << "." << std::setw(3) << std::setfill('0') << (ns < 0 ? -ns : ns) % 1000;
+    return out.str();
+}
+
+} // namespace
+
+void Trace::start(const std::string& path) {
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.path = path;
+    s.origin = std::chrono::steady_clock::now();
+    s.threads.clear();
+    s.spans.clear();
+    s.commands.clear();
+    threadIndex(s);  // The starting thread is track 1.
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Trace::finish() {
+    if (!enabled()) {
+        return;
+    }
+    enabled_.store(false, std::memory_order_relaxed);
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    struct Resolved {
+        const DeviceCommand* command;
+        cl_command_type type;
+        cl_ulong queued, submit, start, end;
+        int process;
+        int queue;
+    };
+    std::vector<Resolved> resolved;
+    std::map<cl_device_id, int> devices;          // -> trace process id
+    std::map<cl_command_queue, int> queues;       // -> track within its process
+    std::map<int, int64_t> offsets;               // process -> device-to-host offset
+    std::map<int, std::string> processNames;
+
+    for (const DeviceCommand& cmd : s.commands) {
+        Resolved r{&cmd, 0, 0, 0, 0, 0, 0, 0};
+        cl_command_queue queue = nullptr;
+        cl_device_id device = nullptr;
+        if (clWaitForEvents(1, &cmd.event) != CL_SUCCESS ||
+            clGetEventInfo(cmd.event, CL_EVENT_COMMAND_QUEUE, sizeof(queue), &queue, nullptr) != CL_SUCCESS ||
+            clGetCommandQueueInfo(queue, CL_QUEUE_DEVICE, sizeof(device), &device, nullptr) != CL_SUCCESS ||
+            clGetEventProfilingInfo(cmd.event, CL_PROFILING_COMMAND_QUEUED, sizeof(r.queued), &r.queued, nullptr) != CL_SUCCESS ||
+            clGetEventProfilingInfo(cmd.event, CL_PROFILING_COMMAND_SUBMIT, sizeof(r.submit), &r.submit, nullptr) != CL_SUCCESS ||
+            clGetEventProfilingInfo(cmd.event, CL_PROFILING_COMMAND_START, sizeof(r.start), &r.start, nullptr) != CL_SUCCESS ||
+            clGetEventProfilingInfo(cmd.event, CL_PROFILING_COMMAND_END, sizeof(r.end), &r.end, nullptr) != CL_SUCCESS) {
+            clReleaseEvent(cmd.event);
+            continue;
+        }
+        clGetEventInfo(cmd.event, CL_EVENT_COMMAND_TYPE, sizeof(r.type), &r.type, nullptr);
+        clReleaseEvent(cmd.event);
+
+        const auto dev = devices.emplace(device, static_cast<int>(devices.size()) + 2);
+        r.process = dev.first->second;
+        if (dev.second) {
+            processNames[r.process] = deviceName(device);
+            offsets[r.process] = std::numeric_limits<int64_t>::min();
+        }
+        r.queue = queues.emplace(queue, static_cast<int>(queues.size()) + 1).first->second;
+        offsets[r.process] = std::max(offsets[r.process], cmd.enqueueNs - static_cast<int64_t>(r.queued));
+        resolved.push_back(r);
+    }
+    s.commands.clear();
+
+    std::ofstream out(s.path);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"ph\": \"M\", \"pid\": 1, \"name\": \"process_name\", \"args\": {\"name\": \"Host\"}}";
+    for (const auto& thread : s.threads) {
+        out << ",\n{\"ph\": \"M\", \"pid\": 1, \"tid\": " << thread.second
+            << ", \"name\": \"thread_name\", \"args\": {\"name\": \""
+            << (thread.second == 1 ? std::string("main") : "worker " + std::to_string(thread.second)) << "\"}}";
+    }
+    for (const auto& process : processNames) {
+        out << ",\n{\"ph\": \"M\", \"pid\": " << process.first << ", \"name\": \"process_name\", \"args\": {\"name\": "
+            << jsonQuote(process.second) << "}}";
+    }
+    for (const auto& queue : queues) {
+        const auto it = std::find_if(resolved.begin(), resolved.end(),
+                                     [&](const Resolved& r) { return r.queue == queue.second; });
+        if (it != resolved.end()) {
+            out << ",\n{\"ph\": \"M\", \"pid\": " << it->process << ", \"tid\": " << queue.second
+                << ", \"name\": \"thread_name\", \"args\": {\"name\": \"queue " << queue.second << "\"}}";
+        }
+    }
+
+    for (const HostSpan& span : s.spans) {
+        out << ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": " << span.thread << ", \"cat\": " << jsonQuote(span.category)
+            << ", \"name\": " << jsonQuote(span.name) << ", \"ts\": " << us(span.startNs)
+            << ", \"dur\": " << us(span.endNs - span.startNs) << "}";
+    }
+
+    // Execution (START..END) is a slice on its queue's track; in-order queues
+    // never overlap there. The waits before it overlap between commands, so
+    // they are async slices: queued (QUEUED..SUBMIT) and submitted
+    // (SUBMIT..START).
+    int asyncId = 0;
+    for (const Resolved& r : resolved) {
+        const int64_t offset = offsets[r.process];
+        auto host = [&](cl_ulong deviceNs) { return static_cast<int64_t>(deviceNs) + offset; };
+        const std::string name = jsonQuote(r.command->name);
+        out << ",\n{\"ph\": \"X\", \"pid\": " << r.process << ", \"tid\": " << r.queue
+            << ", \"cat\": \"opencl\", \"name\": " << name << ", \"ts\": " << us(host(r.start))
+            << ", \"dur\": " << us(static_cast<int64_t>(r.end - r.start)) << ", \"args\": {\"command\": \""
+            << commandTypeName(r.type) << "\", \"queued_ns\": " << r.queued << ", \"submit_ns\": " << r.submit
+            << ", \"start_ns\": " << r.start << ", \"end_ns\": " << r.end << "}}";
+        const struct {
+            const char* phase;
+            cl_ulong begin;
+            cl_ulong end;
+        } waits[] = {{"queued", r.queued, r.submit}, {"submitted", r.submit, r.start}};
+        for (const auto& wait : waits) {
+            ++asyncId;
+            for (const char* ph : {"b", "e"}) {
+                out << ",\n{\"ph\": \"" << ph << "\", \"pid\": " << r.process << ", \"tid\": " << r.queue
+                    << ", \"cat\": \"opencl.wait\", \"id\": " << asyncId << ", \"name\": \"" << wait.phase
+                    << "\", \"ts\": " << us(host(ph[0] == 'b' ? wait.begin : wait.end));
+                if (ph[0] == 'b') {
+                    out << ", \"args\": {\"command\": " << name << "}";
+                }
+                out << "}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    if (!out) {
+        std::cout << "[Trace] Failed to write " << s.path << "\n";
+    } else {
+        std::cout << "[Trace] " << s.spans.size() << " host spans and " << resolved.size()
+                  << " OpenCL commands written to " << s.path << "\n";
+    }
+    s.spans.clear();
+}
+
+Trace::Scope::Scope(const char* name, const char* category)
+    : name_(name)
+    , category_(category) {
+    if (enabled()) {
+        startNs_ = nowNs();
+    }
+}
+
+Trace::Scope::~Scope() {
+    if (startNs_ < 0 || !enabled()) {
+        return;
+    }
+    const int64_t endNs = nowNs();
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.spans.push_back({name_, category_, threadIndex(s), startNs_, endNs});
+}
+
+Trace::Command::Command(const char* name, cl_event* requested)
+    : name_(name)
+    , slot_(requested) {
+    if (enabled()) {
+        enqueueNs_ = nowNs();
+        if (!slot_) {
+            slot_ = &owned_;
+        }
+    }
+}
+
+Trace::Command::~Command() {
+    if (enqueueNs_ < 0 || !*slot_) {
+        return;
+    }
+    if (!enabled()) {
+        if (owned_) {
+            clReleaseEvent(owned_);
+        }
+        return;
+    }
+    // The caller still owns (and may release) its own event.
+    if (!owned_) {
+        clRetainEvent(*slot_);
+    }
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.commands.push_back({name_, *slot_, enqueueNs_});
+}
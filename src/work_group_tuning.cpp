@@ -0,0 +1,163 @@
+// WorkGroupTuning implementation - candidate enumeration and the results file.
+//
+// File layout: one tab-separated line per (device, kernel):
+//   device <TAB> kernel <TAB> localX <TAB> localY <TAB> pixelsPerItem <TAB> ms
+// Lines starting with '#' are comments.
+
+#include "work_group_tuning.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+
+#include "constants.h"
+
+namespace {
+
+using namespace FractalConstants;
+
+std::string deviceString(cl_device_id device, cl_device_info param) {
+    size_t size = 0;
+    if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0) {
+        return "";
+    }
+    std::string value(size, '\0');
+    clGetDeviceInfo(device, param, size, &value[0], nullptr);
+    value.resize(value.find('\0') == std::string::npos ? value.size() : value.find('\0'));
+    return value;
+}
+
+// Keys are written between tabs, one entry per line.
+std::string sanitize(std::string text) {
+    std::replace_if(text.begin(), text.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+    return text;
+}
+
+std::string tableKey(const std::string& device, const std::string& kernel) {
+    return sanitize(device) + '\t' + sanitize(kernel);
+}
+
+} // namespace
+
+WorkGroupTuning::WorkGroupTuning(std::string path)
+    : path_(std::move(path)) {}
+
+void WorkGroupTuning::load() {
+    entries_.clear();
+    if (!enabled()) {
+        return;
+    }
+    std::ifstream in(path_);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string device;
+        std::string kernel;
+        std::string numbers;
+        if (!std::getline(fields, device, '\t') || !std::getline(fields, kernel, '\t') ||
+            !std::getline(fields, numbers)) {
+            continue;
+        }
+        std::istringstream values(numbers);
+        Entry entry;
+        if (!(values >> entry.localX >> entry.localY >> entry.pixelsPerItem >> entry.ms) ||
+            entry.localX < 0 || entry.localY < 0 || (entry.localX == 0) != (entry.localY == 0) ||
+            entry.pixelsPerItem < 1) {
+            continue;
+        }
+        entries_[tableKey(device, kernel)] = entry;
+    }
+}
+
+void WorkGroupTuning::save() const {
+    if (!enabled()) {
+        return;
+    }
+    std::error_code ec;
+    const std::filesystem::path parent = std::filesystem::path(path_).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    // Temporary file + rename, so a concurrent render never reads half a table.
+    const uint64_t unique = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    const std::string tmpPath = path_ + ".tmp" + std::to_string(unique);
+    {
+        std::ofstream out(tmpPath);
+        out << "# device\tkernel\tlocalX\tlocalY\tpixelsPerItem\tms (written by --autotune)\n";
+        for (const auto& item : entries_) {
+            const Entry& e = item.second;
+            out << item.first << '\t' << e.localX << '\t' << e.localY << '\t' << e.pixelsPerItem << '\t'
+                << e.ms << '\n';
+        }
+        if (!out) {
+            std::cout << "[Autotune] Failed to write " << tmpPath << "\n";
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmpPath, path_, ec);
+    if (ec) {
+        std::cout << "[Autotune] Failed to install " << path_ << "\n";
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
+
+const WorkGroupTuning::Entry* WorkGroupTuning::find(const std::string& device, const std::string& kernel) const {
+    const auto it = entries_.find(tableKey(device, kernel));
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+void WorkGroupTuning::set(const std::string& device, const std::string& kernel, const Entry& entry) {
+    entries_[tableKey(device, kernel)] = entry;
+}
+
+std::string WorkGroupTuning::deviceKey(cl_device_id device) {
+    return deviceString(device, CL_DEVICE_NAME) + " | " + deviceString(device, CL_DEVICE_VENDOR) + " | " +
+           deviceString(device, CL_DRIVER_VERSION);
+}
+
+std::vector<WorkGroupTuning::Entry> WorkGroupTuning::candidates(const Limits& limits, int width, int height,
+                                                                bool allowPixelsPerItem) {
+    // A device whose maximum is below the preferred multiple still gets
+    // candidates; the multiple is only a hint.
+    const size_t multiple = std::max<size_t>(1, limits.preferredMultiple);
+    const bool requireMultiple = limits.maxWorkGroupSize >= multiple;
+    const size_t maxY = std::min<size_t>(limits.maxItemsY, static_cast<size_t>(Autotune::MAX_LOCAL_Y));
+
+    std::vector<int> pixelFactors = {1};
+    if (allowPixelsPerItem) {
+        pixelFactors.assign(std::begin(Autotune::PIXELS_PER_ITEM), std::end(Autotune::PIXELS_PER_ITEM));
+    }
+
+    std::vector<Entry> shapes;
+    for (int pixels : pixelFactors) {
+        if (width % pixels != 0) {
+            continue;
+        }
+        const int itemsX = width / pixels;
+        for (size_t ly = 1; ly <= maxY; ly *= 2) {
+            if (height % static_cast<int>(ly) != 0) {
+                continue;
+            }
+            for (size_t lx = 1; lx <= limits.maxItemsX && lx * ly <= limits.maxWorkGroupSize; lx *= 2) {
+                if (itemsX % static_cast<int>(lx) != 0 || (requireMultiple && (lx * ly) % multiple != 0)) {
+                    continue;
+                }
+                Entry e;
+                e.localX = static_cast<int>(lx);
+                e.localY = static_cast<int>(ly);
+                e.pixelsPerItem = pixels;
+                shapes.push_back(e);
+            }
+        }
+    }
+    return shapes;
+}
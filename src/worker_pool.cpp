@@ -0,0 +1,77 @@
+// WorkerPool implementation - bounded queue with blocking submit.
+
+#include "worker_pool.h"
+
+#include "parallel_for.h"
+
+WorkerPool::WorkerPool(int workerCount, size_t maxPending) {
+    const int workers = resolveThreadCount(workerCount);
+    maxPending_ = maxPending > 0 ? maxPending : static_cast<size_t>(workers) * 2;
+    threads_.reserve(static_cast<size_t>(workers));
+    for (int i = 0; i < workers; ++i) {
+        threads_.emplace_back([this] { run(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    jobReady_.notify_all();
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    spaceFree_.wait(lock, [this] { return jobs_.size() < maxPending_; });
+    jobs_.push_back(std::move(job));
+    lock.unlock();
+    jobReady_.notify_one();
+}
+
+void WorkerPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return jobs_.empty() && active_ == 0; });
+    if (error_) {
+        std::exception_ptr err = error_;
+        error_ = nullptr;
+        std::rethrow_exception(err);
+    }
+}
+
+void WorkerPool::run() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobReady_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return;  // Stopping and drained.
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            ++active_;
+        }
+        spaceFree_.notify_one();
+
+        try {
+            job();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+            if (jobs_.empty() && active_ == 0) {
+                idle_.notify_all();
+            }
+        }
+    }
+}